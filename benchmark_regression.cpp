@@ -0,0 +1,527 @@
+#include "assignments/ev/benchmark_regression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/euclidean_vector_batch.h"
+#include "assignments/ev/hnsw_index.h"
+#include "assignments/ev/vector_random.h"
+
+namespace {
+
+constexpr int kVersion = 1;
+
+constexpr const char* kVerdictNames[] = {"unchanged", "improved", "regressed", "missing", "added"};
+
+using Clock = std::chrono::steady_clock;
+
+// One timed call of a benchmark; the result is summed into a sink so the call is not optimised out
+using Operation = std::function<double()>;
+
+// A benchmark of the suite; setup builds its data outside the timed region
+struct Benchmark {
+  const char* name;
+  std::function<Operation()> setup;
+};
+
+Operation Add(std::size_t dimensions) {
+  EuclideanVector a = RandomUniformVector(dimensions, -1, 1, RandomParams{1});
+  EuclideanVector b = RandomUniformVector(dimensions, -1, 1, RandomParams{2});
+  return [a, b] { return (a + b)[0]; };
+}
+
+Operation Scale(std::size_t dimensions) {
+  EuclideanVector a = RandomUniformVector(dimensions, -1, 1, RandomParams{1});
+  return [a] { return (a * 1.5)[0]; };
+}
+
+Operation DotProduct(std::size_t dimensions) {
+  EuclideanVector a = RandomUniformVector(dimensions, -1, 1, RandomParams{1});
+  EuclideanVector b = RandomUniformVector(dimensions, -1, 1, RandomParams{2});
+  return [a, b] { return a * b; };
+}
+
+Operation Norm(std::size_t dimensions) {
+  EuclideanVector a = RandomUniformVector(dimensions, -1, 1, RandomParams{1});
+  return [a] { return a.GetEuclideanNorm(); };
+}
+
+Operation UnitVector(std::size_t dimensions) {
+  EuclideanVector a = RandomUniformVector(dimensions, -1, 1, RandomParams{1});
+  return [a] { return a.CreateUnitVector()[0]; };
+}
+
+Operation Nearest(std::size_t num_vectors, int dimensions, std::size_t k) {
+  auto batch = std::make_shared<EuclideanVectorBatch>(
+      RandomUniformBatch(num_vectors, dimensions, -1, 1, RandomParams{1}));
+  EuclideanVector query = RandomUniformVector(static_cast<std::size_t>(dimensions), -1, 1,
+                                              RandomParams{2});
+  return [batch, query, k] { return FindNearest(*batch, query, k).front().distance; };
+}
+
+Operation Output(std::size_t dimensions) {
+  EuclideanVector a = RandomUniformVector(dimensions, -1, 1, RandomParams{1});
+  return [a] {
+    std::ostringstream os;
+    os << a;
+    return static_cast<double>(os.str().size());
+  };
+}
+
+Operation SaveLoadIndex(std::size_t num_vectors, int dimensions) {
+  EuclideanVectorBatch data = RandomUniformBatch(num_vectors, dimensions, -1, 1, RandomParams{1});
+  HnswParams params;
+  params.ef_construction = 50;
+  auto index = std::make_shared<HnswIndex>(dimensions, params);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    index->Insert(data.Get(i));
+  }
+  return [index] {
+    std::stringstream stream;
+    index->Save(stream);
+    return static_cast<double>(HnswIndex::Load(stream).size());
+  };
+}
+
+// The fixed suite. Names are part of the baseline format: rename a benchmark only together with
+//  the baselines that mention it.
+const std::vector<Benchmark>& Suite() {
+  static const std::vector<Benchmark> suite{
+      {"add/3", [] { return Add(3); }},
+      {"scale/3", [] { return Scale(3); }},
+      {"dot/3", [] { return DotProduct(3); }},
+      {"norm/3", [] { return Norm(3); }},
+      {"add/4096", [] { return Add(4096); }},
+      {"dot/4096", [] { return DotProduct(4096); }},
+      {"dot/1048576", [] { return DotProduct(1048576); }},
+      {"norm/1048576", [] { return Norm(1048576); }},
+      {"unit_vector/3", [] { return UnitVector(3); }},
+      {"unit_vector/4096", [] { return UnitVector(4096); }},
+      {"find_nearest/10000x128/k10", [] { return Nearest(10000, 128, 10); }},
+      {"output/1024", [] { return Output(1024); }},
+      {"hnsw_save_load/1000x32", [] { return SaveLoadIndex(1000, 32); }},
+  };
+  return suite;
+}
+
+// Nanoseconds taken by calls calls of operation
+double TimeCalls(const Operation& operation, std::size_t calls) {
+  static volatile double sink = 0;
+  double total = 0;
+  auto start = Clock::now();
+  for (std::size_t c = 0; c < calls; ++c) {
+    total += operation();
+  }
+  std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+  sink = sink + total;
+  return elapsed.count();
+}
+
+BenchmarkResult Measure(const Benchmark& benchmark, const BenchmarkParams& params) {
+  Operation operation = benchmark.setup();
+  // Doubles the calls per repetition until they take min_time_ms, which also warms the caches
+  const double min_ns = params.min_time_ms * 1e6;
+  std::size_t calls = 1;
+  double elapsed = TimeCalls(operation, calls);
+  while (elapsed < min_ns) {
+    calls *= 2;
+    elapsed = TimeCalls(operation, calls);
+  }
+
+  std::vector<double> times;
+  for (int r = 0; r < std::max(params.repetitions, 1); ++r) {
+    times.push_back(TimeCalls(operation, calls) / static_cast<double>(calls));
+  }
+  double best = *std::min_element(times.cbegin(), times.cend());
+  double worst = *std::max_element(times.cbegin(), times.cend());
+  return {benchmark.name, best, (worst - best) / best, 0};
+}
+
+// Just enough of a JSON reader for baselines: values the caller does not ask for are skipped
+class JsonReader {
+ public:
+  explicit JsonReader(const std::string& text) noexcept : text_(text), pos_(0) {}
+
+  // Skips whitespace and consumes c if it comes next
+  bool Consume(char c) noexcept {
+    this->SkipSpace();
+    if (this->pos_ < this->text_.size() && this->text_[this->pos_] == c) {
+      ++this->pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char c) {
+    if (!this->Consume(c)) {
+      this->Fail(std::string{"expected '"} + c + "'");
+    }
+  }
+
+  std::string ReadString() {
+    this->Expect('"');
+    std::string value;
+    while (this->pos_ < this->text_.size() && this->text_[this->pos_] != '"') {
+      char c = this->text_[this->pos_++];
+      if (c == '\\' && this->pos_ < this->text_.size()) {
+        c = this->text_[this->pos_++];
+        switch (c) {
+          case 'n':
+            c = '\n';
+            break;
+          case 't':
+            c = '\t';
+            break;
+          case 'u':
+            // Names are ASCII; any other code point is kept as '?'
+            this->pos_ = std::min(this->pos_ + 4, this->text_.size());
+            c = '?';
+            break;
+          default:
+            break;
+        }
+      }
+      value += c;
+    }
+    this->Expect('"');
+    return value;
+  }
+
+  double ReadNumber() {
+    this->SkipSpace();
+    const char* begin = this->text_.c_str() + this->pos_;
+    char* end = nullptr;
+    double value = std::strtod(begin, &end);
+    if (end == begin) {
+      this->Fail("expected a number");
+    }
+    this->pos_ += static_cast<std::size_t>(end - begin);
+    return value;
+  }
+
+  void SkipValue() {
+    this->SkipSpace();
+    if (this->pos_ >= this->text_.size()) {
+      this->Fail("expected a value");
+    }
+    char c = this->text_[this->pos_];
+    if (c == '"') {
+      this->ReadString();
+    } else if (c == '{' || c == '[') {
+      const char close = c == '{' ? '}' : ']';
+      ++this->pos_;
+      if (this->Consume(close)) {
+        return;
+      }
+      do {
+        if (close == '}') {
+          this->ReadString();
+          this->Expect(':');
+        }
+        this->SkipValue();
+      } while (this->Consume(','));
+      this->Expect(close);
+    } else if (this->text_.compare(this->pos_, 4, "true") == 0 ||
+               this->text_.compare(this->pos_, 4, "null") == 0) {
+      this->pos_ += 4;
+    } else if (this->text_.compare(this->pos_, 5, "false") == 0) {
+      this->pos_ += 5;
+    } else {
+      this->ReadNumber();
+    }
+  }
+
+  // Checks nothing but whitespace is left
+  void End() {
+    this->SkipSpace();
+    if (this->pos_ != this->text_.size()) {
+      this->Fail("unexpected trailing characters");
+    }
+  }
+
+ private:
+  void SkipSpace() noexcept {
+    while (this->pos_ < this->text_.size() &&
+           std::isspace(static_cast<unsigned char>(this->text_[this->pos_]))) {
+      ++this->pos_;
+    }
+  }
+
+  [[noreturn]] void Fail(const std::string& what) const {
+    throw EuclideanVectorError("Baseline is not valid JSON: " + what + " at offset " +
+                               std::to_string(this->pos_));
+  }
+
+  const std::string& text_;
+  std::size_t pos_;
+};
+
+BenchmarkResult ReadBenchmark(JsonReader& reader, std::size_t position) {
+  BenchmarkResult result{"", 0, 0, 0};
+  reader.Expect('{');
+  if (!reader.Consume('}')) {
+    do {
+      std::string key = reader.ReadString();
+      reader.Expect(':');
+      if (key == "name") {
+        result.name = reader.ReadString();
+      } else if (key == "ns") {
+        result.ns = reader.ReadNumber();
+      } else if (key == "spread") {
+        result.spread = reader.ReadNumber();
+      } else if (key == "tolerance") {
+        result.tolerance = reader.ReadNumber();
+      } else {
+        reader.SkipValue();
+      }
+    } while (reader.Consume(','));
+    reader.Expect('}');
+  }
+  if (result.name.empty() || !(result.ns > 0) || !(result.tolerance >= 0)) {
+    throw EuclideanVectorError("Baseline benchmark " + std::to_string(position) +
+                               " needs a name, a positive ns and a non-negative tolerance");
+  }
+  return result;
+}
+
+// name as a JSON string
+std::string Quote(const std::string& name) {
+  std::string quoted{'"'};
+  for (char c : name) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + '"';
+}
+
+// "+12.3%"
+std::string Percent(double fraction) {
+  std::ostringstream os;
+  os << std::showpos << std::fixed << std::setprecision(1) << 100 * fraction << '%';
+  return os.str();
+}
+
+}  // namespace
+
+const char* ToString(BenchmarkVerdict verdict) noexcept {
+  return kVerdictNames[static_cast<int>(verdict)];
+}
+
+std::vector<std::string> BenchmarkNames() {
+  std::vector<std::string> names;
+  for (const Benchmark& benchmark : Suite()) {
+    names.push_back(benchmark.name);
+  }
+  return names;
+}
+
+std::vector<BenchmarkResult> RunBenchmarkSuite(const BenchmarkParams& params) {
+  std::vector<BenchmarkResult> results;
+  for (const Benchmark& benchmark : Suite()) {
+    if (std::string{benchmark.name}.find(params.filter) != std::string::npos) {
+      results.push_back(Measure(benchmark, params));
+    }
+  }
+  return results;
+}
+
+BenchmarkResult RunBenchmark(const std::string& name, const BenchmarkParams& params) {
+  for (const Benchmark& benchmark : Suite()) {
+    if (name == benchmark.name) {
+      return Measure(benchmark, params);
+    }
+  }
+  throw EuclideanVectorError("No benchmark named " + name);
+}
+
+std::string ToJson(const std::vector<BenchmarkResult>& results) {
+  std::ostringstream os;
+  os << std::setprecision(6) << "{\"version\":" << kVersion << ",\"benchmarks\":[";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    os << (i == 0 ? "\n" : ",\n") << "{\"name\":" << Quote(result.name) << ",\"ns\":" << result.ns
+       << ",\"spread\":" << result.spread << ",\"tolerance\":" << result.tolerance << '}';
+  }
+  os << "\n]}\n";
+  return os.str();
+}
+
+std::vector<BenchmarkResult> ParseBaseline(const std::string& json) {
+  JsonReader reader{json};
+  std::vector<BenchmarkResult> results;
+  bool found = false;
+  reader.Expect('{');
+  if (!reader.Consume('}')) {
+    do {
+      std::string key = reader.ReadString();
+      reader.Expect(':');
+      if (key == "version") {
+        double version = reader.ReadNumber();
+        if (version != kVersion) {
+          throw EuclideanVectorError("Baseline version " +
+                                     std::to_string(static_cast<int>(version)) +
+                                     " is not supported");
+        }
+      } else if (key == "benchmarks") {
+        found = true;
+        reader.Expect('[');
+        if (!reader.Consume(']')) {
+          do {
+            results.push_back(ReadBenchmark(reader, results.size()));
+          } while (reader.Consume(','));
+          reader.Expect(']');
+        }
+      } else {
+        reader.SkipValue();
+      }
+    } while (reader.Consume(','));
+    reader.Expect('}');
+  }
+  reader.End();
+  if (!found) {
+    throw EuclideanVectorError("Baseline has no benchmarks");
+  }
+
+  std::unordered_map<std::string, std::size_t> seen;
+  for (const BenchmarkResult& result : results) {
+    if (++seen[result.name] > 1) {
+      throw EuclideanVectorError("Baseline lists " + result.name + " twice");
+    }
+  }
+  return results;
+}
+
+void SaveBaseline(const std::vector<BenchmarkResult>& results, const std::string& path) {
+  std::ofstream os{path};
+  if (!os) {
+    throw EuclideanVectorError("Could not open " + path + " for writing");
+  }
+  os << ToJson(results);
+  if (!os) {
+    throw EuclideanVectorError("Could not write " + path);
+  }
+}
+
+std::vector<BenchmarkResult> LoadBaseline(const std::string& path) {
+  std::ifstream is{path};
+  if (!is) {
+    throw EuclideanVectorError("Could not open " + path + " for reading");
+  }
+  std::ostringstream json;
+  json << is.rdbuf();
+  return ParseBaseline(json.str());
+}
+
+std::vector<BenchmarkComparison> CompareBenchmarks(const std::vector<BenchmarkResult>& baseline,
+                                                   const std::vector<BenchmarkResult>& results,
+                                                   const RegressionThresholds& thresholds) {
+  std::unordered_map<std::string, const BenchmarkResult*> by_name;
+  for (const BenchmarkResult& result : results) {
+    by_name.emplace(result.name, &result);
+  }
+
+  std::vector<BenchmarkComparison> comparisons;
+  for (const BenchmarkResult& base : baseline) {
+    double tolerance = thresholds.override_baseline || base.tolerance <= 0 ? thresholds.tolerance
+                                                                            : base.tolerance;
+    auto found = by_name.find(base.name);
+    if (found == by_name.end()) {
+      comparisons.push_back({base.name, BenchmarkVerdict::kMissing, base.ns, 0, tolerance});
+      continue;
+    }
+    const double ns = found->second->ns;
+    const double allowed = std::max(tolerance * base.ns, thresholds.min_delta_ns);
+    BenchmarkVerdict verdict = BenchmarkVerdict::kUnchanged;
+    if (ns - base.ns > allowed) {
+      verdict = BenchmarkVerdict::kRegressed;
+    } else if (base.ns - ns > allowed) {
+      verdict = BenchmarkVerdict::kImproved;
+    }
+    comparisons.push_back({base.name, verdict, base.ns, ns, tolerance});
+    by_name.erase(found);
+  }
+  for (const BenchmarkResult& result : results) {
+    if (by_name.count(result.name) > 0) {
+      comparisons.push_back(
+          {result.name, BenchmarkVerdict::kAdded, 0, result.ns, thresholds.tolerance});
+    }
+  }
+  return comparisons;
+}
+
+bool HasRegressions(const std::vector<BenchmarkComparison>& comparisons) noexcept {
+  return std::any_of(comparisons.cbegin(), comparisons.cend(), [](const auto& comparison) {
+    return comparison.verdict == BenchmarkVerdict::kRegressed ||
+           comparison.verdict == BenchmarkVerdict::kMissing;
+  });
+}
+
+void WriteComparison(std::ostream& os, const std::vector<BenchmarkComparison>& comparisons) {
+  std::ios_base::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  int name_width = 12;
+  int counts[5] = {0, 0, 0, 0, 0};
+  for (const BenchmarkComparison& comparison : comparisons) {
+    name_width = std::max(name_width, static_cast<int>(comparison.name.size()) + 2);
+    ++counts[static_cast<int>(comparison.verdict)];
+  }
+
+  os << std::left << std::setw(name_width) << "benchmark" << std::right << std::setw(14)
+     << "baseline ns" << std::setw(14) << "ns" << std::setw(10) << "change" << std::setw(9)
+     << "limit" << "  verdict\n";
+  for (const BenchmarkComparison& comparison : comparisons) {
+    const bool both = comparison.verdict != BenchmarkVerdict::kAdded &&
+                      comparison.verdict != BenchmarkVerdict::kMissing;
+    os << std::left << std::setw(name_width) << comparison.name << std::right << std::fixed
+       << std::setprecision(2);
+    if (comparison.verdict == BenchmarkVerdict::kAdded) {
+      os << std::setw(14) << "-";
+    } else {
+      os << std::setw(14) << comparison.baseline_ns;
+    }
+    if (comparison.verdict == BenchmarkVerdict::kMissing) {
+      os << std::setw(14) << "-";
+    } else {
+      os << std::setw(14) << comparison.ns;
+    }
+    os << std::setw(10) << (both ? Percent(comparison.Change()) : "-") << std::setw(9)
+       << Percent(comparison.tolerance) << "  "
+       << (comparison.verdict == BenchmarkVerdict::kRegressed ? "REGRESSED"
+                                                               : ToString(comparison.verdict))
+       << '\n';
+  }
+
+  if (HasRegressions(comparisons)) {
+    os << "\nFailing benchmarks:\n";
+    for (const BenchmarkComparison& comparison : comparisons) {
+      if (comparison.verdict == BenchmarkVerdict::kRegressed) {
+        os << "  " << comparison.name << ": " << comparison.baseline_ns << " ns -> "
+           << comparison.ns << " ns (" << Percent(comparison.Change()) << ", limit "
+           << Percent(comparison.tolerance) << ")\n";
+      } else if (comparison.verdict == BenchmarkVerdict::kMissing) {
+        os << "  " << comparison.name << ": in the baseline but was not run\n";
+      }
+    }
+  }
+
+  const int regressed = counts[static_cast<int>(BenchmarkVerdict::kRegressed)];
+  const int missing = counts[static_cast<int>(BenchmarkVerdict::kMissing)];
+  os << '\n' << (regressed + missing > 0 ? "FAIL" : "PASS") << ": " << comparisons.size()
+     << " benchmarks, " << regressed << " regressed, " << missing << " missing, "
+     << counts[static_cast<int>(BenchmarkVerdict::kImproved)] << " improved, "
+     << counts[static_cast<int>(BenchmarkVerdict::kAdded)] << " added\n";
+  os.flags(flags);
+  os.precision(precision);
+}
@@ -0,0 +1,102 @@
+#ifndef ASSIGNMENTS_EV_BENCHMARK_REGRESSION_H_
+#define ASSIGNMENTS_EV_BENCHMARK_REGRESSION_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Regression gate for EuclideanVector performance.
+//  RunBenchmarkSuite times a fixed suite of workloads: arithmetic on small vectors, dot products
+//  and norms of large ones, normalisation, an exhaustive k-nearest-neighbour scan and
+//  serialisation. The results are saved as a JSON baseline on a known-good build, and a later
+//  build is run on the same machine and compared against it. A benchmark regresses when it is
+//  slower than its baseline by more than its tolerance. Everything runs in process on generated
+//  data, so the gate needs no network or input files beyond the baseline.
+
+// Time of one benchmark of the suite
+//  name      - the workload and its size, e.g. "dot/65536"
+//  ns        - time of one operation in the fastest repetition, which is the least disturbed by
+//              other work on the machine
+//  spread    - (slowest - fastest) / fastest of the repetitions, how noisy the machine was
+//  tolerance - allowed slowdown when this result is a baseline, as a fraction of ns; 0 means the
+//              default of the comparison. Hand-edit it in the baseline for noisy benchmarks.
+struct BenchmarkResult {
+  std::string name;
+  double ns;
+  double spread;
+  double tolerance;
+};
+
+// Settings for RunBenchmarkSuite
+//  repetitions - timed runs of each benchmark; the fastest is reported
+//  min_time_ms - each run repeats the operation until it has taken at least this long
+//  filter      - only benchmarks whose name contains filter are run (empty runs all)
+struct BenchmarkParams {
+  int repetitions = 7;
+  double min_time_ms = 20;
+  std::string filter;
+};
+
+// Settings for CompareBenchmarks
+//  tolerance          - allowed slowdown as a fraction of the baseline time (0.1 is 10% slower)
+//                       for benchmarks whose baseline sets no tolerance of its own
+//  min_delta_ns       - slowdowns of fewer nanoseconds than this never regress, so that timer
+//                       noise on operations of a few nanoseconds cannot fail the gate
+//  override_baseline  - use tolerance for every benchmark, ignoring the baseline's own
+struct RegressionThresholds {
+  double tolerance = 0.1;
+  double min_delta_ns = 0.5;
+  bool override_baseline = false;
+};
+
+// How a benchmark compares with its baseline
+//  kUnchanged - within the tolerance either way
+//  kImproved  - faster by more than the tolerance
+//  kRegressed - slower by more than the tolerance (and by at least min_delta_ns)
+//  kMissing   - in the baseline but not in the results, so it can no longer be gated
+//  kAdded     - in the results but not in the baseline
+enum class BenchmarkVerdict { kUnchanged, kImproved, kRegressed, kMissing, kAdded };
+
+const char* ToString(BenchmarkVerdict verdict) noexcept;
+
+// One row of the comparison; baseline_ns or ns is 0 for kAdded and kMissing respectively
+struct BenchmarkComparison {
+  std::string name;
+  BenchmarkVerdict verdict;
+  double baseline_ns;
+  double ns;
+  double tolerance;
+
+  // Relative change in time, positive when slower
+  double Change() const noexcept { return this->ns / this->baseline_ns - 1; }
+};
+
+// Names of every benchmark in the suite, in the order they run
+std::vector<std::string> BenchmarkNames();
+
+std::vector<BenchmarkResult> RunBenchmarkSuite(const BenchmarkParams& params = BenchmarkParams{});
+
+// Runs one benchmark of the suite by name, ignoring params.filter
+BenchmarkResult RunBenchmark(const std::string& name,
+                             const BenchmarkParams& params = BenchmarkParams{});
+
+// Baselines are JSON: {"version":1,"benchmarks":[{"name":..,"ns":..,"spread":..,"tolerance":..}]}.
+//  Unknown fields are ignored when parsing, and spread and tolerance may be left out.
+std::string ToJson(const std::vector<BenchmarkResult>& results);
+std::vector<BenchmarkResult> ParseBaseline(const std::string& json);
+void SaveBaseline(const std::vector<BenchmarkResult>& results, const std::string& path);
+std::vector<BenchmarkResult> LoadBaseline(const std::string& path);
+
+// One comparison per benchmark: those of the baseline in its order, then the added ones
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const std::vector<BenchmarkResult>& baseline,
+    const std::vector<BenchmarkResult>& results,
+    const RegressionThresholds& thresholds = RegressionThresholds{});
+
+// True if any benchmark regressed or went missing
+bool HasRegressions(const std::vector<BenchmarkComparison>& comparisons) noexcept;
+
+// Writes the comparison as an aligned table, then the failing benchmarks and a PASS/FAIL line
+void WriteComparison(std::ostream& os, const std::vector<BenchmarkComparison>& comparisons);
+
+#endif  // ASSIGNMENTS_EV_BENCHMARK_REGRESSION_H_
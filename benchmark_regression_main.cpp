@@ -0,0 +1,137 @@
+// Runs the benchmark suite and gates it against a baseline.
+//
+//  benchmark_regression [options]
+//    --baseline FILE        compare against FILE and exit 1 if a benchmark regressed
+//    --write-baseline FILE  save this run as a new baseline (after any comparison)
+//    --tolerance F          default allowed slowdown as a fraction (0.1)
+//    --override-tolerances  use --tolerance even where the baseline sets its own
+//    --min-delta-ns F       ignore slowdowns smaller than F nanoseconds (0.5)
+//    --repetitions N        timed runs per benchmark, fastest reported (7)
+//    --min-time-ms F        minimum length of each timed run (20)
+//    --retries N            re-time a regressed benchmark up to N times before failing (2)
+//    --filter S             only run benchmarks whose name contains S
+//    --isa NAME             run on the NAME kernels instead of the detected ones
+//    --list                 print the benchmark names and exit
+//
+//  Without --baseline the results are printed as baseline JSON. Exits 0 on success, 1 on a
+//  regression, 2 on bad arguments or an unreadable baseline and 3 if the run itself fails (out
+//  of memory, a benchmark error or a baseline that cannot be written).
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "assignments/ev/benchmark_regression.h"
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/kernel_dispatch.h"
+
+namespace {
+
+constexpr int kRegressed = 1;
+constexpr int kUsageError = 2;
+constexpr int kRunFailed = 3;
+constexpr int kDefaultRetries = 2;
+
+// Value of the option at argv[i], advancing i past it
+std::string Value(int argc, char** argv, int& i) {
+  if (i + 1 >= argc) {
+    throw EuclideanVectorError(std::string{"Option "} + argv[i] + " needs a value");
+  }
+  return argv[++i];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkParams params;
+  RegressionThresholds thresholds;
+  std::string baseline_path;
+  std::string output_path;
+  int retries = kDefaultRetries;
+  std::vector<BenchmarkResult> baseline;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string option = argv[i];
+      if (option == "--baseline") {
+        baseline_path = Value(argc, argv, i);
+      } else if (option == "--write-baseline") {
+        output_path = Value(argc, argv, i);
+      } else if (option == "--tolerance") {
+        thresholds.tolerance = std::stod(Value(argc, argv, i));
+      } else if (option == "--override-tolerances") {
+        thresholds.override_baseline = true;
+      } else if (option == "--min-delta-ns") {
+        thresholds.min_delta_ns = std::stod(Value(argc, argv, i));
+      } else if (option == "--repetitions") {
+        params.repetitions = std::stoi(Value(argc, argv, i));
+      } else if (option == "--min-time-ms") {
+        params.min_time_ms = std::stod(Value(argc, argv, i));
+      } else if (option == "--retries") {
+        retries = std::stoi(Value(argc, argv, i));
+      } else if (option == "--filter") {
+        params.filter = Value(argc, argv, i);
+      } else if (option == "--isa") {
+        SetKernelIsa(KernelIsaFromString(Value(argc, argv, i)));
+      } else if (option == "--list") {
+        for (const std::string& name : BenchmarkNames()) {
+          std::cout << name << '\n';
+        }
+        return EXIT_SUCCESS;
+      } else {
+        throw EuclideanVectorError("Unknown option " + option);
+      }
+    }
+
+    // Read the baseline first so that a bad path fails before the suite runs
+    if (!baseline_path.empty()) {
+      for (BenchmarkResult& result : LoadBaseline(baseline_path)) {
+        if (result.name.find(params.filter) != std::string::npos) {
+          baseline.push_back(std::move(result));
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return kUsageError;
+  }
+
+  try {
+    std::cerr << "Running benchmarks on " << ToString(GetActiveKernelIsa()) << " kernels\n";
+    std::vector<BenchmarkResult> results = RunBenchmarkSuite(params);
+    std::vector<BenchmarkComparison> comparisons = CompareBenchmarks(baseline, results, thresholds);
+    // A regression has to reproduce: benchmarks that regressed are timed again and keep their
+    //  fastest time, so that a burst of other work on the machine does not fail the gate
+    for (int retry = 0; retry < retries && HasRegressions(comparisons); ++retry) {
+      for (BenchmarkResult& result : results) {
+        auto regressed = std::find_if(
+            comparisons.cbegin(), comparisons.cend(), [&result](const BenchmarkComparison& c) {
+              return c.name == result.name && c.verdict == BenchmarkVerdict::kRegressed;
+            });
+        if (regressed != comparisons.cend()) {
+          std::cerr << "Timing " << result.name << " again\n";
+          BenchmarkResult again = RunBenchmark(result.name, params);
+          result.ns = std::min(result.ns, again.ns);
+          result.spread = std::max(result.spread, again.spread);
+        }
+      }
+      comparisons = CompareBenchmarks(baseline, results, thresholds);
+    }
+
+    if (!output_path.empty()) {
+      SaveBaseline(results, output_path);
+    }
+    if (baseline_path.empty()) {
+      std::cout << ToJson(results);
+      return EXIT_SUCCESS;
+    }
+    WriteComparison(std::cout, comparisons);
+    return HasRegressions(comparisons) ? kRegressed : EXIT_SUCCESS;
+  } catch (const std::exception& e) {
+    std::cerr << "Benchmark run failed: " << e.what() << '\n';
+    return kRunFailed;
+  }
+}
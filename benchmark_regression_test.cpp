@@ -0,0 +1,166 @@
+/*
+
+  == Explanation and rational of testing ==
+  Timings differ from run to run, so the gate itself is tested on made-up results: each verdict
+  is produced by a change on the right side of its threshold, per-benchmark tolerances in the
+  baseline win unless overridden, tiny absolute changes never regress, and the readable diff
+  names the failing benchmarks. The baseline format must survive a round trip, accept fields it
+  does not know (so older runners can read newer baselines) and reject malformed files with a
+  message saying where. The suite is run on one small benchmark only, to check it produces sane
+  numbers without making the tests slow.
+
+*/
+
+#include "assignments/ev/benchmark_regression.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "catch.h"
+
+namespace {
+
+const BenchmarkComparison& Find(const std::vector<BenchmarkComparison>& comparisons,
+                                const std::string& name) {
+  return *std::find_if(comparisons.cbegin(), comparisons.cend(),
+                       [&name](const BenchmarkComparison& c) { return c.name == name; });
+}
+
+}  // namespace
+
+SCENARIO("Running the suite") {
+  WHEN("You run the small dot product benchmark") {
+    BenchmarkParams params;
+    params.repetitions = 3;
+    params.min_time_ms = 1;
+    params.filter = "dot/3";
+    std::vector<BenchmarkResult> results = RunBenchmarkSuite(params);
+    std::vector<std::string> names = BenchmarkNames();
+    THEN("Only it runs and it takes a positive time") {
+      REQUIRE(results.size() == 1);
+      REQUIRE(results[0].name == "dot/3");
+      REQUIRE(results[0].ns > 0);
+      REQUIRE(results[0].spread >= 0);
+      REQUIRE(std::find(names.cbegin(), names.cend(), "find_nearest/10000x128/k10") !=
+              names.cend());
+      params.filter = "no such benchmark";
+      REQUIRE(RunBenchmarkSuite(params).empty());
+    }
+  }
+}
+
+SCENARIO("Baseline files") {
+  WHEN("You write results as JSON and parse them back") {
+    std::vector<BenchmarkResult> results{{"add/3", 12.5, 0.02, 0}, {"dot/4096", 810.25, 0.1, 0.3}};
+    std::vector<BenchmarkResult> parsed = ParseBaseline(ToJson(results));
+    THEN("Every field survives") {
+      REQUIRE(parsed.size() == 2);
+      for (std::size_t i = 0; i < 2; ++i) {
+        REQUIRE(parsed[i].name == results[i].name);
+        REQUIRE(parsed[i].ns == results[i].ns);
+        REQUIRE(parsed[i].spread == results[i].spread);
+        REQUIRE(parsed[i].tolerance == results[i].tolerance);
+      }
+    }
+  }
+  WHEN("You parse a hand-written baseline with extra fields") {
+    std::vector<BenchmarkResult> parsed = ParseBaseline(R"({
+      "machine": {"cpu": "x86_64", "cores": [0, 1], "smt": false, "note": null},
+      "version": 1,
+      "benchmarks": [ {"name": "norm/3", "unit": "ns", "ns": 4e0},
+                      {"name": "a \"quoted\" name", "ns": 1.5, "tolerance": 0.25} ]
+    })");
+    THEN("The extra fields are ignored and missing ones default to 0") {
+      REQUIRE(parsed.size() == 2);
+      REQUIRE(parsed[0].name == "norm/3");
+      REQUIRE(parsed[0].ns == 4);
+      REQUIRE(parsed[0].tolerance == 0);
+      REQUIRE(parsed[1].name == "a \"quoted\" name");
+      REQUIRE(parsed[1].tolerance == 0.25);
+      REQUIRE(ParseBaseline(ToJson(parsed))[1].name == "a \"quoted\" name");
+      REQUIRE(ParseBaseline(R"({"benchmarks":[]})").empty());
+    }
+  }
+}
+
+SCENARIO("Comparing against a baseline") {
+  std::vector<BenchmarkResult> baseline{{"steady", 100, 0, 0},      {"slower", 100, 0, 0},
+                                        {"much_slower", 100, 0, 0}, {"noisy", 100, 0, 0.5},
+                                        {"faster", 100, 0, 0},      {"tiny", 2, 0, 0},
+                                        {"gone", 100, 0, 0}};
+  std::vector<BenchmarkResult> results{{"steady", 104, 0, 0}, {"slower", 109, 0, 0},
+                                       {"much_slower", 125, 0, 0}, {"noisy", 140, 0, 0},
+                                       {"faster", 80, 0, 0},   {"tiny", 2.4, 0, 0},
+                                       {"new", 50, 0, 0}};
+  WHEN("You compare with the default 10% tolerance") {
+    std::vector<BenchmarkComparison> comparisons = CompareBenchmarks(baseline, results);
+    std::ostringstream diff;
+    WriteComparison(diff, comparisons);
+    THEN("Only changes beyond the tolerance count and the diff names the failures") {
+      REQUIRE(comparisons.size() == 8);
+      REQUIRE(comparisons.back().name == "new");
+      REQUIRE(Find(comparisons, "steady").verdict == BenchmarkVerdict::kUnchanged);
+      REQUIRE(Find(comparisons, "slower").verdict == BenchmarkVerdict::kUnchanged);
+      REQUIRE(Find(comparisons, "much_slower").verdict == BenchmarkVerdict::kRegressed);
+      REQUIRE(Find(comparisons, "much_slower").Change() == Approx(0.25));
+      REQUIRE(Find(comparisons, "noisy").verdict == BenchmarkVerdict::kUnchanged);
+      REQUIRE(Find(comparisons, "faster").verdict == BenchmarkVerdict::kImproved);
+      REQUIRE(Find(comparisons, "tiny").verdict == BenchmarkVerdict::kUnchanged);
+      REQUIRE(Find(comparisons, "gone").verdict == BenchmarkVerdict::kMissing);
+      REQUIRE(Find(comparisons, "new").verdict == BenchmarkVerdict::kAdded);
+      REQUIRE(HasRegressions(comparisons));
+      REQUIRE(diff.str().find("much_slower: 100.00 ns -> 125.00 ns (+25.0%, limit +10.0%)") !=
+              std::string::npos);
+      REQUIRE(diff.str().find("gone: in the baseline but was not run") != std::string::npos);
+      REQUIRE(diff.str().find("FAIL: 8 benchmarks, 1 regressed, 1 missing, 1 improved, 1 added") !=
+              std::string::npos);
+    }
+  }
+  WHEN("You override the tolerances and drop the missing benchmark") {
+    RegressionThresholds thresholds;
+    thresholds.tolerance = 0.05;
+    thresholds.override_baseline = true;
+    thresholds.min_delta_ns = 0;
+    baseline.pop_back();
+    std::vector<BenchmarkComparison> strict = CompareBenchmarks(baseline, results, thresholds);
+    thresholds.tolerance = 0.5;
+    std::vector<BenchmarkComparison> loose = CompareBenchmarks(baseline, results, thresholds);
+    std::ostringstream diff;
+    WriteComparison(diff, loose);
+    THEN("The command line tolerance applies to every benchmark") {
+      REQUIRE(Find(strict, "slower").verdict == BenchmarkVerdict::kRegressed);
+      REQUIRE(Find(strict, "noisy").verdict == BenchmarkVerdict::kRegressed);
+      REQUIRE(Find(strict, "tiny").verdict == BenchmarkVerdict::kRegressed);
+      REQUIRE(Find(strict, "noisy").tolerance == 0.05);
+      REQUIRE_FALSE(HasRegressions(loose));
+      REQUIRE(diff.str().find("PASS") != std::string::npos);
+      REQUIRE(diff.str().find("REGRESSED") == std::string::npos);
+    }
+  }
+}
+
+// EXCEPTION - Malformed, duplicated, incomplete and unreadable baselines and unknown benchmarks
+//  are rejected
+SCENARIO("Invalid baselines") {
+  WHEN("You parse or load a bad baseline") {
+    THEN("EuclideanVectorError is thrown") {
+      REQUIRE_THROWS_WITH(ParseBaseline(R"({"benchmarks":[{"name":"a","ns":1}})"),
+                          "Baseline is not valid JSON: expected ']' at offset 34");
+      REQUIRE_THROWS_WITH(ParseBaseline("{} trailing"),
+                          "Baseline is not valid JSON: unexpected trailing characters at offset 3");
+      REQUIRE_THROWS_WITH(ParseBaseline(R"({"version":1})"), "Baseline has no benchmarks");
+      REQUIRE_THROWS_WITH(ParseBaseline(R"({"version":2,"benchmarks":[]})"),
+                          "Baseline version 2 is not supported");
+      REQUIRE_THROWS_WITH(
+          ParseBaseline(R"({"benchmarks":[{"name":"a","ns":1},{"name":"a","ns":2}]})"),
+          "Baseline lists a twice");
+      REQUIRE_THROWS_WITH(ParseBaseline(R"({"benchmarks":[{"name":"a"}]})"),
+                          "Baseline benchmark 0 needs a name, a positive ns and a non-negative "
+                          "tolerance");
+      REQUIRE_THROWS_WITH(LoadBaseline("/nonexistent/baseline.json"),
+                          "Could not open /nonexistent/baseline.json for reading");
+      REQUIRE_THROWS_WITH(RunBenchmark("dot"), "No benchmark named dot");
+    }
+  }
+}
@@ -0,0 +1,140 @@
+#ifndef ASSIGNMENTS_EV_BOUNDED_QUEUE_H_
+#define ASSIGNMENTS_EV_BOUNDED_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Lock-free single-producer single-consumer ring buffer.
+//  Exactly one thread may push and exactly one (other) thread may pop. The producer calls Close()
+//  once it is done; the consumer then drains what is left and Pop() starts returning false.
+//  A blocked Push() or Pop() spins, then yields, then parks until the other side makes progress,
+//  so a stage waiting on a slow one does not keep a core busy.
+template <typename T>
+class BoundedQueue {
+ public:
+  /* CONSTRUCTORS */
+  // capacity is rounded up to a power of two
+  explicit BoundedQueue(std::size_t capacity)
+    : slots_(RoundUp(capacity)), mask_{slots_.size() - 1} {}
+
+  /* METHODS */
+  std::size_t GetCapacity() const noexcept { return this->slots_.size(); }
+
+  bool TryPush(T value) noexcept {
+    std::size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail - this->head_.load(std::memory_order_acquire) == this->slots_.size()) {
+      return false;
+    }
+    this->slots_[tail & this->mask_] = std::move(value);
+    this->tail_.store(tail + 1, std::memory_order_release);
+    Wake();
+    return true;
+  }
+
+  bool TryPop(T& value) noexcept {
+    std::size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = std::move(this->slots_[head & this->mask_]);
+    this->head_.store(head + 1, std::memory_order_release);
+    Wake();
+    return true;
+  }
+
+  // Blocking push; gives up (returning false) if cancel becomes true while the queue is full
+  bool Push(T value, const std::atomic<bool>& cancel) noexcept {
+    for (int spins = 0; !TryPush(value); ++spins) {
+      if (cancel.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      Backoff(spins, [this] {
+        return this->tail_.load(std::memory_order_acquire) -
+                   this->head_.load(std::memory_order_acquire) !=
+               this->slots_.size();
+      });
+    }
+    return true;
+  }
+
+  // Blocking pop; returns false once the queue is closed and empty, or if cancel becomes true
+  bool Pop(T& value, const std::atomic<bool>& cancel) noexcept {
+    for (int spins = 0; !TryPop(value); ++spins) {
+      if (this->closed_.load(std::memory_order_acquire)) {
+        return TryPop(value);  // pick up anything pushed just before Close()
+      }
+      if (cancel.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      Backoff(spins, [this] {
+        return this->head_.load(std::memory_order_acquire) !=
+                   this->tail_.load(std::memory_order_acquire) ||
+               this->closed_.load(std::memory_order_acquire);
+      });
+    }
+    return true;
+  }
+
+  void Close() noexcept {
+    this->closed_.store(true, std::memory_order_release);
+    Wake();
+  }
+
+ private:
+  static std::size_t RoundUp(std::size_t capacity) noexcept {
+    std::size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  // Spins briefly, then yields so a waiting stage does not starve the stage it is waiting on, then
+  //  parks until ready() holds. Nothing signals cancel, so the park is timed and the caller
+  //  rechecks it at least every kParkTimeout.
+  template <typename Ready>
+  void Backoff(int spins, Ready ready) noexcept {
+    if (spins <= kSpins) {
+      return;
+    }
+    if (spins <= kYields) {
+      std::this_thread::yield();
+      return;
+    }
+    std::unique_lock lock{this->park_mutex_};
+    // Both sides update sleepers_, so one of the two comes second in its modification order:
+    //  either Wake sees this sleeper, or ready() sees the update made before that Wake
+    this->sleepers_.fetch_add(1, std::memory_order_acq_rel);
+    this->parked_.wait_for(lock, kParkTimeout, ready);
+    this->sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Wakes the other side if it is parked; costs one atomic add when it is not
+  void Wake() noexcept {
+    if (this->sleepers_.fetch_add(0, std::memory_order_acq_rel) != 0) {
+      std::lock_guard lock{this->park_mutex_};
+      this->parked_.notify_all();
+    }
+  }
+
+  static constexpr int kSpins = 64;
+  static constexpr int kYields = 1024;
+  static constexpr std::chrono::milliseconds kParkTimeout{1};
+
+  std::vector<T> slots_;
+  std::size_t mask_;
+  alignas(64) std::atomic<std::size_t> head_{0};  // next slot to pop (written by the consumer)
+  alignas(64) std::atomic<std::size_t> tail_{0};  // next slot to push (written by the producer)
+  std::atomic<bool> closed_{false};
+  std::atomic<int> sleepers_{0};
+  std::mutex park_mutex_;
+  std::condition_variable parked_;
+};
+
+#endif  // ASSIGNMENTS_EV_BOUNDED_QUEUE_H_
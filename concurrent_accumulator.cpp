@@ -0,0 +1,134 @@
+#include "assignments/ev/concurrent_accumulator.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+void AtomicAdd(std::atomic<double>& sum, double value) noexcept {
+  double expected = sum.load(std::memory_order_relaxed);
+  while (!sum.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+/* CONSTRUCTORS */
+ConcurrentAccumulator::ConcurrentAccumulator(int num_dimensions)
+  : num_dimensions_{num_dimensions}, epoch_{0}, writers_{},
+    total_(static_cast<std::size_t>(num_dimensions)) {
+  for (auto& buffer : this->buffers_) {
+    buffer = std::make_unique<std::atomic<double>[]>(static_cast<std::size_t>(num_dimensions));
+    for (int j = 0; j < num_dimensions; ++j) {
+      buffer[j].store(0, std::memory_order_relaxed);
+    }
+  }
+  for (auto& writers : this->writers_) {
+    writers.count.store(0, std::memory_order_relaxed);
+  }
+}
+
+ConcurrentAccumulator::Shard::Shard(ConcurrentAccumulator& owner, std::size_t flush_interval)
+  : owner_{&owner}, sums_(static_cast<std::size_t>(owner.num_dimensions_)), pending_{0},
+    flush_interval_{flush_interval} {}
+
+ConcurrentAccumulator::Shard::Shard(Shard&& o) noexcept
+  : owner_{o.owner_}, sums_{std::move(o.sums_)}, pending_{o.pending_},
+    flush_interval_{o.flush_interval_} {
+  o.owner_ = nullptr;
+  o.pending_ = 0;
+}
+
+/* DESTRUCTORS */
+ConcurrentAccumulator::Shard::~Shard() noexcept {
+  Flush();
+}
+
+/* METHODS */
+void ConcurrentAccumulator::Add(const EuclideanVector& ev) {
+  CheckDimensions(ev.GetNumDimensions());
+  Add(ev.data());
+}
+
+// Registers as a writer of the current buffer before adding into it. Re-reading the epoch after
+//  registering closes the race with a snapshot switching buffers in between: either the snapshot
+//  sees this writer and waits for it, or this writer sees the switch and moves to the new buffer.
+void ConcurrentAccumulator::Add(const double* magnitudes) noexcept {
+  int epoch = this->epoch_.load();
+  for (;;) {
+    this->writers_[epoch].count.fetch_add(1);
+    int current = this->epoch_.load();
+    if (current == epoch) {
+      break;
+    }
+    this->writers_[epoch].count.fetch_sub(1);
+    epoch = current;
+  }
+
+  std::atomic<double>* sums = this->buffers_[epoch].get();
+  for (int j = 0; j < this->num_dimensions_; ++j) {
+    if (magnitudes[j] != 0) {
+      AtomicAdd(sums[j], magnitudes[j]);
+    }
+  }
+  this->writers_[epoch].count.fetch_sub(1, std::memory_order_release);
+}
+
+ConcurrentAccumulator::Shard ConcurrentAccumulator::MakeShard(std::size_t flush_interval) {
+  return Shard{*this, flush_interval};
+}
+
+EuclideanVector ConcurrentAccumulator::Snapshot() {
+  std::lock_guard lock{this->snapshot_mutex_};
+  int old_epoch = this->epoch_.load();
+  this->epoch_.store(1 - old_epoch);
+  // Store then load, mirrored by Add's increment then load: only if both sides are seq_cst is one
+  //  of them guaranteed to see the other. An acquire load here could read a stale 0 while a writer
+  //  still reads the old epoch, and that writer's sums would be lost.
+  while (this->writers_[old_epoch].count.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  std::atomic<double>* sums = this->buffers_[old_epoch].get();
+  for (std::size_t j = 0; j < this->total_.size(); ++j) {
+    this->total_[j] += sums[j].load(std::memory_order_relaxed);
+    sums[j].store(0, std::memory_order_relaxed);
+  }
+  return EuclideanVector(this->total_.cbegin(), this->total_.cend());
+}
+
+void ConcurrentAccumulator::Shard::Add(const EuclideanVector& ev) {
+  if (this->owner_ != nullptr) {
+    this->owner_->CheckDimensions(ev.GetNumDimensions());
+  }
+  Add(ev.data());
+}
+
+void ConcurrentAccumulator::Shard::Add(const double* magnitudes) noexcept {
+  for (std::size_t j = 0; j < this->sums_.size(); ++j) {
+    this->sums_[j] += magnitudes[j];
+  }
+  if (++this->pending_ == this->flush_interval_) {
+    Flush();
+  }
+}
+
+void ConcurrentAccumulator::Shard::Flush() noexcept {
+  if (this->owner_ == nullptr || this->pending_ == 0) {
+    return;
+  }
+  this->owner_->Add(this->sums_.data());
+  std::fill(this->sums_.begin(), this->sums_.end(), 0.0);
+  this->pending_ = 0;
+}
+
+/* HELPERS */
+void ConcurrentAccumulator::CheckDimensions(std::size_t num_dimensions) const {
+  if (num_dimensions != static_cast<std::size_t>(this->num_dimensions_)) {
+    throw EuclideanVectorError("Dimensions of accumulator(" +
+                               std::to_string(this->num_dimensions_) + ") and vector(" +
+                               std::to_string(num_dimensions) + ") do not match");
+  }
+}
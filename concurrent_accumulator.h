@@ -0,0 +1,84 @@
+#ifndef ASSIGNMENTS_EV_CONCURRENT_ACCUMULATOR_H_
+#define ASSIGNMENTS_EV_CONCURRENT_ACCUMULATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+
+// A vector sum that many threads can add into at once without a lock.
+//  Add() adds element by element with atomic compare-exchange, so concurrent updates never lose
+//  each other. Threads adding often should take a Shard instead: it sums into a private buffer
+//  and only touches the shared sums every flush_interval updates.
+//
+//  Snapshot() is consistent: it contains every update that completed before it was called and no
+//  part of any update still in progress. Updates go to one of two buffers; a snapshot switches
+//  writers over to the other buffer, waits for the writers already in the first to finish, then
+//  folds it into the running total.
+class ConcurrentAccumulator {
+ public:
+  // A thread's private partial sum. Not thread-safe itself; flushes when destroyed.
+  class Shard {
+   public:
+    /* CONSTRUCTORS */
+    Shard(Shard&& o) noexcept;
+    Shard(const Shard&) = delete;
+    Shard& operator=(const Shard&) = delete;
+    Shard& operator=(Shard&&) = delete;
+
+    /* DESTRUCTORS */
+    ~Shard() noexcept;
+
+    /* METHODS */
+    void Add(const EuclideanVector& ev);
+    void Add(const double* magnitudes) noexcept;
+    // Adds the pending partial sum into the shared sums
+    void Flush() noexcept;
+
+   private:
+    friend class ConcurrentAccumulator;
+    Shard(ConcurrentAccumulator& owner, std::size_t flush_interval);
+
+    ConcurrentAccumulator* owner_;  // nullptr once moved from
+    std::vector<double> sums_;
+    std::size_t pending_;  // updates in sums_ not yet flushed
+    std::size_t flush_interval_;
+  };
+
+  /* CONSTRUCTORS */
+  explicit ConcurrentAccumulator(int num_dimensions);
+
+  /* METHODS */
+  int GetNumDimensions() const noexcept { return this->num_dimensions_; }
+
+  // Atomically adds ev to the sums (lock-free)
+  void Add(const EuclideanVector& ev);
+  void Add(const double* magnitudes) noexcept;
+
+  // A shard that flushes itself after every flush_interval updates (0 only flushes on Flush() and
+  //  destruction)
+  Shard MakeShard(std::size_t flush_interval = 64);
+
+  // The sum of every update completed before the call
+  EuclideanVector Snapshot();
+
+ private:
+  void CheckDimensions(std::size_t num_dimensions) const;
+
+  int num_dimensions_;
+  std::unique_ptr<std::atomic<double>[]> buffers_[2];
+  std::atomic<int> epoch_;  // which buffer writers add into
+
+  struct alignas(64) Writers {
+    std::atomic<int> count;
+  };
+  Writers writers_[2];  // writers currently adding into each buffer
+
+  std::mutex snapshot_mutex_;  // serialises snapshots (writers never take it)
+  std::vector<double> total_;  // everything folded in by previous snapshots
+};
+
+#endif  // ASSIGNMENTS_EV_CONCURRENT_ACCUMULATOR_H_
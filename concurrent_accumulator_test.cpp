@@ -0,0 +1,138 @@
+/*
+
+  == Explanation and rational of testing ==
+  All updates use small integers so that every sum is exact whatever order the additions happen
+  in, letting the concurrent results be compared with ==. Lost updates would show up as a total
+  that is too small. Consistency of snapshots is tested with updates that add the same value to
+  every dimension: a snapshot taken in the middle of an update would have unequal dimensions.
+
+*/
+
+#include "assignments/ev/concurrent_accumulator.h"
+
+#include <thread>
+#include <vector>
+
+#include "catch.h"
+
+SCENARIO("Accumulating on one thread") {
+  WHEN("You add vectors directly and through a shard") {
+    ConcurrentAccumulator acc{3};
+    std::vector<double> v{1, 2, 3};
+    acc.Add(EuclideanVector{v.cbegin(), v.cend()});
+    {
+      auto shard = acc.MakeShard(0);
+      shard.Add(EuclideanVector{v.cbegin(), v.cend()});
+      shard.Add(EuclideanVector{3, 1.0});
+      THEN("Shard updates are only visible once flushed") {
+        REQUIRE(acc.Snapshot() == EuclideanVector(v.cbegin(), v.cend()));
+        shard.Flush();
+        std::vector<double> expected{3, 5, 7};
+        REQUIRE(acc.Snapshot() == EuclideanVector(expected.cbegin(), expected.cend()));
+      }
+    }
+    THEN("Destroying a shard flushes it") {
+      std::vector<double> expected{3, 5, 7};
+      REQUIRE(acc.Snapshot() == EuclideanVector(expected.cbegin(), expected.cend()));
+    }
+  }
+}
+
+SCENARIO("Accumulating from many threads") {
+  constexpr int kThreads = 8;
+  constexpr int kUpdates = 5001;
+  std::vector<double> v{1, -2, 3, 0, 5};
+  const EuclideanVector update{v.cbegin(), v.cend()};
+  const EuclideanVector expected = update * (kThreads * kUpdates);
+
+  WHEN("Every thread adds atomically") {
+    ConcurrentAccumulator acc{5};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < kUpdates; ++i) {
+          acc.Add(update);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    THEN("No update is lost") {
+      REQUIRE(acc.Snapshot() == expected);
+    }
+  }
+  WHEN("Every thread adds through its own shard") {
+    ConcurrentAccumulator acc{5};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&] {
+        auto shard = acc.MakeShard(100);
+        for (int i = 0; i < kUpdates; ++i) {
+          shard.Add(update);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    THEN("No update is lost") {
+      REQUIRE(acc.Snapshot() == expected);
+    }
+  }
+}
+
+SCENARIO("Taking snapshots while threads are adding") {
+  WHEN("Writers add all-ones vectors and a reader snapshots concurrently") {
+    ConcurrentAccumulator acc{64};
+    const EuclideanVector ones{64, 1.0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+      writers.emplace_back([&, t] {
+        auto shard = acc.MakeShard(static_cast<std::size_t>(t));  // shard 0 never auto-flushes
+        for (int i = 0; i < 20000; ++i) {
+          if (t % 2 == 0) {
+            acc.Add(ones);
+          } else {
+            shard.Add(ones);
+          }
+        }
+      });
+    }
+
+    int inconsistent = 0;
+    int decreasing = 0;
+    double previous = 0;
+    for (int s = 0; s < 200; ++s) {
+      EuclideanVector snapshot = acc.Snapshot();
+      for (int j = 1; j < 64; ++j) {
+        inconsistent += snapshot[j] != snapshot[0];
+      }
+      decreasing += snapshot[0] < previous;
+      previous = snapshot[0];
+    }
+    for (auto& writer : writers) {
+      writer.join();
+    }
+
+    THEN("Every snapshot has whole updates only and totals never go backwards") {
+      REQUIRE(inconsistent == 0);
+      REQUIRE(decreasing == 0);
+      REQUIRE(acc.Snapshot() == EuclideanVector{64, 4 * 20000.0});
+    }
+  }
+}
+
+// EXCEPTION - Vectors must have the accumulator's dimensions
+SCENARIO("Adding a vector of the wrong dimension") {
+  WHEN("You add a 2 dimensional vector to a 3 dimensional accumulator") {
+    ConcurrentAccumulator acc{3};
+    auto shard = acc.MakeShard();
+    THEN("An exception is thrown") {
+      REQUIRE_THROWS_WITH(acc.Add(EuclideanVector{2}),
+                          "Dimensions of accumulator(3) and vector(2) do not match");
+      REQUIRE_THROWS_WITH(shard.Add(EuclideanVector{2}),
+                          "Dimensions of accumulator(3) and vector(2) do not match");
+    }
+  }
+}
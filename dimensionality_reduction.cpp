@@ -0,0 +1,492 @@
+#include "assignments/ev/dimensionality_reduction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <utility>
+
+#include "assignments/ev/parallel_for.h"
+#include "assignments/ev/vector_kernels.h"
+#include "assignments/ev/vector_random.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'E', 'V', 'L', 'P'};
+constexpr std::uint32_t kVersion = 1;
+// Doubles reserved up front when loading; sizes come from the stream, so beyond this storage only
+//  grows as data is actually read
+constexpr std::size_t kMaxLoadReserve = std::size_t{1} << 16;
+
+// Vectors projected together, and rows of W each of them is projected onto before moving to the
+//  next rows; 16 rows of a 1024 dimensional W are 128KB, which stays in L2
+constexpr std::size_t kVectorTile = 32;
+constexpr std::size_t kComponentTile = 16;
+// Extra vectors carried through subspace iteration; the convergence rate of the k-th eigenvector
+//  depends on lambda(k + kOversample) / lambda(k) rather than on lambda(k + 1) / lambda(k)
+constexpr std::size_t kOversample = 10;
+// Vectors per block of the covariance sweep; a block of 1024 dimensional vectors is 2MB
+constexpr std::size_t kCovarianceBlock = 256;
+// Rows of the covariance matrix below which another thread is not worth starting
+constexpr std::size_t kMinCovarianceRowsPerThread = 16;
+
+template <typename T>
+void Write(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T Read(std::istream& is) {
+  T value{};
+  if (!is.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw EuclideanVectorError("LinearProjection stream ended unexpectedly");
+  }
+  return value;
+}
+
+void CheckDimensions(int expected, std::size_t actual, const char* what) {
+  if (actual != static_cast<std::size_t>(expected)) {
+    throw EuclideanVectorError("Dimensions of projection(" + std::to_string(expected) + ") and " +
+                               what + "(" + std::to_string(actual) + ") do not match");
+  }
+}
+
+// First row of thread t's share of the upper triangle of a d x d matrix, so that every thread
+//  gets about the same number of entries (row i has d - i of them)
+std::size_t TriangleSplit(std::size_t d, std::size_t t, std::size_t threads) noexcept {
+  const double total = static_cast<double>(d) * static_cast<double>(d + 1) / 2;
+  const double target = total * static_cast<double>(t) / static_cast<double>(threads);
+  double done = 0;
+  std::size_t i = 0;
+  while (i < d && done < target) {
+    done += static_cast<double>(d - i);
+    ++i;
+  }
+  return i;
+}
+
+// Sample covariance of data (d x d, row-major). Each thread owns a band of rows of the upper
+//  triangle and sweeps the vectors kCovarianceBlock at a time: the block is centred and transposed
+//  so that each entry's share of the block is one Dot of two contiguous columns, run by the
+//  dispatched SIMD kernels, while the columns of the band stay in cache.
+std::vector<double> Covariance(const EuclideanVectorBatch& data,
+                               const std::vector<double>& mean,
+                               int num_threads) {
+  const auto d = static_cast<std::size_t>(data.GetNumDimensions());
+  const std::size_t n = data.size();
+  std::vector<double> covariance(d * d);
+  auto threads =
+      static_cast<std::size_t>(NumThreads(num_threads, d, kMinCovarianceRowsPerThread));
+  ParallelFor(threads, static_cast<int>(threads), [&](std::size_t, std::size_t t, std::size_t) {
+    const std::size_t row_begin = TriangleSplit(d, t, threads);
+    const std::size_t row_end = TriangleSplit(d, t + 1, threads);
+    if (row_begin == row_end) {
+      return;
+    }
+    // Only columns row_begin and up are needed by this band
+    std::vector<double> columns((d - row_begin) * kCovarianceBlock);
+    auto column = [&](std::size_t c) { return &columns[(c - row_begin) * kCovarianceBlock]; };
+    for (std::size_t first = 0; first < n; first += kCovarianceBlock) {
+      const std::size_t count = std::min(kCovarianceBlock, n - first);
+      for (std::size_t r = 0; r < count; ++r) {
+        const double* row = data.Row(first + r);
+        for (std::size_t c = row_begin; c < d; ++c) {
+          column(c)[r] = row[c] - mean[c];
+        }
+      }
+      for (std::size_t i = row_begin; i < row_end; ++i) {
+        for (std::size_t j = i; j < d; ++j) {
+          covariance[i * d + j] += Dot(column(i), column(j), count);
+        }
+      }
+    }
+  });
+  const double scale = 1 / static_cast<double>(n - 1);
+  for (std::size_t i = 0; i < d; ++i) {
+    for (std::size_t j = i; j < d; ++j) {
+      covariance[i * d + j] *= scale;
+      covariance[j * d + i] = covariance[i * d + j];
+    }
+  }
+  return covariance;
+}
+
+// Eigenvalues (largest first) and eigenvectors of the symmetric n x n matrix a by cyclic Jacobi
+//  rotations; column j of vectors (row-major) belongs to eigenvalue j
+void SymmetricEigen(std::vector<double> a,
+                    std::size_t n,
+                    std::vector<double>& values,
+                    std::vector<double>& vectors) {
+  std::vector<double> v(n * n);
+  for (std::size_t i = 0; i < n; ++i) {
+    v[i * n + i] = 1;
+  }
+  for (int sweep = 0; sweep < 100; ++sweep) {
+    double off = 0;
+    double diagonal = 0;
+    for (std::size_t p = 0; p < n; ++p) {
+      diagonal += a[p * n + p] * a[p * n + p];
+      for (std::size_t q = p + 1; q < n; ++q) {
+        off += a[p * n + q] * a[p * n + q];
+      }
+    }
+    if (off <= 1e-30 * diagonal || off == 0) {
+      break;
+    }
+    for (std::size_t p = 0; p < n; ++p) {
+      for (std::size_t q = p + 1; q < n; ++q) {
+        const double apq = a[p * n + q];
+        if (apq == 0) {
+          continue;
+        }
+        // The smaller root of t^2 + 2 theta t - 1 = 0 zeroes a[p][q] with the smallest rotation
+        const double theta = (a[q * n + q] - a[p * n + p]) / (2 * apq);
+        const double t = (theta >= 0 ? 1.0 : -1.0) / (std::fabs(theta) + std::hypot(theta, 1.0));
+        const double c = 1 / std::sqrt(t * t + 1);
+        const double s = t * c;
+        for (std::size_t k = 0; k < n; ++k) {
+          const double akp = a[k * n + p];
+          const double akq = a[k * n + q];
+          a[k * n + p] = c * akp - s * akq;
+          a[k * n + q] = s * akp + c * akq;
+        }
+        for (std::size_t k = 0; k < n; ++k) {
+          const double apk = a[p * n + k];
+          const double aqk = a[q * n + k];
+          a[p * n + k] = c * apk - s * aqk;
+          a[q * n + k] = s * apk + c * aqk;
+          const double vkp = v[k * n + p];
+          const double vkq = v[k * n + q];
+          v[k * n + p] = c * vkp - s * vkq;
+          v[k * n + q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::sort(order.begin(), order.end(),
+            [&a, n](std::size_t x, std::size_t y) { return a[x * n + x] > a[y * n + y]; });
+  values.resize(n);
+  vectors.resize(n * n);
+  for (std::size_t j = 0; j < n; ++j) {
+    values[j] = a[order[j] * n + order[j]];
+    for (std::size_t k = 0; k < n; ++k) {
+      vectors[k * n + j] = v[k * n + order[j]];
+    }
+  }
+}
+
+// Makes the count vectors of length d in rows orthonormal (modified Gram-Schmidt, run twice per
+//  vector so that the result stays orthogonal to working precision). A vector that is (nearly) in
+//  the span of the earlier ones is replaced by a unit basis vector, which happens when the data
+//  has fewer directions of variance than vectors are iterated.
+void Orthonormalize(std::vector<double>& rows, std::size_t count, std::size_t d) {
+  for (std::size_t j = 0; j < count; ++j) {
+    double* q = &rows[j * d];
+    for (std::size_t attempt = 0;; ++attempt) {
+      const double before = std::sqrt(SquaredNorm(q, d));
+      for (int pass = 0; pass < 2; ++pass) {
+        for (std::size_t m = 0; m < j; ++m) {
+          const double* earlier = &rows[m * d];
+          const double projection = Dot(q, earlier, d);
+          for (std::size_t i = 0; i < d; ++i) {
+            q[i] -= projection * earlier[i];
+          }
+        }
+      }
+      const double norm = std::sqrt(SquaredNorm(q, d));
+      if (norm > 1e-10 * before && norm > 0) {
+        ScaleMagnitudes(q, 1 / norm, q, d);
+        break;
+      }
+      if (attempt == d) {
+        break;  // count > d: left as zero
+      }
+      std::fill(q, q + d, 0.0);
+      q[(j + attempt) % d] = 1;
+    }
+  }
+}
+
+// rows (count x d) times the count x count matrix v: out row j = sum over m of v[m][j] * row m
+std::vector<double> Rotate(const std::vector<double>& rows,
+                           const std::vector<double>& v,
+                           std::size_t count,
+                           std::size_t d) {
+  std::vector<double> out(count * d);
+  for (std::size_t j = 0; j < count; ++j) {
+    double* target = &out[j * d];
+    for (std::size_t m = 0; m < count; ++m) {
+      const double coefficient = v[m * count + j];
+      const double* row = &rows[m * d];
+      for (std::size_t i = 0; i < d; ++i) {
+        target[i] += coefficient * row[i];
+      }
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+/* CONSTRUCTORS */
+LinearProjection::LinearProjection(ProjectionKind kind,
+                                   EuclideanVectorBatch components,
+                                   std::vector<double> mean,
+                                   std::vector<double> explained_variance)
+  : kind_{kind}, components_{std::move(components)}, mean_{std::move(mean)},
+    explained_variance_{std::move(explained_variance)} {
+  if (!this->mean_.empty()) {
+    CheckDimensions(this->GetInputDimensions(), this->mean_.size(), "mean");
+  }
+  if (!this->explained_variance_.empty() &&
+      this->explained_variance_.size() != this->components_.size()) {
+    throw EuclideanVectorError("LinearProjection needs one explained variance per component");
+  }
+}
+
+/* METHODS */
+void LinearProjection::Project(const double* x,
+                               double* y,
+                               std::vector<double>& x_buffer) const noexcept {
+  const auto d = static_cast<std::size_t>(this->GetInputDimensions());
+  if (!this->mean_.empty()) {
+    x_buffer.resize(d);
+    SubtractMagnitudes(x, this->mean_.data(), x_buffer.data(), d);
+    x = x_buffer.data();
+  }
+  for (std::size_t o = 0; o < this->components_.size(); ++o) {
+    y[o] = Dot(x, this->components_.Row(o), d);
+  }
+}
+
+EuclideanVector LinearProjection::Transform(const EuclideanVector& ev) const {
+  CheckDimensions(this->GetInputDimensions(), ev.GetNumDimensions(), "vector");
+  EuclideanVector out(this->components_.size());
+  std::vector<double> buffer;
+  this->Project(ev.data(), out.data(), buffer);
+  return out;
+}
+
+// Tile by tile: kVectorTile centred vectors against kComponentTile rows of W at a time
+EuclideanVectorBatch LinearProjection::Transform(const EuclideanVectorBatch& batch,
+                                                 int num_threads) const {
+  CheckDimensions(this->GetInputDimensions(), static_cast<std::size_t>(batch.GetNumDimensions()),
+                  "batch");
+  const auto d = static_cast<std::size_t>(this->GetInputDimensions());
+  const std::size_t k = this->components_.size();
+  EuclideanVectorBatch out(this->GetOutputDimensions());
+  out.Resize(batch.size());
+  if (batch.empty() || k == 0) {
+    return out;
+  }
+
+  const std::size_t tiles = (batch.size() + kVectorTile - 1) / kVectorTile;
+  auto project_tiles = [&](std::size_t, std::size_t begin, std::size_t end) {
+    std::vector<double> tile(kVectorTile * d);
+    std::vector<const double*> rows(kVectorTile);
+    for (std::size_t t = begin; t < end; ++t) {
+      const std::size_t first = t * kVectorTile;
+      const std::size_t count = std::min(kVectorTile, batch.size() - first);
+      for (std::size_t r = 0; r < count; ++r) {
+        rows[r] = batch.Row(first + r);
+        if (!this->mean_.empty()) {
+          SubtractMagnitudes(rows[r], this->mean_.data(), &tile[r * d], d);
+          rows[r] = &tile[r * d];
+        }
+      }
+      for (std::size_t c = 0; c < k; c += kComponentTile) {
+        const std::size_t c_end = std::min(c + kComponentTile, k);
+        for (std::size_t r = 0; r < count; ++r) {
+          double* y = out.Row(first + r);
+          for (std::size_t o = c; o < c_end; ++o) {
+            y[o] = Dot(rows[r], this->components_.Row(o), d);
+          }
+        }
+      }
+    }
+  };
+  ParallelFor(tiles, NumThreads(num_threads, tiles), project_tiles);
+  return out;
+}
+
+// Layout: "EVLP", version, kind, input and output dimensions as int32s, the sizes of the mean and
+//  the explained variance as uint64s, then W row by row, the mean and the explained variance
+void LinearProjection::Save(std::ostream& os) const {
+  os.write(kMagic, sizeof(kMagic));
+  Write(os, kVersion);
+  Write(os, static_cast<std::int32_t>(this->kind_));
+  Write(os, static_cast<std::int32_t>(this->GetInputDimensions()));
+  Write(os, static_cast<std::int32_t>(this->GetOutputDimensions()));
+  Write(os, static_cast<std::uint64_t>(this->mean_.size()));
+  Write(os, static_cast<std::uint64_t>(this->explained_variance_.size()));
+  const auto d = static_cast<std::size_t>(this->GetInputDimensions());
+  for (std::size_t o = 0; o < this->components_.size(); ++o) {
+    os.write(reinterpret_cast<const char*>(this->components_.Row(o)),
+             static_cast<std::streamsize>(sizeof(double) * d));
+  }
+  os.write(reinterpret_cast<const char*>(this->mean_.data()),
+           static_cast<std::streamsize>(sizeof(double) * this->mean_.size()));
+  os.write(reinterpret_cast<const char*>(this->explained_variance_.data()),
+           static_cast<std::streamsize>(sizeof(double) * this->explained_variance_.size()));
+  if (!os) {
+    throw EuclideanVectorError("LinearProjection could not be written");
+  }
+}
+
+void LinearProjection::Save(const std::string& path) const {
+  std::ofstream os{path, std::ios::binary};
+  if (!os) {
+    throw EuclideanVectorError("Could not open " + path + " for writing");
+  }
+  Save(os);
+}
+
+LinearProjection LinearProjection::Load(std::istream& is) {
+  char magic[sizeof(kMagic)];
+  if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic) ||
+      Read<std::uint32_t>(is) != kVersion) {
+    throw EuclideanVectorError("Stream does not hold a LinearProjection");
+  }
+  auto kind = Read<std::int32_t>(is);
+  auto input_dimensions = Read<std::int32_t>(is);
+  auto output_dimensions = Read<std::int32_t>(is);
+  auto mean_size = Read<std::uint64_t>(is);
+  auto variance_size = Read<std::uint64_t>(is);
+  if (kind < 0 || kind > static_cast<std::int32_t>(ProjectionKind::kPca) ||
+      input_dimensions < 0 || output_dimensions < 0 ||
+      (mean_size != 0 && mean_size != static_cast<std::uint64_t>(input_dimensions)) ||
+      (variance_size != 0 && variance_size != static_cast<std::uint64_t>(output_dimensions))) {
+    throw EuclideanVectorError("Stream does not hold a LinearProjection");
+  }
+
+  const auto d = static_cast<std::size_t>(input_dimensions);
+  EuclideanVectorBatch components(input_dimensions);
+  components.Reserve(std::min(static_cast<std::size_t>(output_dimensions),
+                              kMaxLoadReserve / std::max<std::size_t>(d, 1)));
+  std::vector<double> row;
+  row.reserve(std::min(d, kMaxLoadReserve));
+  for (std::int32_t o = 0; o < output_dimensions; ++o) {
+    row.clear();
+    for (std::size_t i = 0; i < d; ++i) {
+      row.push_back(Read<double>(is));
+    }
+    components.Add(row.data());
+  }
+  auto read_doubles = [&is](std::uint64_t size) {
+    std::vector<double> values;
+    values.reserve(std::min(static_cast<std::size_t>(size), kMaxLoadReserve));
+    for (std::uint64_t i = 0; i < size; ++i) {
+      values.push_back(Read<double>(is));
+    }
+    return values;
+  };
+  std::vector<double> mean = read_doubles(mean_size);
+  std::vector<double> variance = read_doubles(variance_size);
+  return LinearProjection(static_cast<ProjectionKind>(kind), std::move(components),
+                          std::move(mean), std::move(variance));
+}
+
+LinearProjection LinearProjection::Load(const std::string& path) {
+  std::ifstream is{path, std::ios::binary};
+  if (!is) {
+    throw EuclideanVectorError("Could not open " + path + " for reading");
+  }
+  return Load(is);
+}
+
+/* FUNCTIONS */
+LinearProjection MakeGaussianProjection(int input_dimensions, const ProjectionParams& params) {
+  if (input_dimensions < 1 || params.output_dimensions < 1) {
+    throw EuclideanVectorError("Random projections need at least 1 input and output dimension");
+  }
+  const double stddev = 1 / std::sqrt(static_cast<double>(params.output_dimensions));
+  return LinearProjection(ProjectionKind::kGaussian,
+                          RandomGaussianBatch(static_cast<std::size_t>(params.output_dimensions),
+                                              input_dimensions, 0, stddev,
+                                              RandomParams{params.seed, 0, params.num_threads}));
+}
+
+LinearProjection MakeAchlioptasProjection(int input_dimensions, const ProjectionParams& params) {
+  if (input_dimensions < 1 || params.output_dimensions < 1) {
+    throw EuclideanVectorError("Random projections need at least 1 input and output dimension");
+  }
+  EuclideanVectorBatch components =
+      RandomUniformBatch(static_cast<std::size_t>(params.output_dimensions), input_dimensions, 0,
+                         1, RandomParams{params.seed, 0, params.num_threads});
+  const double scale = std::sqrt(3 / static_cast<double>(params.output_dimensions));
+  for (std::size_t o = 0; o < components.size(); ++o) {
+    double* row = components.Row(o);
+    for (int i = 0; i < input_dimensions; ++i) {
+      row[i] = row[i] < 1.0 / 6 ? scale : row[i] < 2.0 / 6 ? -scale : 0;
+    }
+  }
+  return LinearProjection(ProjectionKind::kAchlioptas, std::move(components));
+}
+
+// Subspace iteration on the covariance C: Z = C Q, then a Rayleigh-Ritz step (eigendecompose the
+//  small matrix Q^T Z and rotate Z onto its eigenvectors) before orthonormalising Z into the next
+//  Q, so the columns stay sorted by eigenvalue and the Ritz values converge to C's largest ones
+LinearProjection FitPca(const EuclideanVectorBatch& data, const ProjectionParams& params) {
+  const int dims = data.GetNumDimensions();
+  if (data.size() < 2 || params.output_dimensions < 1 || params.output_dimensions > dims) {
+    throw EuclideanVectorError(
+        "PCA needs at least two vectors and 1 <= output_dimensions <= their dimensions");
+  }
+  const auto d = static_cast<std::size_t>(dims);
+  const auto k = static_cast<std::size_t>(params.output_dimensions);
+  const std::size_t b = std::min(d, k + kOversample);
+
+  std::vector<double> mean(d);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    AddMagnitudes(mean.data(), data.Row(i), mean.data(), d);
+  }
+  ScaleMagnitudes(mean.data(), 1 / static_cast<double>(data.size()), mean.data(), d);
+  const std::vector<double> covariance = Covariance(data, mean, params.num_threads);
+
+  std::vector<double> q(b * d);
+  FillGaussian(q.data(), q.size(), 0, 1, RandomParams{params.seed, 0, 1});
+  Orthonormalize(q, b, d);
+  std::vector<double> z(b * d);
+  std::vector<double> h(b * b);
+  std::vector<double> values, previous, vectors;
+  const int threads = NumThreads(params.num_threads, d, kMinCovarianceRowsPerThread);
+  for (int iteration = 0;; ++iteration) {
+    ParallelFor(d, threads, [&](std::size_t, std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        for (std::size_t j = 0; j < b; ++j) {
+          z[j * d + i] = Dot(&covariance[i * d], &q[j * d], d);
+        }
+      }
+    });
+    for (std::size_t x = 0; x < b; ++x) {
+      for (std::size_t y = x; y < b; ++y) {
+        h[x * b + y] = h[y * b + x] = Dot(&q[x * d], &z[y * d], d);
+      }
+    }
+    SymmetricEigen(h, b, values, vectors);
+
+    bool converged = !previous.empty();
+    for (std::size_t j = 0; j < k && converged; ++j) {
+      converged = std::fabs(values[j] - previous[j]) <= params.tolerance * std::fabs(values[0]);
+    }
+    if (converged || iteration + 1 >= params.max_iterations) {
+      break;
+    }
+    previous = values;
+    q = Rotate(z, vectors, b, d);
+    Orthonormalize(q, b, d);
+  }
+
+  // The Ritz vectors Q V are C's eigenvector estimates, in the order of their eigenvalues
+  std::vector<double> ritz = Rotate(q, vectors, b, d);
+  EuclideanVectorBatch components(dims);
+  for (std::size_t j = 0; j < k; ++j) {
+    components.Add(&ritz[j * d]);
+  }
+  values.resize(k);
+  return LinearProjection(ProjectionKind::kPca, std::move(components), std::move(mean),
+                          std::move(values));
+}
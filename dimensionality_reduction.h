@@ -0,0 +1,92 @@
+#ifndef ASSIGNMENTS_EV_DIMENSIONALITY_REDUCTION_H_
+#define ASSIGNMENTS_EV_DIMENSIONALITY_REDUCTION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// How a LinearProjection was made
+//  kGaussian   - entries drawn from N(0, 1/k), which preserves distances in expectation
+//                (Johnson-Lindenstrauss)
+//  kAchlioptas - entries sqrt(3/k) * (+1 with probability 1/6, 0 with 2/3, -1 with 1/6), which
+//                preserve distances as well as kGaussian (Achlioptas 2003) with two thirds zeros
+//  kPca        - the k principal axes of the training data, after subtracting its mean
+enum class ProjectionKind { kGaussian, kAchlioptas, kPca };
+
+// Settings for the projection factories
+//  output_dimensions - k, the dimensions vectors are reduced to
+//  seed              - seed for the random matrices and for PCA's starting subspace
+//  num_threads       - threads for fitting (<= 0 means one per hardware thread)
+//  max_iterations    - PCA only: subspace iterations before giving up on convergence
+//  tolerance         - PCA only: stop once no kept eigenvalue moves by more than tolerance times
+//                      the largest one in an iteration
+struct ProjectionParams {
+  int output_dimensions = 64;
+  std::uint64_t seed = 1;
+  int num_threads = 0;
+  int max_iterations = 100;
+  double tolerance = 1e-6;
+};
+
+// A linear map from input dimensions down to output dimensions: y = W (x - mean), where W has one
+//  row per output dimension. Transforming a batch is blocked so that a tile of rows of W stays in
+//  cache while a tile of vectors is projected onto it, and tiles of vectors are spread over
+//  threads.
+class LinearProjection {
+ public:
+  /* CONSTRUCTORS */
+  // components holds W row by row; mean is empty (no centring) or has one value per input
+  //  dimension; explained_variance is empty or has one value per output dimension
+  LinearProjection(ProjectionKind kind,
+                   EuclideanVectorBatch components,
+                   std::vector<double> mean = {},
+                   std::vector<double> explained_variance = {});
+
+  /* METHODS */
+  ProjectionKind GetKind() const noexcept { return this->kind_; }
+  int GetInputDimensions() const noexcept { return this->components_.GetNumDimensions(); }
+  int GetOutputDimensions() const noexcept {
+    return static_cast<int>(this->components_.size());
+  }
+  const EuclideanVectorBatch& GetComponents() const noexcept { return this->components_; }
+  const std::vector<double>& GetMean() const noexcept { return this->mean_; }
+  // PCA only: the variance of the training data along each component, largest first
+  const std::vector<double>& GetExplainedVariance() const noexcept {
+    return this->explained_variance_;
+  }
+
+  EuclideanVector Transform(const EuclideanVector& ev) const;
+  EuclideanVectorBatch Transform(const EuclideanVectorBatch& batch, int num_threads = 0) const;
+
+  // Binary (de)serialisation
+  void Save(std::ostream& os) const;
+  void Save(const std::string& path) const;
+  static LinearProjection Load(std::istream& is);
+  static LinearProjection Load(const std::string& path);
+
+ private:
+  // y = W (x - mean) for one vector, using x_buffer for the centred copy
+  void Project(const double* x, double* y, std::vector<double>& x_buffer) const noexcept;
+
+  ProjectionKind kind_;
+  EuclideanVectorBatch components_;
+  std::vector<double> mean_;
+  std::vector<double> explained_variance_;
+};
+
+LinearProjection MakeGaussianProjection(int input_dimensions, const ProjectionParams& params);
+LinearProjection MakeAchlioptasProjection(int input_dimensions, const ProjectionParams& params);
+
+// Principal component analysis of data (at least two vectors). The covariance matrix is
+//  accumulated in parallel over blocks of vectors with the SIMD dot kernels, then its top
+//  eigenvectors are found by subspace iteration with Rayleigh-Ritz steps on a few more vectors
+//  than are kept, which costs O(d^2 k) per iteration instead of the O(d^3) of a full
+//  eigendecomposition.
+LinearProjection FitPca(const EuclideanVectorBatch& data, const ProjectionParams& params);
+
+#endif  // ASSIGNMENTS_EV_DIMENSIONALITY_REDUCTION_H_
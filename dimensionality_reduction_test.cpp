@@ -0,0 +1,228 @@
+/*
+
+  == Explanation and rational of testing ==
+  Random projections are checked for the property they are used for: pairwise distances between
+  random vectors survive the reduction to within the Johnson-Lindenstrauss error for the chosen
+  output dimensions. PCA is checked on data whose principal axes are known (a few coordinates with
+  much larger variance, shifted away from the origin): it must find those axes in order, report
+  the variance along each one, and that variance must equal the variance of the transformed data.
+  Batch transforms must agree exactly with vector transforms whatever the thread count, and every
+  kind of projection must survive a save and load unchanged.
+
+*/
+
+#include "assignments/ev/dimensionality_reduction.h"
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "assignments/ev/vector_kernels.h"
+#include "assignments/ev/vector_random.h"
+#include "catch.h"
+
+namespace {
+
+// Largest and smallest ratio of projected to original distance over every pair in data
+std::pair<double, double> DistortionRange(const LinearProjection& projection,
+                                          const EuclideanVectorBatch& data) {
+  EuclideanVectorBatch reduced = projection.Transform(data);
+  double low = 1e300;
+  double high = 0;
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    for (std::size_t j = i + 1; j < data.size(); ++j) {
+      double ratio = std::sqrt(
+          SquaredDistance(reduced.Row(i), reduced.Row(j), reduced.GetNumDimensions()) /
+          SquaredDistance(data.Row(i), data.Row(j), data.GetNumDimensions()));
+      low = std::min(low, ratio);
+      high = std::max(high, ratio);
+    }
+  }
+  return {low, high};
+}
+
+bool SameBatch(const EuclideanVectorBatch& a, const EuclideanVectorBatch& b) {
+  return a.size() == b.size() && a.GetNumDimensions() == b.GetNumDimensions() &&
+         EqualMagnitudes(a.data(), b.data(), a.size() * static_cast<std::size_t>(
+                                                            a.GetNumDimensions()));
+}
+
+// 4000 vectors of 40 dimensions around 100: coordinates 7, 3 and 20 have standard deviations 10,
+//  5 and 3, the rest 0.5
+EuclideanVectorBatch KnownAxes() {
+  EuclideanVectorBatch data = RandomGaussianBatch(4000, 40, 0, 0.5, RandomParams{3, 0, 1});
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    double* row = data.Row(i);
+    row[7] *= 20;
+    row[3] *= 10;
+    row[20] *= 6;
+    for (int d = 0; d < 40; ++d) {
+      row[d] += 100;
+    }
+  }
+  return data;
+}
+
+}  // namespace
+
+SCENARIO("Random projections") {
+  WHEN("You reduce 60 random 1024 dimensional vectors to 256 dimensions") {
+    EuclideanVectorBatch data = RandomGaussianBatch(60, 1024, 0, 1, RandomParams{11, 0, 1});
+    ProjectionParams params;
+    params.output_dimensions = 256;
+    LinearProjection gaussian = MakeGaussianProjection(1024, params);
+    LinearProjection achlioptas = MakeAchlioptasProjection(1024, params);
+    auto gaussian_range = DistortionRange(gaussian, data);
+    auto achlioptas_range = DistortionRange(achlioptas, data);
+    std::size_t zeros = 0;
+    for (std::size_t o = 0; o < 256; ++o) {
+      zeros += static_cast<std::size_t>(
+          std::count(achlioptas.GetComponents().Row(o), achlioptas.GetComponents().Row(o) + 1024,
+                     0.0));
+    }
+    THEN("Every pairwise distance is kept to within the Johnson-Lindenstrauss error") {
+      REQUIRE(gaussian.GetKind() == ProjectionKind::kGaussian);
+      REQUIRE(gaussian.GetOutputDimensions() == 256);
+      REQUIRE(gaussian.GetInputDimensions() == 1024);
+      REQUIRE(gaussian_range.first > 0.75);
+      REQUIRE(gaussian_range.second < 1.25);
+      REQUIRE(achlioptas_range.first > 0.75);
+      REQUIRE(achlioptas_range.second < 1.25);
+      REQUIRE(static_cast<double>(zeros) / (256 * 1024) == Approx(2.0 / 3).margin(0.01));
+    }
+  }
+  WHEN("You transform a batch on one and on three threads") {
+    EuclideanVectorBatch data = RandomUniformBatch(101, 50, -1, 1, RandomParams{4, 0, 1});
+    ProjectionParams params;
+    params.output_dimensions = 20;
+    LinearProjection gaussian = MakeGaussianProjection(50, params);
+    LinearProjection achlioptas = MakeAchlioptasProjection(50, params);
+    EuclideanVectorBatch one = gaussian.Transform(data, 1);
+    EuclideanVectorBatch three = gaussian.Transform(data, 3);
+    EuclideanVectorBatch sparse = achlioptas.Transform(data, 3);
+    THEN("Every row matches the transform of that vector alone") {
+      REQUIRE(SameBatch(one, three));
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        REQUIRE(gaussian.Transform(data.Get(i)) == one.Get(i));
+        REQUIRE(achlioptas.Transform(data.Get(i)) == sparse.Get(i));
+      }
+      REQUIRE(gaussian.Transform(EuclideanVectorBatch(50)).empty());
+    }
+  }
+}
+
+SCENARIO("Principal component analysis") {
+  WHEN("You fit 3 components to data with three dominant axes") {
+    EuclideanVectorBatch data = KnownAxes();
+    ProjectionParams params;
+    params.output_dimensions = 3;
+    params.num_threads = 3;
+    LinearProjection pca = FitPca(data, params);
+    EuclideanVectorBatch reduced = pca.Transform(data);
+    std::vector<double> variance(3);
+    for (std::size_t i = 0; i < reduced.size(); ++i) {
+      for (std::size_t o = 0; o < 3; ++o) {
+        variance[o] += reduced.Row(i)[o] * reduced.Row(i)[o] / 3999;
+      }
+    }
+    THEN("It finds those axes in order of variance") {
+      const auto& components = pca.GetComponents();
+      REQUIRE(std::fabs(components.Row(0)[7]) == Approx(1).margin(1e-3));
+      REQUIRE(std::fabs(components.Row(1)[3]) == Approx(1).margin(1e-3));
+      REQUIRE(std::fabs(components.Row(2)[20]) == Approx(1).margin(1e-3));
+      REQUIRE(Dot(components.Row(0), components.Row(1), 40) == Approx(0).margin(1e-12));
+      REQUIRE(pca.GetMean()[0] == Approx(100).margin(0.05));
+      const auto& explained = pca.GetExplainedVariance();
+      REQUIRE(explained[0] == Approx(100).epsilon(0.06));
+      REQUIRE(explained[1] == Approx(25).epsilon(0.06));
+      REQUIRE(explained[2] == Approx(9).epsilon(0.06));
+      for (std::size_t o = 0; o < 3; ++o) {
+        REQUIRE(variance[o] == Approx(explained[o]).epsilon(1e-9));
+      }
+    }
+  }
+  WHEN("You keep every dimension of data with fewer directions than dimensions") {
+    EuclideanVectorBatch data(4);
+    for (int i = 0; i < 10; ++i) {
+      std::vector<double> v{static_cast<double>(i), static_cast<double>(2 * i), 1, 1};
+      data.Add(v.data());
+    }
+    ProjectionParams params;
+    params.output_dimensions = 4;
+    LinearProjection pca = FitPca(data, params);
+    THEN("The extra components are orthonormal with no variance") {
+      REQUIRE(pca.GetExplainedVariance()[0] == Approx(5 * 55.0 / 6));
+      REQUIRE(pca.GetExplainedVariance()[1] == Approx(0).margin(1e-9));
+      for (std::size_t o = 0; o < 4; ++o) {
+        REQUIRE(SquaredNorm(pca.GetComponents().Row(o), 4) == Approx(1));
+      }
+    }
+  }
+}
+
+SCENARIO("Saving and loading projections") {
+  WHEN("You save and load each kind of projection") {
+    ProjectionParams params;
+    params.output_dimensions = 5;
+    EuclideanVectorBatch data = RandomUniformBatch(30, 12, 0, 1, RandomParams{8, 0, 1});
+    std::vector<LinearProjection> projections{MakeGaussianProjection(12, params),
+                                              MakeAchlioptasProjection(12, params),
+                                              FitPca(data, params)};
+    std::vector<LinearProjection> loaded;
+    for (const LinearProjection& projection : projections) {
+      std::stringstream stream;
+      projection.Save(stream);
+      loaded.push_back(LinearProjection::Load(stream));
+    }
+    THEN("The loaded projections transform identically") {
+      for (std::size_t p = 0; p < projections.size(); ++p) {
+        REQUIRE(loaded[p].GetKind() == projections[p].GetKind());
+        REQUIRE(loaded[p].GetMean() == projections[p].GetMean());
+        REQUIRE(loaded[p].GetExplainedVariance() == projections[p].GetExplainedVariance());
+        REQUIRE(SameBatch(loaded[p].Transform(data), projections[p].Transform(data)));
+      }
+    }
+  }
+}
+
+// EXCEPTION - Mismatched dimensions, too little data, foreign streams and streams whose header
+//  promises more data than they hold are rejected
+SCENARIO("Invalid projections") {
+  WHEN("You misuse a projection") {
+    ProjectionParams params;
+    params.output_dimensions = 2;
+    LinearProjection projection = MakeGaussianProjection(3, params);
+    EuclideanVectorBatch one(3);
+    one.Add(EuclideanVector(3));
+    std::stringstream garbage{"not a projection"};
+    std::stringstream saved;
+    projection.Save(saved);
+    std::stringstream truncated{saved.str().substr(0, saved.str().size() - 1)};
+    // A header claiming a 2^30 x 2^30 projection, with nothing after it
+    std::string huge_header = saved.str().substr(0, 12);
+    const std::int32_t huge = std::int32_t{1} << 30;
+    const std::uint64_t none = 0;
+    huge_header.append(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    huge_header.append(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    huge_header.append(reinterpret_cast<const char*>(&none), sizeof(none));
+    huge_header.append(reinterpret_cast<const char*>(&none), sizeof(none));
+    std::stringstream huge_stream{huge_header};
+    THEN("EuclideanVectorError is thrown") {
+      REQUIRE_THROWS_WITH(projection.Transform(EuclideanVector(4)),
+                          "Dimensions of projection(3) and vector(4) do not match");
+      REQUIRE_THROWS_WITH(projection.Transform(EuclideanVectorBatch(2)),
+                          "Dimensions of projection(3) and batch(2) do not match");
+      REQUIRE_THROWS_AS(FitPca(one, params), EuclideanVectorError);
+      params.output_dimensions = 0;
+      REQUIRE_THROWS_AS(MakeAchlioptasProjection(3, params), EuclideanVectorError);
+      REQUIRE_THROWS_WITH(LinearProjection::Load(garbage),
+                          "Stream does not hold a LinearProjection");
+      REQUIRE_THROWS_WITH(LinearProjection::Load(truncated),
+                          "LinearProjection stream ended unexpectedly");
+      REQUIRE_THROWS_WITH(LinearProjection::Load(huge_stream),
+                          "LinearProjection stream ended unexpectedly");
+    }
+  }
+}
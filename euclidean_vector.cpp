@@ -2,267 +2,299 @@
 
 #include <algorithm>  // Look at these - they are helpful https://en.cppreference.com/w/cpp/algorithm
 #include <assert.h>
+#include <cstring>
+#include <limits>
+
+#include "assignments/ev/euclidean_vector_profile.h"
+#include "assignments/ev/euclidean_vector_stats.h"
+#include "assignments/ev/euclidean_vector_status.h"
+#include "assignments/ev/parallel_for.h"
+#include "assignments/ev/vector_kernels.h"
+
+// Bytes of magnitudes in a vector of the given size (for the instrumentation counters)
+#define EV_BYTES(size) (sizeof(double) * static_cast<std::uint64_t>(size))
 
 // Helper function declarations
-std::unique_ptr<double[]> CreateMagnitudes(int size, double magnitude) noexcept;
-std::unique_ptr<double[]> CreateMagnitudes(std::vector<double>::const_iterator start_it,
-                                           std::vector<double>::const_iterator end_it) noexcept;
+Magnitudes CreateMagnitudes(std::size_t size, double magnitude) noexcept;
+Magnitudes CreateMagnitudes(std::vector<double>::const_iterator start_it,
+                            std::vector<double>::const_iterator end_it) noexcept;
 
 /* CONSTRUCTORS */
 // Takes number of dimensions (size) and sets magnitude in each dimension as 0.0
-EuclideanVector::EuclideanVector(int size, double magnitude) noexcept
-  : magnitudes_{CreateMagnitudes(size, magnitude)}, size_{size} {}
+EuclideanVector::EuclideanVector(std::size_t size, double magnitude) noexcept
+  : magnitudes_{CreateMagnitudes(size, magnitude)}, size_{size}, capacity_{size} {
+  EV_RECORD_EVENT(kFillConstruct, 1);
+}
 
 // Takes start and end of an std::vector iterator and sets magnitudes to the iterated values
 EuclideanVector::EuclideanVector(std::vector<double>::const_iterator start_it,
                                  std::vector<double>::const_iterator end_it) noexcept
-  : magnitudes_{CreateMagnitudes(start_it, end_it)}, size_{static_cast<int>(
-                                                         std::distance(start_it, end_it))} {}
+  : magnitudes_{CreateMagnitudes(start_it, end_it)},
+    size_{static_cast<std::size_t>(std::distance(start_it, end_it))}, capacity_{size_} {
+  EV_RECORD_EVENT(kRangeConstruct, 1);
+}
 
 // Copies vector to new vector
-EuclideanVector::EuclideanVector(const EuclideanVector& ev) noexcept : size_{ev.size_} {
-  magnitudes_ = std::make_unique<double[]>(this->size_);
-  for (int i = 0; i < this->size_; ++i) {
+EuclideanVector::EuclideanVector(const EuclideanVector& ev) noexcept
+  : size_{ev.size_}, capacity_{ev.size_} {
+  EV_RECORD_EVENT(kCopyConstruct, 1);
+  EV_RECORD_EVENT(kAllocation, 1);
+  EV_RECORD_EVENT(kBytesAllocated, EV_BYTES(this->size_));
+  magnitudes_ = AcquireMagnitudes(this->size_);
+  for (std::size_t i = 0; i < this->size_; ++i) {
     this->magnitudes_[i] = ev.magnitudes_[i];
   }
 }
 
 // Moves vector o to current vector
 EuclideanVector::EuclideanVector(EuclideanVector&& o) noexcept
-  : magnitudes_{std::move(o.magnitudes_)}, size_{o.size_} {
+  : magnitudes_{std::move(o.magnitudes_)}, size_{o.size_}, capacity_{o.capacity_} {
+  EV_RECORD_EVENT(kMoveConstruct, 1);
   o.size_ = 0;
+  o.capacity_ = 0;
 }
 
 /* DESTRUCTORS */
 // Frees vector
-//  Only on-primitives are freed here since primitive objects can be freed by compiler
-EuclideanVector::~EuclideanVector() noexcept {
-  this->magnitudes_.release();
-}
+//  magnitudes_ owns the buffer, so letting it go out of scope hands the buffer back to the vector
+//  pool (calling release() here would hand ownership to nobody and leak it)
+EuclideanVector::~EuclideanVector() noexcept = default;
 
 /* METHODS */
-// at (getter) - returns value of magnitude in dimension given as function parameter
-double EuclideanVector::at(int i) const {
-  if (i < 0 || i >= this->size_) {
-    throw EuclideanVectorError("Index " + std::to_string(i) +
-                               " is not valid for this EuclideanVector object");
+// Grows the buffer to hold at least capacity dimensions, keeping the current magnitudes
+void EuclideanVector::Reserve(std::size_t capacity) {
+  if (capacity <= this->capacity_) {
+    return;
   }
+  Magnitudes magnitudes = CreateMagnitudes(capacity, 0.0);
+  std::copy(this->magnitudes_.get(), this->magnitudes_.get() + this->size_, magnitudes.get());
+  this->magnitudes_ = std::move(magnitudes);
+  this->capacity_ = capacity;
+}
+
+// at (getter) - returns value of magnitude in dimension given as function parameter
+double EuclideanVector::at(std::size_t i) const {
+  EV_RECORD_OPERATION(kAt, sizeof(double));
+  CheckIndex(*this, i).ThrowIfError();
   return this->magnitudes_[i];
 }
 
 // at (setter) - returns reference of magnitude in dimension given as function parameter
-double& EuclideanVector::at(int i) {
-  if (i < 0 || i >= this->size_) {
-    throw EuclideanVectorError("Index " + std::to_string(i) +
-                               " is not valid for this EuclideanVector object");
-  }
+double& EuclideanVector::at(std::size_t i) {
+  EV_RECORD_OPERATION(kAt, sizeof(double));
+  CheckIndex(*this, i).ThrowIfError();
   return this->magnitudes_[i];
 }
 
 // Gets the euclidean norm of the vector as a double
-double EuclideanVector::GetEuclideanNorm() const {
+//  Every mode makes a single pass over the magnitudes
+double EuclideanVector::GetEuclideanNorm(NormMode mode) const {
+  EV_RECORD_OPERATION(kNorm, EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kNorm, this->size_);
   if (this->GetNumDimensions() == 0) {
-    throw("EuclideanVector with no dimensions does not have a norm");
+    throw EuclideanVectorError("EuclideanVector with no dimensions does not have a norm");
   }
 
-  double euclidNorm = 0;
-  for (int i = 0; i < this->size_; ++i) {
-    euclidNorm += std::pow(this->magnitudes_[i], 2);
+  switch (mode) {
+    case NormMode::kScaled:
+      return ScaledNorm(this->magnitudes_.get(), this->size_);
+    case NormMode::kCompensated:
+      return std::sqrt(CompensatedSquaredNorm(this->magnitudes_.get(), this->size_));
+    case NormMode::kFast:
+    default:
+      return std::sqrt(SquaredNorm(this->magnitudes_.get(), this->size_));
   }
-  euclidNorm = std::sqrt(euclidNorm);
-  return euclidNorm;
+}
+
+// Gets the L1 (taxicab) norm of the vector
+double EuclideanVector::GetL1Norm() const {
+  return GetLpNorm(1);
+}
+
+// Gets the L-infinity (maximum) norm of the vector
+double EuclideanVector::GetInfinityNorm() const {
+  return GetLpNorm(std::numeric_limits<double>::infinity());
+}
+
+// Gets the Lp norm of the vector for any p >= 1 (including infinity)
+double EuclideanVector::GetLpNorm(double p) const {
+  EV_RECORD_OPERATION(kNorm, EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kNorm, this->size_);
+  if (this->GetNumDimensions() == 0) {
+    throw EuclideanVectorError("EuclideanVector with no dimensions does not have a norm");
+  }
+  if (!(p >= 1)) {
+    throw EuclideanVectorError("Lp norm is only defined for p >= 1");
+  }
+  return LpNorm(this->magnitudes_.get(), this->size_, p);
 }
 
 // Returns a Euclidean vector that is the unit vector of *this vector
 EuclideanVector EuclideanVector::CreateUnitVector() const {
+  EV_RECORD_OPERATION(kUnitVector, 2 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kUnitVector, this->size_);
   if (this->GetNumDimensions() == 0) {
-    throw("EuclideanVector with no dimensions does not have a unit vector");
+    throw EuclideanVectorError("EuclideanVector with no dimensions does not have a unit vector");
   }
-  if (this->GetEuclideanNorm() == 0) {
-    throw("EuclideanVector with euclidean normal of 0 does not have a unit vector");
+  double norm = this->GetEuclideanNorm();
+  if (norm == 0) {
+    throw EuclideanVectorError(
+        "EuclideanVector with euclidean normal of 0 does not have a unit vector");
   }
 
   EuclideanVector ev(this->size_);
-  for (int i = 0; i < this->size_; ++i) {
-    ev.magnitudes_[i] = this->magnitudes_[i] / GetEuclideanNorm();
+  for (std::size_t i = 0; i < this->size_; ++i) {
+    ev.magnitudes_[i] = this->magnitudes_[i] / norm;
   }
   return ev;
 }
 
 /* OPERATIONS */
 // Copy assigns ev to *this
+//  Only allocates when ev has more dimensions than *this has capacity for
 EuclideanVector& EuclideanVector::operator=(const EuclideanVector& ev) noexcept {
-  *this = EuclideanVector(ev);
+  EV_RECORD_EVENT(kCopyAssign, 1);
+  if (this != &ev) {
+    this->Resize(ev.size_);
+    std::copy(ev.magnitudes_.get(), ev.magnitudes_.get() + ev.size_, this->magnitudes_.get());
+  }
   return *this;
 }
 
 // Move assigns ev to *this
 EuclideanVector& EuclideanVector::operator=(EuclideanVector&& ev) noexcept {
-  this->magnitudes_ = std::move(ev.magnitudes_);
-  this->size_ = ev.size_;
-  ev.size_ = 0;
+  EV_RECORD_EVENT(kMoveAssign, 1);
+  if (this != &ev) {
+    this->magnitudes_ = std::move(ev.magnitudes_);  // frees the buffer *this held
+    this->size_ = ev.size_;
+    this->capacity_ = ev.capacity_;
+    ev.size_ = 0;
+    ev.capacity_ = 0;
+  }
   return *this;
 }
 
 // [Subscript getter] Gets the value in a given dimension of vector
-double EuclideanVector::operator[](int i) const noexcept {
-  assert(i >= 0 || i < this->size_);
-  return at(i);
+double EuclideanVector::operator[](std::size_t i) const noexcept {
+  EV_RECORD_OPERATION(kSubscript, sizeof(double));
+  assert(i < this->size_);
+  return this->magnitudes_[i];
 }
 
 // [Subscript setter] Gets reference to value in a given dimension of vector
-double& EuclideanVector::operator[](int i) noexcept {
-  assert(i >= 0 || i < this->size_);
-  return at(i);
+double& EuclideanVector::operator[](std::size_t i) noexcept {
+  EV_RECORD_OPERATION(kSubscript, sizeof(double));
+  assert(i < this->size_);
+  return this->magnitudes_[i];
 }
 
 // Adds vector's magnitude values by ev's corresponding magnitude values
 EuclideanVector& EuclideanVector::operator+=(const EuclideanVector& ev) {
-  if (this->GetNumDimensions() != ev.GetNumDimensions()) {
-    std::string l_dims = std::to_string(this->GetNumDimensions());
-    std::string r_dims = std::to_string(ev.GetNumDimensions());
-    throw("Dimensions of LHS(" + l_dims + ") and RHS(" + r_dims + ") do not match");
-  }
+  EV_RECORD_OPERATION(kAddAssign, 3 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kAddAssign, this->size_);
+  CheckDimensions(*this, ev).ThrowIfError();
 
-  for (int i = 0; i < this->size_; ++i) {
-    this->magnitudes_[i] += ev.magnitudes_[i];
-  }
+  AddMagnitudes(this->magnitudes_.get(), ev.magnitudes_.get(), this->magnitudes_.get(),
+                this->size_);
   return *this;
 }
 
 // Subtracts vector's magnitude values by ev's corresponding magnitude values
 EuclideanVector& EuclideanVector::operator-=(const EuclideanVector& ev) {
-  if (this->GetNumDimensions() != ev.GetNumDimensions()) {
-    std::string l_dims = std::to_string(this->GetNumDimensions());
-    std::string r_dims = std::to_string(ev.GetNumDimensions());
-    throw("Dimensions of LHS(" + l_dims + ") and RHS(" + r_dims + ") do not match");
-  }
+  EV_RECORD_OPERATION(kSubtractAssign, 3 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kSubtractAssign, this->size_);
+  CheckDimensions(*this, ev).ThrowIfError();
 
-  for (int i = 0; i < this->size_; ++i) {
-    this->magnitudes_[i] -= ev.magnitudes_[i];
-  }
+  SubtractMagnitudes(this->magnitudes_.get(), ev.magnitudes_.get(), this->magnitudes_.get(),
+                     this->size_);
   return *this;
 }
 
 // Multiplies vector's magnitude values by n
 EuclideanVector& EuclideanVector::operator*=(const double n) noexcept {
-  for (int i = 0; i < this->size_; ++i) {
-    this->magnitudes_[i] *= n;
-  }
+  EV_RECORD_OPERATION(kMultiplyAssign, 2 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kMultiplyAssign, this->size_);
+  ScaleMagnitudes(this->magnitudes_.get(), n, this->magnitudes_.get(), this->size_);
   return *this;
 }
 
 // Divides vector's magnitude values by n
 EuclideanVector& EuclideanVector::operator/=(const double n) {
-  if (n == 0) {
-    throw("Invalid vector division by 0");
-  }
-
-  for (int i = 0; i < this->size_; ++i) {
-    this->magnitudes_[i] /= n;
-  }
+  EV_RECORD_OPERATION(kDivideAssign, 2 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kDivideAssign, this->size_);
+  TryDivide(*this, n).ThrowIfError();
   return *this;
 }
 
 // Operator for type casting vector to a std::vector object
 EuclideanVector::operator std::vector<double>() const noexcept {
-  std::vector<double> vec;
-  vec.reserve(this->size_);
-
-  for (int i = 0; i < this->size_; ++i) {
-    vec.emplace_back(at(i));
-  }
-  return vec;
+  EV_RECORD_OPERATION(kToVector, 2 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kToVector, this->size_);
+  const double* magnitudes = this->magnitudes_.get();
+  return std::vector<double>(magnitudes, magnitudes + this->size_);
 }
 
 // Operator for type casting vector to a std::list object
 EuclideanVector::operator std::list<double>() const noexcept {
-  std::list<double> lt;
-
-  for (int i = 0; i < this->size_; ++i) {
-    lt.emplace_back(at(i));
-  }
-  return lt;
+  EV_RECORD_OPERATION(kToList, 2 * EV_BYTES(this->size_));
+  EV_PROFILE_OPERATION(kToList, this->size_);
+  const double* magnitudes = this->magnitudes_.get();
+  return std::list<double>(magnitudes, magnitudes + this->size_);
 }
 
 /* FRIENDS */
 // Returns true if the two vectors are equal in num. of dims. and magnitude values
 bool operator==(const EuclideanVector& o1, const EuclideanVector& o2) noexcept {
-  if (o1.GetNumDimensions() != o2.GetNumDimensions())
-    return false;
-
-  for (int i = 0; i < o1.GetNumDimensions(); ++i) {
-    if (o1.at(i) != o2.at(i))
-      return false;
-  }
-  return true;
+  EV_RECORD_OPERATION(kEqual, 2 * EV_BYTES(o1.size_));
+  return o1.size_ == o2.size_ &&
+         EqualMagnitudes(o1.magnitudes_.get(), o2.magnitudes_.get(), o1.size_);
 }
 
 // Returns true if the two vectors are not equal in num. of dims. or magnitude values
 bool operator!=(const EuclideanVector& o1, const EuclideanVector& o2) noexcept {
-  if (o1.GetNumDimensions() != o2.GetNumDimensions())
-    return true;
-
-  for (int i = 0; i < o1.GetNumDimensions(); ++i) {
-    if (o1.at(i) != o2.at(i))
-      return true;
-  }
-  return false;
+  EV_RECORD_OPERATION(kNotEqual, 2 * EV_BYTES(o1.size_));
+  return !(o1.size_ == o2.size_ &&
+           EqualMagnitudes(o1.magnitudes_.get(), o2.magnitudes_.get(), o1.size_));
 }
 
 // Returns result of addition of vectors o1 and o2
 EuclideanVector operator+(const EuclideanVector& o1, const EuclideanVector& o2) {
-  if (o1.GetNumDimensions() != o2.GetNumDimensions()) {
-    std::string l_dims = std::to_string(o1.GetNumDimensions());
-    std::string r_dims = std::to_string(o2.GetNumDimensions());
-    throw("Dimensions of LHS(" + l_dims + ") and RHS(" + r_dims + ") do not match");
-  }
+  EV_RECORD_OPERATION(kAdd, 3 * EV_BYTES(o1.size_));
+  EV_PROFILE_OPERATION(kAdd, o1.size_);
+  CheckDimensions(o1, o2).ThrowIfError();
 
   EuclideanVector ev(o1.GetNumDimensions());
-  for (int i = 0; i < ev.size_; ++i) {
-    ev.at(i) = o1.at(i) + o2.at(i);
-  }
+  AddMagnitudes(o1.magnitudes_.get(), o2.magnitudes_.get(), ev.magnitudes_.get(), ev.size_);
   return ev;
 }
 
 // Returns result of subtraction of vectors o1 and o2
 EuclideanVector operator-(const EuclideanVector& o1, const EuclideanVector& o2) {
-  if (o1.GetNumDimensions() != o2.GetNumDimensions()) {
-    std::string l_dims = std::to_string(o1.GetNumDimensions());
-    std::string r_dims = std::to_string(o2.GetNumDimensions());
-    throw("Dimensions of LHS(" + l_dims + ") and RHS(" + r_dims + ") do not match");
-  }
+  EV_RECORD_OPERATION(kSubtract, 3 * EV_BYTES(o1.size_));
+  EV_PROFILE_OPERATION(kSubtract, o1.size_);
+  CheckDimensions(o1, o2).ThrowIfError();
 
   EuclideanVector ev(o1.GetNumDimensions());
-  for (int i = 0; i < ev.size_; ++i) {
-    ev.at(i) = o1.at(i) - o2.at(i);
-  }
+  SubtractMagnitudes(o1.magnitudes_.get(), o2.magnitudes_.get(), ev.magnitudes_.get(), ev.size_);
   return ev;
 }
 
 // Returns result of dot-product multiplication of vectors o1 and o2
 double operator*(const EuclideanVector& o1, const EuclideanVector& o2) {
-  if (o1.GetNumDimensions() != o2.GetNumDimensions()) {
-    std::string l_dims = std::to_string(o1.GetNumDimensions());
-    std::string r_dims = std::to_string(o2.GetNumDimensions());
-    throw("Dimensions of LHS(" + l_dims + ") and RHS(" + r_dims + ") do not match");
-  }
+  EV_RECORD_OPERATION(kDot, 2 * EV_BYTES(o1.size_));
+  EV_PROFILE_OPERATION(kDot, o1.size_);
+  CheckDimensions(o1, o2).ThrowIfError();
 
-  double res = 0;
-  for (int i = 0; i < o1.GetNumDimensions(); ++i) {
-    res += o1.at(i) * o2.at(i);
-  }
-  return res;
+  return Dot(o1.magnitudes_.get(), o2.magnitudes_.get(), o1.size_);
 }
 
 // Multiplies vector's magnitude values by n
 //  Format: EuclideanVector * double
 EuclideanVector operator*(const EuclideanVector& o, double n) noexcept {
+  EV_RECORD_OPERATION(kScale, 2 * EV_BYTES(o.size_));
+  EV_PROFILE_OPERATION(kScale, o.size_);
   EuclideanVector ev(o.GetNumDimensions());
-
-  for (int i = 0; i < ev.size_; ++i) {
-    ev.at(i) = n * o.at(i);
-  }
+  ScaleMagnitudes(o.magnitudes_.get(), n, ev.magnitudes_.get(), ev.size_);
   return ev;
 }
 
@@ -274,23 +306,26 @@ EuclideanVector operator*(double n, const EuclideanVector& o) noexcept {
 
 // Divides vector's magnitude values by double 'n'
 EuclideanVector operator/(const EuclideanVector& o, double n) {
+  EV_RECORD_OPERATION(kDivide, 2 * EV_BYTES(o.size_));
+  EV_PROFILE_OPERATION(kDivide, o.size_);
   if (n == 0) {
-    throw("Invalid vector division by 0");
+    Status(ErrorCode::kDivisionByZero).ThrowIfError();
   }
 
   EuclideanVector ev(o.GetNumDimensions());
-  for (int i = 0; i < ev.size_; ++i) {
-    ev.at(i) = o.at(i) / n;
+  for (std::size_t i = 0; i < ev.size_; ++i) {
+    ev.magnitudes_[i] = o.magnitudes_[i] / n;
   }
   return ev;
 }
 
 // Outputs EuclideanVector in string format in output stream os
 std::ostream& operator<<(std::ostream& os, const EuclideanVector& ev) noexcept {
-  int size = ev.GetNumDimensions();
+  EV_RECORD_OPERATION(kOutput, EV_BYTES(ev.size_));
+  std::size_t size = ev.GetNumDimensions();
   os << "[";
-  for (int i = 0; i < size; ++i) {
-    if (i == size - 1)
+  for (std::size_t i = 0; i < size; ++i) {
+    if (i + 1 == size)
       os << ev.magnitudes_[i];
     else
       os << ev.magnitudes_[i] << " ";
@@ -299,20 +334,98 @@ std::ostream& operator<<(std::ostream& os, const EuclideanVector& ev) noexcept {
   return os;
 }
 
+/* FUNCTIONS */
+// Returns true if o1 and o2 are equal within the given absolute, relative or ULP tolerance
+bool ApproxEqual(const EuclideanVector& o1,
+                 const EuclideanVector& o2,
+                 double abs_tol,
+                 double rel_tol,
+                 int ulps) noexcept {
+  if (o1.GetNumDimensions() != o2.GetNumDimensions()) {
+    return false;
+  }
+
+  // Maps a double's bits onto integers that increase with the value, so that the difference of
+  //  two mapped values is the number of doubles between them
+  auto ordered = [](double x) {
+    std::int64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+  };
+
+  const double* a = o1.data();
+  const double* b = o2.data();
+  for (std::size_t i = 0; i < o1.GetNumDimensions(); ++i) {
+    if (a[i] == b[i]) {
+      continue;
+    }
+    // Infinities are only equal to themselves: otherwise diff is infinite and passes the relative
+    //  test as inf <= inf, and the largest double is one ULP from infinity
+    if (!std::isfinite(a[i]) || !std::isfinite(b[i])) {
+      return false;
+    }
+    double diff = std::fabs(a[i] - b[i]);
+    if (diff <= abs_tol || diff <= rel_tol * std::max(std::fabs(a[i]), std::fabs(b[i]))) {
+      continue;
+    }
+    std::int64_t ia = ordered(a[i]);
+    std::int64_t ib = ordered(b[i]);
+    auto gap = ia > ib ? static_cast<std::uint64_t>(ia) - static_cast<std::uint64_t>(ib)
+                       : static_cast<std::uint64_t>(ib) - static_cast<std::uint64_t>(ia);
+    if (ulps < 0 || gap > static_cast<std::uint64_t>(ulps)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::uint64_t Hash(const EuclideanVector& ev) noexcept {
+  return HashMagnitudes(ev.data(), ev.GetNumDimensions());
+}
+
 /* HELPER FUNCTIONS */
-std::unique_ptr<double[]> CreateMagnitudes(int size, double magnitude) noexcept {
-  std::unique_ptr<double[]> magnitudes = std::make_unique<double[]>(size);
-  for (int i = 0; i < size; ++i) {
-    magnitudes[i] = magnitude;
+// Old magnitudes are not kept when a new buffer is needed since every caller overwrites them
+void EuclideanVector::Resize(std::size_t size) {
+  if (size > this->capacity_) {
+    EV_RECORD_EVENT(kAllocation, 1);
+    EV_RECORD_EVENT(kBytesAllocated, EV_BYTES(size));
+    this->magnitudes_ = AcquireMagnitudes(size);
+    this->capacity_ = size;
+  }
+  this->size_ = size;
+}
+
+// Buffers spanning at least two huge pages get a parallel first-touch fill: one thread per chunk
+//  of at least a huge page, so that faulting in a large buffer is not left to one core. Smaller
+//  buffers are filled on this thread, as is a large one if the fill cannot be set up.
+Magnitudes CreateMagnitudes(std::size_t size, double magnitude) noexcept {
+  EV_RECORD_EVENT(kAllocation, 1);
+  EV_RECORD_EVENT(kBytesAllocated, EV_BYTES(size));
+  Magnitudes magnitudes = AcquireMagnitudes(size);
+  double* data = magnitudes.get();
+  constexpr std::size_t kPageSize = kHugePageBytes / sizeof(double);
+  if (size >= 2 * kPageSize) {
+    try {
+      ParallelFor(size, NumThreads(0, size, kPageSize),
+                  [data, magnitude](std::size_t, std::size_t begin, std::size_t end) {
+                    std::fill(data + begin, data + end, magnitude);
+                  });
+      return magnitudes;
+    } catch (...) {
+      // Only the bookkeeping allocations can throw, before any chunk is filled
+    }
   }
+  std::fill(data, data + size, magnitude);
   return magnitudes;
 }
 
-std::unique_ptr<double[]> CreateMagnitudes(std::vector<double>::const_iterator start_it,
-                                           std::vector<double>::const_iterator end_it) noexcept {
-  int size = static_cast<int>(std::distance(start_it, end_it));
-  std::unique_ptr<double[]> magnitudes = std::make_unique<double[]>(size);
-  int i = 0;
+Magnitudes CreateMagnitudes(std::vector<double>::const_iterator start_it,
+                            std::vector<double>::const_iterator end_it) noexcept {
+  auto size = static_cast<std::size_t>(std::distance(start_it, end_it));
+  EV_RECORD_EVENT(kAllocation, 1);
+  EV_RECORD_EVENT(kBytesAllocated, EV_BYTES(size));
+  Magnitudes magnitudes = AcquireMagnitudes(size);
+  std::size_t i = 0;
   for (auto it = start_it; it != end_it; ++it) {
     magnitudes[i] = *it;
     ++i;
@@ -1,9 +1,13 @@
 #ifndef ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_H_
 #define ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <list>
@@ -13,6 +17,8 @@
 #include <utility>
 #include <vector>
 
+#include "assignments/ev/vector_pool.h"
+
 class EuclideanVectorError : public std::exception {
  public:
   explicit EuclideanVectorError(const std::string& what) : what_(what) {}
@@ -22,24 +28,41 @@ class EuclideanVectorError : public std::exception {
   std::string what_;
 };
 
+// How GetEuclideanNorm sums the squared magnitudes
+//  kFast        - plain sum of squares; fastest, but overflows for magnitudes beyond ~1e154 and
+//                 underflows below ~1e-154
+//  kScaled      - LAPACK dnrm2 style running rescaling; safe for any finite magnitudes
+//  kCompensated - compensated summation with exact products; about twice double precision
+enum class NormMode { kFast, kScaled, kCompensated };
+
 class EuclideanVector {
  public:
   /* CONSTRUCTORS */
-  explicit EuclideanVector(int size = 1) noexcept
+  explicit EuclideanVector(std::size_t size = 1) noexcept
     : EuclideanVector(size, 0.0) {}  // default constructor
   ~EuclideanVector() noexcept;       // destructor
 
-  EuclideanVector(int size, double magnitude) noexcept;
+  EuclideanVector(std::size_t size, double magnitude) noexcept;
   EuclideanVector(std::vector<double>::const_iterator start_it,
                   std::vector<double>::const_iterator end_it) noexcept;
   EuclideanVector(const EuclideanVector& ev) noexcept;  // copy constructor
   EuclideanVector(EuclideanVector&& ev) noexcept;       // move constructor
 
   /* METHODS */
-  int GetNumDimensions() const noexcept { return this->size_; }
-  double at(int i) const;  // getter at index i
-  double& at(int i);       // setter at index i
-  double GetEuclideanNorm() const;
+  std::size_t GetNumDimensions() const noexcept { return this->size_; }
+  const double* data() const noexcept { return this->magnitudes_.get(); }  // raw magnitudes
+  double* data() noexcept { return this->magnitudes_.get(); }
+  // Dimensions held without reallocating
+  std::size_t GetCapacity() const noexcept { return this->capacity_; }
+  void Reserve(std::size_t capacity);
+  template <typename ForwardIt>
+  void Assign(ForwardIt start_it, ForwardIt end_it);  // replaces magnitudes with [start, end)
+  double at(std::size_t i) const;  // getter at index i
+  double& at(std::size_t i);       // setter at index i
+  double GetEuclideanNorm(NormMode mode = NormMode::kFast) const;
+  double GetL1Norm() const;        // sum of absolute magnitudes
+  double GetInfinityNorm() const;  // largest absolute magnitude
+  double GetLpNorm(double p) const;
   EuclideanVector CreateUnitVector() const;
 
   /* OPERATIONS */
@@ -47,8 +70,8 @@ class EuclideanVector {
   EuclideanVector& operator=(EuclideanVector&& ev) noexcept;       // move assignment
 
   // Subscript assignment
-  double operator[](int i) const noexcept;
-  double& operator[](int i) noexcept;
+  double operator[](std::size_t i) const noexcept;
+  double& operator[](std::size_t i) noexcept;
 
   // Mathematical operators on vectors
   EuclideanVector& operator+=(const EuclideanVector& ev);
@@ -80,8 +103,41 @@ class EuclideanVector {
   friend std::ostream& operator<<(std::ostream& os, const EuclideanVector& v) noexcept;
 
  private:
-  std::unique_ptr<double[]> magnitudes_;
-  int size_;  // size of magnitudes_ and dimension of vector
+  // Sets size_, reallocating (without keeping values) if over capacity
+  void Resize(std::size_t size);
+
+  Magnitudes magnitudes_;  // drawn from and returned to the vector pool
+  std::size_t size_;      // dimension of vector
+  std::size_t capacity_;  // size of magnitudes_ (>= size_)
+};
+
+// Returns true if the vectors have the same dimensions and every pair of magnitudes x, y satisfies
+//  at least one of |x - y| <= abs_tol, |x - y| <= rel_tol * max(|x|, |y|) or being at most ulps
+//  representable doubles apart. NaN magnitudes are never approximately equal, and infinite ones
+//  only to the same infinity.
+bool ApproxEqual(const EuclideanVector& o1,
+                 const EuclideanVector& o2,
+                 double abs_tol = 0.0,
+                 double rel_tol = 1e-12,
+                 int ulps = 4) noexcept;
+
+// 64-bit hash of a vector's dimensions and magnitudes, consistent with operator==
+std::uint64_t Hash(const EuclideanVector& ev) noexcept;
+
+namespace std {
+template <>
+struct hash<EuclideanVector> {
+  std::size_t operator()(const EuclideanVector& ev) const noexcept {
+    return static_cast<std::size_t>(Hash(ev));
+  }
 };
+}  // namespace std
+
+// Reuses the existing buffer when it is large enough
+template <typename ForwardIt>
+void EuclideanVector::Assign(ForwardIt start_it, ForwardIt end_it) {
+  this->Resize(static_cast<std::size_t>(std::distance(start_it, end_it)));
+  std::copy(start_it, end_it, this->magnitudes_.get());
+}
 
 #endif  // ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_H_
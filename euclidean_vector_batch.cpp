@@ -0,0 +1,112 @@
+#include "assignments/ev/euclidean_vector_batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+// Dimensions shared by evs, as the int a batch keeps them in
+int BatchDimensions(const std::vector<EuclideanVector>& evs) {
+  if (evs.empty()) {
+    return 0;
+  }
+  const std::size_t dims = evs.front().GetNumDimensions();
+  if (dims > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+    throw EuclideanVectorError("Dimensions of vector(" + std::to_string(dims) +
+                               ") are more than a batch can hold");
+  }
+  return static_cast<int>(dims);
+}
+
+}  // namespace
+
+/* CONSTRUCTORS */
+// Creates an empty batch holding vectors with num_dimensions dimensions
+EuclideanVectorBatch::EuclideanVectorBatch(int num_dimensions)
+  : num_vectors_{0}, num_dimensions_{num_dimensions} {
+  if (num_dimensions < 0) {
+    throw EuclideanVectorError("EuclideanVectorBatch needs num_dimensions >= 0");
+  }
+}
+
+// Creates a batch from a list of vectors that all share the first vector's dimension
+EuclideanVectorBatch::EuclideanVectorBatch(const std::vector<EuclideanVector>& evs)
+  : EuclideanVectorBatch(BatchDimensions(evs)) {
+  Reserve(evs.size());
+  for (const auto& ev : evs) {
+    Add(ev);
+  }
+}
+
+/* METHODS */
+void EuclideanVectorBatch::Reserve(std::size_t num_vectors) {
+  this->magnitudes_.reserve(num_vectors * stride());
+}
+
+void EuclideanVectorBatch::Resize(std::size_t num_vectors) {
+  this->magnitudes_.resize(num_vectors * stride());
+  this->num_vectors_ = num_vectors;
+}
+
+void EuclideanVectorBatch::Clear() noexcept {
+  this->magnitudes_.clear();
+  this->num_vectors_ = 0;
+}
+
+// Appends ev to the end of the batch
+std::size_t EuclideanVectorBatch::Add(const EuclideanVector& ev) {
+  if (ev.GetNumDimensions() != static_cast<std::size_t>(this->num_dimensions_)) {
+    throw EuclideanVectorError("Dimensions of batch(" + std::to_string(this->num_dimensions_) +
+                               ") and vector(" + std::to_string(ev.GetNumDimensions()) +
+                               ") do not match");
+  }
+  return Add(ev.data());
+}
+
+// Appends GetNumDimensions() values starting at magnitudes to the end of the batch
+std::size_t EuclideanVectorBatch::Add(const double* magnitudes) {
+  this->magnitudes_.insert(this->magnitudes_.end(), magnitudes, magnitudes + stride());
+  return this->num_vectors_++;
+}
+
+EuclideanVector EuclideanVectorBatch::Get(std::size_t i) const {
+  auto begin = this->magnitudes_.cbegin() + static_cast<std::ptrdiff_t>(i * stride());
+  return EuclideanVector(begin, begin + this->num_dimensions_);
+}
+
+/* FUNCTIONS */
+// Scans every vector in the batch and keeps the k closest to query
+std::vector<Neighbour> FindNearest(const EuclideanVectorBatch& batch,
+                                   const EuclideanVector& query,
+                                   std::size_t k) {
+  if (query.GetNumDimensions() != static_cast<std::size_t>(batch.GetNumDimensions())) {
+    throw EuclideanVectorError("Dimensions of batch(" + std::to_string(batch.GetNumDimensions()) +
+                               ") and query(" + std::to_string(query.GetNumDimensions()) +
+                               ") do not match");
+  }
+
+  auto closer = [](const Neighbour& a, const Neighbour& b) { return a.distance < b.distance; };
+  std::vector<Neighbour> best;
+  best.reserve(std::min(k, batch.size()) + 1);
+  for (std::size_t i = 0; i < batch.size() && k > 0; ++i) {
+    double d = SquaredDistance(batch.Row(i), query.data(), batch.GetNumDimensions());
+    if (best.size() < k) {
+      best.push_back({i, d});
+      std::push_heap(best.begin(), best.end(), closer);
+    } else if (d < best.front().distance) {
+      std::pop_heap(best.begin(), best.end(), closer);
+      best.back() = {i, d};
+      std::push_heap(best.begin(), best.end(), closer);
+    }
+  }
+
+  std::sort_heap(best.begin(), best.end(), closer);
+  for (auto& n : best) {
+    n.distance = std::sqrt(n.distance);
+  }
+  return best;
+}
@@ -0,0 +1,58 @@
+#ifndef ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_BATCH_H_
+#define ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_BATCH_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+
+// A search result: position of a vector in a batch/index and its euclidean distance to the query
+struct Neighbour {
+  std::size_t id;
+  double distance;
+};
+
+// Many EuclideanVectors of the same dimension stored row after row in a single buffer, so that
+// kernels can walk them without chasing one heap allocation per vector.
+class EuclideanVectorBatch {
+ public:
+  /* CONSTRUCTORS */
+  // Throw EuclideanVectorError for negative dimensions, or vectors with more than INT_MAX
+  explicit EuclideanVectorBatch(int num_dimensions);
+  explicit EuclideanVectorBatch(const std::vector<EuclideanVector>& evs);
+
+  /* METHODS */
+  int GetNumDimensions() const noexcept { return this->num_dimensions_; }
+  std::size_t size() const noexcept { return this->num_vectors_; }
+  bool empty() const noexcept { return this->num_vectors_ == 0; }
+  void Reserve(std::size_t num_vectors);
+  // Grows (with all-zero vectors) or shrinks to num_vectors vectors
+  void Resize(std::size_t num_vectors);
+  void Clear() noexcept;
+
+  // Appends a vector and returns its position in the batch
+  std::size_t Add(const EuclideanVector& ev);
+  std::size_t Add(const double* magnitudes);
+
+  // Raw magnitudes of the i-th vector (GetNumDimensions() values)
+  const double* Row(std::size_t i) const noexcept { return &this->magnitudes_[i * stride()]; }
+  double* Row(std::size_t i) noexcept { return &this->magnitudes_[i * stride()]; }
+  const double* data() const noexcept { return this->magnitudes_.data(); }
+
+  // Copies the i-th vector out as a standalone EuclideanVector
+  EuclideanVector Get(std::size_t i) const;
+
+ private:
+  std::size_t stride() const noexcept { return static_cast<std::size_t>(this->num_dimensions_); }
+
+  std::vector<double> magnitudes_;
+  std::size_t num_vectors_;
+  int num_dimensions_;
+};
+
+// Exhaustive k-nearest-neighbour scan, nearest first
+std::vector<Neighbour> FindNearest(const EuclideanVectorBatch& batch,
+                                   const EuclideanVector& query,
+                                   std::size_t k);
+
+#endif  // ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_BATCH_H_
@@ -0,0 +1,76 @@
+/*
+
+  == Explanation and rational of testing ==
+  The batch is a plain container, so these tests check that vectors go in and come back out
+  unchanged, that the dimension of every vector is enforced (and cannot be negative) and that the
+  exhaustive scan (which the index tests use as their reference answer) returns neighbours nearest
+  first.
+
+*/
+
+#include "assignments/ev/euclidean_vector_batch.h"
+#include "catch.h"
+
+/* Add / Get */
+SCENARIO("Storing vectors in a batch") {
+  WHEN("You add two vectors of the batch's dimension") {
+    EuclideanVectorBatch batch{3};
+    std::vector<double> v{1, -2, 3.5};
+    EuclideanVector a{v.begin(), v.end()};
+    EuclideanVector b{3, 7};
+
+    REQUIRE(batch.Add(a) == 0);
+    REQUIRE(batch.Add(b) == 1);
+
+    THEN("They are stored contiguously and can be copied back out") {
+      REQUIRE(batch.size() == 2);
+      REQUIRE(batch.Get(0) == a);
+      REQUIRE(batch.Get(1) == b);
+      REQUIRE(batch.Row(1) == batch.Row(0) + 3);
+    }
+  }
+}
+
+// EXCEPTION - dimensions do not match
+SCENARIO("Adding a vector of the wrong dimension to a batch") {
+  WHEN("You create a batch of 3 dimensional vectors") {
+    EuclideanVectorBatch batch{3};
+
+    THEN("Adding a 2 dimensional vector returns exception error") {
+      REQUIRE_THROWS_WITH(batch.Add(EuclideanVector{2}),
+                          "Dimensions of batch(3) and vector(2) do not match");
+    }
+  }
+}
+
+// EXCEPTION - negative dimensions
+SCENARIO("Creating a batch of negative dimension") {
+  WHEN("You ask for -1 dimensional vectors") {
+    THEN("EuclideanVectorError is thrown") {
+      REQUIRE_THROWS_WITH(EuclideanVectorBatch{-1},
+                          "EuclideanVectorBatch needs num_dimensions >= 0");
+    }
+  }
+}
+
+/* FindNearest */
+SCENARIO("Exhaustive nearest neighbour scan") {
+  WHEN("You create a batch of points on a line") {
+    std::vector<EuclideanVector> points;
+    for (int i = 0; i < 10; ++i) {
+      points.emplace_back(2, static_cast<double>(i));
+    }
+    EuclideanVectorBatch batch{points};
+
+    THEN("The closest points to the query come back nearest first") {
+      EuclideanVector query{2, 6.2};
+      std::vector<Neighbour> result = FindNearest(batch, query, 3);
+
+      REQUIRE(result.size() == 3);
+      REQUIRE(result[0].id == 6);
+      REQUIRE(result[1].id == 7);
+      REQUIRE(result[2].id == 5);
+      REQUIRE(result[0].distance == Approx((query - points[6]).GetEuclideanNorm()));
+    }
+  }
+}
@@ -0,0 +1,182 @@
+/*
+
+  == Explanation and rational of testing ==
+  These tests guard against EuclideanVector leaking or over-allocating. This file replaces the
+  global operator new/delete with a tracking version that keeps the number of live heap bytes and
+  the highest value it reached. Each operation is run in its own scope and must end with the same
+  number of live bytes it started with; the peak it needed is printed so that growth in memory use
+  shows up when the output is compared between versions.
+
+  The tracker only sees operator new, so the tests should also be run in a sanitizer build to catch
+  leaks and bad frees in malloc-level code, e.g.
+
+    g++ -std=c++17 -g -fsanitize=address,undefined -fno-omit-frame-pointer ...
+
+  with ASAN_OPTIONS=detect_leaks=1.
+
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "catch.h"
+
+namespace {
+
+// Every block is preceded by a header holding its size so that delete can account for it
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+std::atomic<long long> g_live_bytes{0};
+std::atomic<long long> g_peak_bytes{0};
+
+void* TrackedAllocate(std::size_t size) {
+  void* block = std::malloc(size + kHeader);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *static_cast<std::size_t*>(block) = size;
+  long long live = g_live_bytes.fetch_add(static_cast<long long>(size)) +
+                   static_cast<long long>(size);
+  long long peak = g_peak_bytes.load();
+  while (live > peak && !g_peak_bytes.compare_exchange_weak(peak, live)) {
+  }
+  return static_cast<char*>(block) + kHeader;
+}
+
+void TrackedFree(void* p) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+  void* block = static_cast<char*>(p) - kHeader;
+  g_live_bytes.fetch_sub(static_cast<long long>(*static_cast<std::size_t*>(block)));
+  std::free(block);
+}
+
+struct Usage {
+  long long net;   // live bytes left over after the operation
+  long long peak;  // most bytes live at once during the operation, above the starting point
+};
+
+// Runs operation and reports how much heap it used
+Usage Measure(const std::function<void()>& operation) {
+  long long before = g_live_bytes.load();
+  g_peak_bytes.store(before);
+  operation();
+  return Usage{g_live_bytes.load() - before, g_peak_bytes.load() - before};
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  void* p = TrackedAllocate(size);
+  if (p == nullptr) {
+    throw std::bad_alloc{};
+  }
+  return p;
+}
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return TrackedAllocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return TrackedAllocate(size);
+}
+void operator delete(void* p) noexcept {
+  TrackedFree(p);
+}
+void operator delete[](void* p) noexcept {
+  TrackedFree(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+  TrackedFree(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+  TrackedFree(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  TrackedFree(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  TrackedFree(p);
+}
+
+SCENARIO("Creating, copying, moving and destroying vectors frees every byte") {
+  WHEN("You run each operation on 1000 dimensional vectors in its own scope") {
+    const long long bytes = 1000 * sizeof(double);
+    std::vector<double> source(1000, 1.5);
+    EuclideanVector other{1000, 2};
+
+    std::vector<std::pair<const char*, std::function<void()>>> operations{
+      {"fill construct", [] { EuclideanVector a{1000, 1}; }},
+      {"range construct", [&] { EuclideanVector a{source.begin(), source.end()}; }},
+      {"copy construct", [&] { EuclideanVector a{other}; }},
+      {"move construct",
+       [] {
+         EuclideanVector a{1000, 1};
+         EuclideanVector b{std::move(a)};
+       }},
+      {"copy assign",
+       [&] {
+         EuclideanVector a{1000, 1};
+         a = other;
+       }},
+      {"move assign",
+       [] {
+         EuclideanVector a{1000, 1};
+         EuclideanVector b{10, 1};
+         b = std::move(a);
+       }},
+      {"add", [&] { EuclideanVector a = other + other; }},
+      {"unit vector", [&] { EuclideanVector a = other.CreateUnitVector(); }},
+    };
+
+    THEN("No bytes are left live and the peak stays within what the operation needs") {
+#ifdef EV_PROFILING
+      // Profiling keeps a thread's histogram for an operation once it has first been timed, so
+      //  run everything once before measuring
+      for (const auto& named : operations) {
+        named.second();
+      }
+#endif
+      for (const auto& [name, operation] : operations) {
+        Usage usage = Measure(operation);
+        std::cout << name << ": peak " << usage.peak << " bytes, net " << usage.net << " bytes\n";
+        INFO(name);
+        REQUIRE(usage.net == 0);
+        REQUIRE(usage.peak <= 2 * bytes);
+      }
+    }
+  }
+}
+
+SCENARIO("Copy assignment between vectors of the same dimension allocates nothing") {
+  WHEN("You create two vectors of the same dimension") {
+    EuclideanVector a{1000, 1};
+    EuclideanVector b{1000, 2};
+
+    THEN("Copying one onto the other does not touch the heap") {
+      Usage usage = Measure([&] { a = b; });
+      REQUIRE(usage.peak == 0);
+      REQUIRE(a == b);
+    }
+  }
+}
+
+SCENARIO("Repeatedly replacing a vector does not grow memory") {
+  WHEN("You overwrite a vector many times in a loop") {
+    THEN("The live bytes after the loop equal those before it") {
+      Usage usage = Measure([] {
+        EuclideanVector a{100};
+        for (int i = 0; i < 1000; ++i) {
+          a = EuclideanVector{100, static_cast<double>(i)};
+        }
+      });
+      REQUIRE(usage.net == 0);
+    }
+  }
+}
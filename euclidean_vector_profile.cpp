@@ -0,0 +1,512 @@
+#include "assignments/ev/euclidean_vector_profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Dimension ranges: 0 for empty vectors, then r for dimensions in [2^(r-1), 2^r)
+constexpr std::size_t kDimensionRanges = 65;
+constexpr std::size_t kNumSlots = kNumEvOperations * kDimensionRanges;
+
+int FloorLog2(std::uint64_t x) noexcept {
+#if defined(__GNUC__)
+  return 63 - __builtin_clzll(x);
+#else
+  int log = 0;
+  while (x >>= 1) {
+    ++log;
+  }
+  return log;
+#endif
+}
+
+std::size_t DimensionRange(std::size_t dimensions) noexcept {
+  return dimensions == 0 ? 0 : static_cast<std::size_t>(FloorLog2(dimensions)) + 1;
+}
+
+std::size_t Slot(EvOperation operation, std::size_t dimensions) noexcept {
+  return static_cast<std::size_t>(operation) * kDimensionRanges + DimensionRange(dimensions);
+}
+
+std::uint64_t Nanoseconds(Clock::duration d) noexcept {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  return ns < 0 ? 0 : static_cast<std::uint64_t>(ns);
+}
+
+// Only the owning thread writes, so a load and a store are enough and no read-modify-write is
+//  needed; readers on other threads see each value whole
+void Add(std::atomic<std::uint64_t>& counter, std::uint64_t amount) noexcept {
+  counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct ThreadHistogram {
+  std::array<std::atomic<std::uint64_t>, kNumLatencyBuckets> counts{};
+  std::atomic<std::uint64_t> count{0};
+  std::atomic<std::uint64_t> total_ns{0};
+  std::atomic<std::uint64_t> min_ns{std::numeric_limits<std::uint64_t>::max()};
+  std::atomic<std::uint64_t> max_ns{0};
+
+  void Record(std::uint64_t ns) noexcept {
+    Add(this->counts[LatencyBucket(ns)], 1);
+    Add(this->count, 1);
+    Add(this->total_ns, ns);
+    if (ns < this->min_ns.load(std::memory_order_relaxed)) {
+      this->min_ns.store(ns, std::memory_order_relaxed);
+    }
+    if (ns > this->max_ns.load(std::memory_order_relaxed)) {
+      this->max_ns.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+  void Clear() noexcept {
+    for (auto& c : this->counts) {
+      c.store(0, std::memory_order_relaxed);
+    }
+    this->count.store(0, std::memory_order_relaxed);
+    this->total_ns.store(0, std::memory_order_relaxed);
+    this->min_ns.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    this->max_ns.store(0, std::memory_order_relaxed);
+  }
+
+  void AddTo(LatencyHistogram& out) const noexcept {
+    for (std::size_t i = 0; i < kNumLatencyBuckets; ++i) {
+      out.counts[i] += this->counts[i].load(std::memory_order_relaxed);
+    }
+    out.count += this->count.load(std::memory_order_relaxed);
+    out.total_ns += this->total_ns.load(std::memory_order_relaxed);
+    out.min_ns = std::min(out.min_ns, this->min_ns.load(std::memory_order_relaxed));
+    out.max_ns = std::max(out.max_ns, this->max_ns.load(std::memory_order_relaxed));
+  }
+};
+
+struct TraceEvent {
+  EvOperation operation;
+  std::size_t dimensions;
+  std::uint64_t start_ns;  // steady clock time
+  std::uint64_t duration_ns;
+  int thread;
+};
+
+struct ThreadProfile;
+
+// Every live thread's profile, plus what the threads that have exited recorded. Readers hold the
+//  mutex while walking the profiles, so a thread cannot free its histograms under them.
+std::mutex g_registry_mutex;
+std::vector<ThreadProfile*> g_registry;
+std::array<std::unique_ptr<LatencyHistogram>, kNumSlots> g_retired;
+std::vector<TraceEvent> g_retired_events;
+int g_next_thread = 1;
+
+// Bumped by ResetProfile; histograms recorded under an older generation are ignored by readers
+//  and cleared by their owner before its next recording
+std::atomic<std::uint64_t> g_generation{1};
+
+std::atomic<bool> g_tracing{false};
+std::atomic<std::uint64_t> g_trace_generation{0};
+std::atomic<std::size_t> g_max_trace_events{0};
+Clock::time_point g_trace_start;  // guarded by g_registry_mutex
+
+std::atomic<int> g_marker_fd{-1};
+
+thread_local bool t_profile_destroyed = false;
+
+struct ThreadProfile {
+  std::array<std::atomic<ThreadHistogram*>, kNumSlots> histograms{};
+  std::atomic<std::uint64_t> generation{0};
+  int thread = 0;
+  bool registered = false;
+
+  // Guards events against WriteChromeTrace; only contended while a trace is being written
+  std::mutex trace_mutex;
+  std::vector<TraceEvent> events;
+  std::uint64_t trace_generation = 0;
+
+  // Constructed inside noexcept ProfileScope, so a registry that cannot grow leaves the thread
+  //  unregistered, and unprofiled, instead of throwing
+  ThreadProfile() noexcept {
+    try {
+      std::lock_guard lock{g_registry_mutex};
+      g_registry.push_back(this);
+      this->thread = g_next_thread++;
+      this->registered = true;
+    } catch (...) {
+      // not profiled, like a thread that is exiting
+    }
+  }
+
+  // Folds the histograms and trace events into the retired totals so they outlive the thread
+  ~ThreadProfile() {
+    t_profile_destroyed = true;
+    if (!this->registered) {
+      return;
+    }
+    std::lock_guard lock{g_registry_mutex};
+    const bool current = this->generation.load(std::memory_order_relaxed) ==
+                         g_generation.load(std::memory_order_relaxed);
+    for (std::size_t slot = 0; slot < kNumSlots; ++slot) {
+      ThreadHistogram* histogram = this->histograms[slot].load(std::memory_order_relaxed);
+      if (histogram == nullptr) {
+        continue;
+      }
+      if (current) {
+        if (g_retired[slot] == nullptr) {
+          g_retired[slot].reset(new (std::nothrow) LatencyHistogram());
+        }
+        if (g_retired[slot] != nullptr) {
+          histogram->AddTo(*g_retired[slot]);
+        }
+      }
+      delete histogram;
+    }
+    if (this->trace_generation == g_trace_generation.load(std::memory_order_relaxed)) {
+      try {
+        g_retired_events.insert(g_retired_events.end(), this->events.begin(), this->events.end());
+      } catch (const std::bad_alloc&) {
+        // dropped, like events over the limit
+      }
+    }
+    g_registry.erase(std::find(g_registry.begin(), g_registry.end(), this));
+  }
+
+  void Record(EvOperation operation, std::size_t dimensions, std::uint64_t ns) noexcept {
+    const std::uint64_t current = g_generation.load(std::memory_order_relaxed);
+    if (this->generation.load(std::memory_order_relaxed) != current) {
+      for (auto& slot : this->histograms) {
+        if (ThreadHistogram* histogram = slot.load(std::memory_order_relaxed)) {
+          histogram->Clear();
+        }
+      }
+      this->generation.store(current, std::memory_order_release);
+    }
+
+    std::atomic<ThreadHistogram*>& slot = this->histograms[Slot(operation, dimensions)];
+    ThreadHistogram* histogram = slot.load(std::memory_order_relaxed);
+    if (histogram == nullptr) {
+      histogram = new (std::nothrow) ThreadHistogram();
+      if (histogram == nullptr) {
+        return;
+      }
+      slot.store(histogram, std::memory_order_release);
+    }
+    histogram->Record(ns);
+  }
+
+  void Trace(const TraceEvent& event) noexcept {
+    std::lock_guard lock{this->trace_mutex};
+    const std::uint64_t current = g_trace_generation.load(std::memory_order_relaxed);
+    if (this->trace_generation != current) {
+      this->events.clear();
+      this->trace_generation = current;
+    }
+    if (this->events.size() < g_max_trace_events.load(std::memory_order_relaxed)) {
+      try {
+        this->events.push_back(event);
+      } catch (const std::bad_alloc&) {
+        // dropped, like events over the limit
+      }
+    }
+  }
+};
+
+// The calling thread's profile, or nullptr while the thread is exiting or if it could not be
+//  registered
+ThreadProfile* LocalProfile() noexcept {
+  if (t_profile_destroyed) {
+    return nullptr;
+  }
+  thread_local ThreadProfile profile;
+  return profile.registered ? &profile : nullptr;
+}
+
+int ProcessId() noexcept {
+#if defined(__linux__)
+  return static_cast<int>(::getpid());
+#else
+  return 1;
+#endif
+}
+
+void WriteMarker(int fd, const char* text, int length) noexcept {
+#if defined(__linux__)
+  if (length > 0 && ::write(fd, text, static_cast<std::size_t>(length)) < 0) {
+    // markers are best effort
+  }
+#else
+  (void)fd;
+  (void)text;
+  (void)length;
+#endif
+}
+
+}  // namespace
+
+/* HISTOGRAMS */
+std::size_t LatencyBucket(std::uint64_t ns) noexcept {
+  if (ns < kLatencySubBuckets) {
+    return static_cast<std::size_t>(ns);
+  }
+  const int shift = FloorLog2(ns) - kLatencySubBucketBits;
+  return static_cast<std::size_t>(static_cast<std::uint64_t>(shift + 1) * kLatencySubBuckets +
+                                  ((ns >> shift) - kLatencySubBuckets));
+}
+
+std::uint64_t LatencyBucketLowerBound(std::size_t bucket) noexcept {
+  if (bucket < kLatencySubBuckets) {
+    return bucket;
+  }
+  const std::size_t shift = bucket / kLatencySubBuckets - 1;
+  return (kLatencySubBuckets + bucket % kLatencySubBuckets) << shift;
+}
+
+std::uint64_t LatencyBucketUpperBound(std::size_t bucket) noexcept {
+  return bucket + 1 == kNumLatencyBuckets ? std::numeric_limits<std::uint64_t>::max()
+                                          : LatencyBucketLowerBound(bucket + 1) - 1;
+}
+
+void LatencyHistogram::Record(std::uint64_t ns) noexcept {
+  ++this->counts[LatencyBucket(ns)];
+  ++this->count;
+  this->total_ns += ns;
+  this->min_ns = std::min(this->min_ns, ns);
+  this->max_ns = std::max(this->max_ns, ns);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) noexcept {
+  for (std::size_t i = 0; i < kNumLatencyBuckets; ++i) {
+    this->counts[i] += other.counts[i];
+  }
+  this->count += other.count;
+  this->total_ns += other.total_ns;
+  this->min_ns = std::min(this->min_ns, other.min_ns);
+  this->max_ns = std::max(this->max_ns, other.max_ns);
+}
+
+double LatencyHistogram::Mean() const noexcept {
+  return this->count == 0 ? 0.0
+                          : static_cast<double>(this->total_ns) / static_cast<double>(this->count);
+}
+
+std::uint64_t LatencyHistogram::Percentile(double q) const noexcept {
+  if (this->count == 0) {
+    return 0;
+  }
+  const double clamped = std::min(std::max(q, 0.0), 1.0);
+  auto rank = static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(this->count)));
+  rank = std::max<std::uint64_t>(rank, 1);
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kNumLatencyBuckets; ++i) {
+    seen += this->counts[i];
+    if (seen >= rank) {
+      return std::min(LatencyBucketUpperBound(i), this->max_ns);
+    }
+  }
+  return this->max_ns;
+}
+
+/* TIMING */
+ProfileScope::ProfileScope(EvOperation operation, std::size_t dimensions) noexcept
+  : operation_{operation}, dimensions_{dimensions} {
+  const int fd = g_marker_fd.load(std::memory_order_relaxed);
+  if (fd >= 0) {
+    char text[96];
+    WriteMarker(fd, text,
+                std::snprintf(text, sizeof(text), "B|%d|%s %zu\n", ProcessId(),
+                              ToString(operation), dimensions));
+  }
+  this->start_ = Clock::now();
+}
+
+ProfileScope::~ProfileScope() {
+  const Clock::time_point end = Clock::now();
+  const int fd = g_marker_fd.load(std::memory_order_relaxed);
+  if (fd >= 0) {
+    char text[32];
+    WriteMarker(fd, text, std::snprintf(text, sizeof(text), "E|%d\n", ProcessId()));
+  }
+  ThreadProfile* profile = LocalProfile();
+  if (profile == nullptr) {
+    return;
+  }
+  const std::uint64_t ns = Nanoseconds(end - this->start_);
+  profile->Record(this->operation_, this->dimensions_, ns);
+  if (g_tracing.load(std::memory_order_relaxed)) {
+    profile->Trace(TraceEvent{this->operation_, this->dimensions_,
+                              Nanoseconds(this->start_.time_since_epoch()), ns, profile->thread});
+  }
+}
+
+/* SNAPSHOTS */
+std::vector<OperationProfile> GetProfile() {
+  std::array<LatencyHistogram*, kNumSlots> merged{};
+  std::vector<std::unique_ptr<LatencyHistogram>> owned;
+  auto get = [&merged, &owned](std::size_t slot) -> LatencyHistogram& {
+    if (merged[slot] == nullptr) {
+      owned.push_back(std::make_unique<LatencyHistogram>());
+      merged[slot] = owned.back().get();
+    }
+    return *merged[slot];
+  };
+
+  {
+    std::lock_guard lock{g_registry_mutex};
+    const std::uint64_t current = g_generation.load(std::memory_order_relaxed);
+    for (std::size_t slot = 0; slot < kNumSlots; ++slot) {
+      if (g_retired[slot] != nullptr) {
+        get(slot).Merge(*g_retired[slot]);
+      }
+    }
+    for (const ThreadProfile* profile : g_registry) {
+      if (profile->generation.load(std::memory_order_acquire) != current) {
+        continue;
+      }
+      for (std::size_t slot = 0; slot < kNumSlots; ++slot) {
+        if (const ThreadHistogram* h = profile->histograms[slot].load(std::memory_order_acquire)) {
+          h->AddTo(get(slot));
+        }
+      }
+    }
+  }
+
+  std::vector<OperationProfile> profile;
+  for (std::size_t slot = 0; slot < kNumSlots; ++slot) {
+    if (merged[slot] == nullptr || merged[slot]->count == 0) {
+      continue;
+    }
+    const std::size_t range = slot % kDimensionRanges;
+    OperationProfile entry{static_cast<EvOperation>(slot / kDimensionRanges), 0, 0, {}};
+    if (range > 0) {
+      entry.min_dimensions = std::size_t{1} << (range - 1);
+      entry.max_dimensions = range == 64 ? std::numeric_limits<std::size_t>::max()
+                                         : (std::size_t{1} << range) - 1;
+    }
+    entry.latency = *merged[slot];
+    profile.push_back(std::move(entry));
+  }
+  return profile;
+}
+
+void ResetProfile() noexcept {
+  std::lock_guard lock{g_registry_mutex};
+  g_generation.fetch_add(1, std::memory_order_relaxed);
+  for (auto& retired : g_retired) {
+    retired.reset();
+  }
+}
+
+std::string ToJson(const std::vector<OperationProfile>& profile) {
+  std::ostringstream os;
+  os << '[';
+  for (std::size_t i = 0; i < profile.size(); ++i) {
+    const OperationProfile& entry = profile[i];
+    os << (i == 0 ? "" : ",") << "{\"operation\":\"" << ToString(entry.operation)
+       << "\",\"min_dimensions\":" << entry.min_dimensions
+       << ",\"max_dimensions\":" << entry.max_dimensions << ",\"count\":" << entry.latency.count
+       << ",\"mean_ns\":" << entry.latency.Mean()
+       << ",\"p50_ns\":" << entry.latency.Percentile(0.5)
+       << ",\"p90_ns\":" << entry.latency.Percentile(0.9)
+       << ",\"p99_ns\":" << entry.latency.Percentile(0.99)
+       << ",\"max_ns\":" << entry.latency.max_ns << '}';
+  }
+  os << ']';
+  return os.str();
+}
+
+void DumpEuclideanVectorProfile(std::ostream& os) {
+  os << ToJson(GetProfile()) << '\n';
+}
+
+/* TRACING */
+void StartTrace(std::size_t max_events_per_thread) {
+  std::lock_guard lock{g_registry_mutex};
+  g_retired_events.clear();
+  g_max_trace_events.store(max_events_per_thread, std::memory_order_relaxed);
+  g_trace_generation.fetch_add(1, std::memory_order_relaxed);
+  g_trace_start = Clock::now();
+  g_tracing.store(true, std::memory_order_relaxed);
+}
+
+void StopTrace() noexcept {
+  g_tracing.store(false, std::memory_order_relaxed);
+}
+
+void WriteChromeTrace(std::ostream& os) {
+  std::vector<TraceEvent> events;
+  std::uint64_t start_ns = 0;
+  {
+    std::lock_guard lock{g_registry_mutex};
+    const std::uint64_t current = g_trace_generation.load(std::memory_order_relaxed);
+    start_ns = Nanoseconds(g_trace_start.time_since_epoch());
+    events = g_retired_events;
+    for (ThreadProfile* profile : g_registry) {
+      std::lock_guard trace_lock{profile->trace_mutex};
+      if (profile->trace_generation == current) {
+        events.insert(events.end(), profile->events.begin(), profile->events.end());
+      }
+    }
+  }
+  std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+    return a.start_ns < b.start_ns;
+  });
+
+  const int pid = ProcessId();
+  os << "{\"traceEvents\":[";
+  std::ios_base::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent& event = events[i];
+    const std::uint64_t since_start = event.start_ns >= start_ns ? event.start_ns - start_ns : 0;
+    os << (i == 0 ? "" : ",") << "\n{\"name\":\"" << ToString(event.operation)
+       << "\",\"cat\":\"EuclideanVector\",\"ph\":\"X\",\"pid\":" << pid
+       << ",\"tid\":" << event.thread << ",\"ts\":" << static_cast<double>(since_start) / 1000
+       << ",\"dur\":" << static_cast<double>(event.duration_ns) / 1000
+       << ",\"args\":{\"dimensions\":" << event.dimensions << "}}";
+  }
+  os.flags(flags);
+  os.precision(precision);
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+/* MARKERS */
+bool OpenTraceMarkers(const std::string& path) {
+#if defined(__linux__)
+  const int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const int old = g_marker_fd.exchange(fd);
+  if (old >= 0) {
+    ::close(old);
+  }
+  return true;
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+void CloseTraceMarkers() noexcept {
+  const int fd = g_marker_fd.exchange(-1);
+#if defined(__linux__)
+  if (fd >= 0) {
+    ::close(fd);
+  }
+#else
+  (void)fd;
+#endif
+}
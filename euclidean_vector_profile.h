@@ -0,0 +1,105 @@
+#ifndef ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_PROFILE_H_
+#define ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_PROFILE_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector_stats.h"
+
+// Opt-in latency profiling of EuclideanVector operations.
+//  Build with -DEV_PROFILING to time norms, unit vectors, dot products, the arithmetic operators
+//  and the conversions to std::vector and std::list. Every timing goes into a histogram owned by
+//  the calling thread, keyed by the operation and by the power-of-two range its vector's
+//  dimensions fall in, so recording takes no lock; snapshots merge every thread's histograms.
+//  While a trace is running the timings are also kept as events for WriteChromeTrace, and while
+//  trace markers are open each operation is bracketed by ftrace markers that perf and trace-cmd
+//  show alongside kernel events. Without EV_PROFILING the hooks expand to nothing, and the API
+//  still works for code that times itself with ProfileScope.
+
+constexpr int kLatencySubBucketBits = 4;
+constexpr std::uint64_t kLatencySubBuckets = std::uint64_t{1} << kLatencySubBucketBits;
+constexpr std::size_t kNumLatencyBuckets = (64 - kLatencySubBucketBits + 1) * kLatencySubBuckets;
+
+// Bucket holding ns: exact below kLatencySubBuckets, then kLatencySubBuckets linear buckets per
+//  power of two, so a bucket's bounds are within 1/16 (6.25%) of each other
+std::size_t LatencyBucket(std::uint64_t ns) noexcept;
+std::uint64_t LatencyBucketLowerBound(std::size_t bucket) noexcept;
+std::uint64_t LatencyBucketUpperBound(std::size_t bucket) noexcept;
+
+// HdrHistogram style latency histogram in nanoseconds
+struct LatencyHistogram {
+  std::array<std::uint64_t, kNumLatencyBuckets> counts{};
+  std::uint64_t count = 0;
+  std::uint64_t total_ns = 0;
+  std::uint64_t min_ns = std::numeric_limits<std::uint64_t>::max();
+  std::uint64_t max_ns = 0;
+
+  void Record(std::uint64_t ns) noexcept;
+  void Merge(const LatencyHistogram& other) noexcept;
+  double Mean() const noexcept;
+  // Upper bound of the bucket holding the q-quantile (0 <= q <= 1), capped at max_ns; 0 if empty
+  std::uint64_t Percentile(double q) const noexcept;
+};
+
+// Timings of one operation on vectors of min_dimensions to max_dimensions dimensions
+struct OperationProfile {
+  EvOperation operation;
+  std::size_t min_dimensions;
+  std::size_t max_dimensions;
+  LatencyHistogram latency;
+};
+
+// Times its own lifetime and records it as one call of operation on a vector of the given
+//  dimensions
+class ProfileScope {
+ public:
+  ProfileScope(EvOperation operation, std::size_t dimensions) noexcept;
+  ~ProfileScope();
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  EvOperation operation_;
+  std::size_t dimensions_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Every (operation, dimension range) timed since the last reset, merged across threads, in
+//  operation then dimension order (safe to call while other threads are recording)
+std::vector<OperationProfile> GetProfile();
+// Discards every timing; each thread clears its own histograms the next time it records
+void ResetProfile() noexcept;
+
+// Writes the profile as a JSON array of {"operation","min_dimensions","max_dimensions","count",
+//  "mean_ns","p50_ns","p90_ns","p99_ns","max_ns"} objects
+std::string ToJson(const std::vector<OperationProfile>& profile);
+void DumpEuclideanVectorProfile(std::ostream& os);
+
+// Keeps every timing from now on as a trace event, up to max_events_per_thread per thread (later
+//  ones are dropped); starting again discards the previous trace
+void StartTrace(std::size_t max_events_per_thread = std::size_t{1} << 20);
+void StopTrace() noexcept;
+// Writes the events of the last trace in the Chrome trace event format (chrome://tracing,
+//  Perfetto): one complete ("X") event per call, timestamps in microseconds since StartTrace
+void WriteChromeTrace(std::ostream& os);
+
+// Brackets every timed operation with "B|pid|name" and "E|pid" lines written to path (the ftrace
+//  marker file by default, which needs tracefs access). Returns false if path cannot be opened.
+bool OpenTraceMarkers(const std::string& path = "/sys/kernel/tracing/trace_marker");
+// Only call once no other thread is inside a timed operation
+void CloseTraceMarkers() noexcept;
+
+#ifdef EV_PROFILING
+#define EV_PROFILE_OPERATION(op, dimensions) \
+  ProfileScope ev_profile_scope { EvOperation::op, (dimensions) }
+#else
+#define EV_PROFILE_OPERATION(op, dimensions) static_cast<void>(0)
+#endif
+
+#endif  // ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_PROFILE_H_
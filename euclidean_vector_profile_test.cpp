@@ -0,0 +1,188 @@
+/*
+
+  == Explanation and rational of testing ==
+  The histogram's bucketing is checked directly, since every percentile depends on it: each value
+  must land in a bucket whose bounds hold it and are within 1/16 of each other. Recording is then
+  driven through ProfileScope, which works with or without -DEV_PROFILING, from several threads
+  (some of which exit before the snapshot) so that merging live and retired histograms is covered.
+  Traces and markers are checked by writing them out and looking for the expected events. Only
+  in a build with -DEV_PROFILING are EuclideanVector's own operations expected to show up.
+
+*/
+
+#include "assignments/ev/euclidean_vector_profile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "catch.h"
+
+namespace {
+
+// The entry for operation on vectors of the given dimensions, or nullptr
+const OperationProfile* Find(const std::vector<OperationProfile>& profile,
+                             EvOperation operation,
+                             std::size_t dimensions) {
+  for (const OperationProfile& entry : profile) {
+    if (entry.operation == operation && entry.min_dimensions <= dimensions &&
+        dimensions <= entry.max_dimensions) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+std::size_t Count(const std::string& text, const std::string& pattern) {
+  std::size_t count = 0;
+  for (std::size_t at = text.find(pattern); at != std::string::npos;
+       at = text.find(pattern, at + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+SCENARIO("Latency histogram buckets") {
+  WHEN("You bucket values across the whole 64-bit range") {
+    THEN("Each bucket holds its value and spans at most 1/16 of it") {
+      for (std::uint64_t ns = 0; ns < kLatencySubBuckets; ++ns) {
+        REQUIRE(LatencyBucket(ns) == ns);
+      }
+      for (std::uint64_t ns = 16; ns != 0 && ns < (std::uint64_t{1} << 62); ns = ns * 3 / 2 + 7) {
+        std::size_t bucket = LatencyBucket(ns);
+        REQUIRE(LatencyBucketLowerBound(bucket) <= ns);
+        REQUIRE(ns <= LatencyBucketUpperBound(bucket));
+        REQUIRE(LatencyBucketUpperBound(bucket) - LatencyBucketLowerBound(bucket) <= ns / 16);
+      }
+      REQUIRE(LatencyBucket(~std::uint64_t{0}) == kNumLatencyBuckets - 1);
+    }
+  }
+  WHEN("You record 1 to 1000 nanoseconds") {
+    LatencyHistogram histogram;
+    for (std::uint64_t ns = 1; ns <= 1000; ++ns) {
+      histogram.Record(ns);
+    }
+    LatencyHistogram merged;
+    merged.Merge(histogram);
+    merged.Merge(histogram);
+    THEN("The percentiles are within a bucket of the exact ones") {
+      REQUIRE(histogram.count == 1000);
+      REQUIRE(histogram.Mean() == Approx(500.5));
+      REQUIRE(histogram.min_ns == 1);
+      REQUIRE(histogram.Percentile(0.5) >= 500);
+      REQUIRE(histogram.Percentile(0.5) <= 500 + 500 / 16);
+      REQUIRE(histogram.Percentile(0.99) >= 990);
+      REQUIRE(histogram.Percentile(1) == 1000);
+      REQUIRE(merged.count == 2000);
+      REQUIRE(merged.Percentile(0.5) == histogram.Percentile(0.5));
+      REQUIRE(LatencyHistogram{}.Percentile(0.5) == 0);
+    }
+  }
+}
+
+SCENARIO("Profiling scopes from several threads") {
+  WHEN("Threads time calls on 100 and 5000 dimensional vectors, and some exit first") {
+    ResetProfile();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([] {
+        for (int i = 0; i < 1000; ++i) {
+          ProfileScope scope{EvOperation::kDot, 100};
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (int i = 0; i < 10; ++i) {
+      ProfileScope scope{EvOperation::kDot, 5000};
+    }
+    std::vector<OperationProfile> profile = GetProfile();
+    std::string json = ToJson(profile);
+    ResetProfile();
+    std::vector<OperationProfile> after_reset = GetProfile();
+
+    THEN("Calls are merged per dimension range, and reset clears them") {
+      const OperationProfile* small = Find(profile, EvOperation::kDot, 100);
+      const OperationProfile* large = Find(profile, EvOperation::kDot, 5000);
+      REQUIRE(small != nullptr);
+      REQUIRE(large != nullptr);
+      REQUIRE(small->min_dimensions == 64);
+      REQUIRE(small->max_dimensions == 127);
+      REQUIRE(small->latency.count == 4000);
+      REQUIRE(large->latency.count == 10);
+      REQUIRE(large->latency.max_ns >= large->latency.Percentile(0.5));
+      REQUIRE(json.find("{\"operation\":\"dot\",\"min_dimensions\":64,\"max_dimensions\":127,"
+                        "\"count\":4000") != std::string::npos);
+      REQUIRE(Find(after_reset, EvOperation::kDot, 100) == nullptr);
+    }
+  }
+}
+
+SCENARIO("Chrome traces and trace markers") {
+  WHEN("You trace more calls than the per-thread limit") {
+    StartTrace(5);
+    for (int i = 0; i < 8; ++i) {
+      ProfileScope scope{EvOperation::kNorm, 3};
+    }
+    StopTrace();
+    {
+      ProfileScope untraced{EvOperation::kNorm, 3};
+    }
+    std::ostringstream trace;
+    WriteChromeTrace(trace);
+    THEN("The trace holds the first calls up to the limit as complete events") {
+      REQUIRE(trace.str().rfind("{\"traceEvents\":[", 0) == 0);
+      REQUIRE(Count(trace.str(), "\"ph\":\"X\"") == 5);
+      REQUIRE(Count(trace.str(), "\"name\":\"norm\"") == 5);
+      REQUIRE(Count(trace.str(), "\"args\":{\"dimensions\":3}") == 5);
+    }
+  }
+  WHEN("You open trace markers on a file and time a call") {
+    const std::string path = "euclidean_vector_profile_markers.txt";
+    std::ofstream{path};
+    bool opened = OpenTraceMarkers(path);
+    {
+      ProfileScope scope{EvOperation::kUnitVector, 7};
+    }
+    CloseTraceMarkers();
+    std::ifstream in{path};
+    std::string markers{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::remove(path.c_str());
+    THEN("The call is bracketed by begin and end markers where markers are supported") {
+      if (opened) {
+        REQUIRE(Count(markers, "|unit_vector 7\n") == 1);
+        REQUIRE(markers.rfind("B|", 0) == 0);
+        REQUIRE(Count(markers, "E|") == 1);
+      }
+      REQUIRE_FALSE(OpenTraceMarkers("/nonexistent/trace_marker"));
+    }
+  }
+}
+
+SCENARIO("Profiling EuclideanVector operations") {
+  WHEN("You take dot products and norms") {
+    ResetProfile();
+    EuclideanVector a{200, 1.5};
+    EuclideanVector b{200, 2.0};
+    double dot = a * b;
+    double norm = a.GetEuclideanNorm();
+    std::vector<OperationProfile> profile = GetProfile();
+    THEN("They are timed only in builds with -DEV_PROFILING") {
+      REQUIRE(dot == 600);
+      REQUIRE(norm == Approx(std::sqrt(450.0)));
+#ifdef EV_PROFILING
+      REQUIRE(Find(profile, EvOperation::kDot, 200)->latency.count == 1);
+      REQUIRE(Find(profile, EvOperation::kNorm, 200)->latency.count == 1);
+#else
+      REQUIRE(profile.empty());
+#endif
+    }
+  }
+}
@@ -0,0 +1,91 @@
+#include "assignments/ev/euclidean_vector_stats.h"
+
+#include <atomic>
+#include <sstream>
+
+namespace {
+
+// Relaxed ordering is enough: counters are independent and only read as a best-effort snapshot
+std::array<std::atomic<std::uint64_t>, kNumEvCounters> g_events{};
+std::array<std::atomic<std::uint64_t>, kNumEvOperations> g_calls{};
+std::array<std::atomic<std::uint64_t>, kNumEvOperations> g_bytes{};
+
+constexpr const char* kCounterNames[kNumEvCounters] = {
+  "fill_construct", "range_construct", "copy_construct", "move_construct",
+  "copy_assign", "move_assign", "allocation", "bytes_allocated",
+};
+
+constexpr const char* kOperationNames[kNumEvOperations] = {
+  "at", "subscript", "norm", "unit_vector", "add_assign", "subtract_assign",
+  "multiply_assign", "divide_assign", "to_vector", "to_list", "equal", "not_equal",
+  "add", "subtract", "dot", "scale", "divide", "output",
+};
+
+}  // namespace
+
+const char* ToString(EvCounter c) noexcept {
+  return kCounterNames[static_cast<std::size_t>(c)];
+}
+
+const char* ToString(EvOperation op) noexcept {
+  return kOperationNames[static_cast<std::size_t>(op)];
+}
+
+EuclideanVectorStats GetEuclideanVectorStats() noexcept {
+  EuclideanVectorStats stats{};
+#ifdef EV_INSTRUMENTATION
+  stats.enabled = true;
+#endif
+  for (std::size_t i = 0; i < kNumEvCounters; ++i) {
+    stats.events[i] = g_events[i].load(std::memory_order_relaxed);
+  }
+  for (std::size_t i = 0; i < kNumEvOperations; ++i) {
+    stats.calls[i] = g_calls[i].load(std::memory_order_relaxed);
+    stats.bytes[i] = g_bytes[i].load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void ResetEuclideanVectorStats() noexcept {
+  for (auto& c : g_events) {
+    c.store(0, std::memory_order_relaxed);
+  }
+  for (std::size_t i = 0; i < kNumEvOperations; ++i) {
+    g_calls[i].store(0, std::memory_order_relaxed);
+    g_bytes[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+// Operations that were never called are left out to keep dumps short
+std::string ToJson(const EuclideanVectorStats& stats) {
+  std::ostringstream os;
+  os << "{\"enabled\":" << (stats.enabled ? "true" : "false") << ",\"events\":{";
+  for (std::size_t i = 0; i < kNumEvCounters; ++i) {
+    os << (i == 0 ? "" : ",") << '"' << kCounterNames[i] << "\":" << stats.events[i];
+  }
+  os << "},\"operations\":{";
+  bool first = true;
+  for (std::size_t i = 0; i < kNumEvOperations; ++i) {
+    if (stats.calls[i] == 0) {
+      continue;
+    }
+    os << (first ? "" : ",") << '"' << kOperationNames[i] << "\":{\"calls\":" << stats.calls[i]
+       << ",\"bytes\":" << stats.bytes[i] << '}';
+    first = false;
+  }
+  os << "}}";
+  return os.str();
+}
+
+void DumpEuclideanVectorStats(std::ostream& os) {
+  os << ToJson(GetEuclideanVectorStats()) << '\n';
+}
+
+void RecordEuclideanVectorEvent(EvCounter c, std::uint64_t amount) noexcept {
+  g_events[static_cast<std::size_t>(c)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void RecordEuclideanVectorOperation(EvOperation op, std::uint64_t bytes) noexcept {
+  g_calls[static_cast<std::size_t>(op)].fetch_add(1, std::memory_order_relaxed);
+  g_bytes[static_cast<std::size_t>(op)].fetch_add(bytes, std::memory_order_relaxed);
+}
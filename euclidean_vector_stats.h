@@ -0,0 +1,88 @@
+#ifndef ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_STATS_H_
+#define ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_STATS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Opt-in instrumentation of EuclideanVector.
+//  Build with -DEV_INSTRUMENTATION to count constructions, assignments, allocations and operator
+//  calls. Without it the recording macros expand to nothing and every snapshot reads as zero, so
+//  the API can be left in place in production code.
+
+// Lifetime events of EuclideanVector objects and their buffers
+enum class EvCounter {
+  kFillConstruct,   // EuclideanVector(int) / EuclideanVector(int, double)
+  kRangeConstruct,  // EuclideanVector(start_it, end_it)
+  kCopyConstruct,
+  kMoveConstruct,
+  kCopyAssign,
+  kMoveAssign,
+  kAllocation,      // magnitude buffers allocated
+  kBytesAllocated,  // bytes in those buffers
+  kCount
+};
+
+// Operations on EuclideanVector magnitudes
+enum class EvOperation {
+  kAt,
+  kSubscript,
+  kNorm,
+  kUnitVector,
+  kAddAssign,
+  kSubtractAssign,
+  kMultiplyAssign,
+  kDivideAssign,
+  kToVector,
+  kToList,
+  kEqual,
+  kNotEqual,
+  kAdd,
+  kSubtract,
+  kDot,
+  kScale,
+  kDivide,
+  kOutput,
+  kCount
+};
+
+constexpr std::size_t kNumEvCounters = static_cast<std::size_t>(EvCounter::kCount);
+constexpr std::size_t kNumEvOperations = static_cast<std::size_t>(EvOperation::kCount);
+
+// A point-in-time copy of every counter
+struct EuclideanVectorStats {
+  bool enabled;  // false when built without EV_INSTRUMENTATION
+  std::array<std::uint64_t, kNumEvCounters> events;
+  std::array<std::uint64_t, kNumEvOperations> calls;
+  std::array<std::uint64_t, kNumEvOperations> bytes;  // magnitude bytes read plus written
+
+  std::uint64_t Get(EvCounter c) const noexcept { return events[static_cast<std::size_t>(c)]; }
+  std::uint64_t Calls(EvOperation op) const noexcept { return calls[static_cast<std::size_t>(op)]; }
+  std::uint64_t Bytes(EvOperation op) const noexcept { return bytes[static_cast<std::size_t>(op)]; }
+};
+
+const char* ToString(EvCounter c) noexcept;
+const char* ToString(EvOperation op) noexcept;
+
+// Snapshot of the counters (safe to call while other threads are recording)
+EuclideanVectorStats GetEuclideanVectorStats() noexcept;
+void ResetEuclideanVectorStats() noexcept;
+
+// Writes stats as a JSON object: {"enabled":..,"events":{..},"operations":{"add":{"calls":..,..}}}
+std::string ToJson(const EuclideanVectorStats& stats);
+void DumpEuclideanVectorStats(std::ostream& os);
+
+void RecordEuclideanVectorEvent(EvCounter c, std::uint64_t amount) noexcept;
+void RecordEuclideanVectorOperation(EvOperation op, std::uint64_t bytes) noexcept;
+
+#ifdef EV_INSTRUMENTATION
+#define EV_RECORD_EVENT(counter, amount) RecordEuclideanVectorEvent(EvCounter::counter, (amount))
+#define EV_RECORD_OPERATION(op, bytes) RecordEuclideanVectorOperation(EvOperation::op, (bytes))
+#else
+#define EV_RECORD_EVENT(counter, amount) static_cast<void>(0)
+#define EV_RECORD_OPERATION(op, bytes) static_cast<void>(0)
+#endif
+
+#endif  // ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_STATS_H_
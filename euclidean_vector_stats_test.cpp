@@ -0,0 +1,76 @@
+/*
+
+  == Explanation and rational of testing ==
+  The counters only move when the library is built with -DEV_INSTRUMENTATION, so every scenario
+  checks stats.enabled first: in a default build the snapshot must read as all zeros, in an
+  instrumented build the exact counts are checked. Each scenario resets the counters first so the
+  order the tests run in does not matter.
+
+*/
+
+#include "assignments/ev/euclidean_vector_stats.h"
+
+#include "assignments/ev/euclidean_vector.h"
+#include "catch.h"
+
+SCENARIO("Counting constructions and allocations") {
+  WHEN("You create vectors with each constructor") {
+    ResetEuclideanVectorStats();
+    std::vector<double> v{1, 2, 3};
+    EuclideanVector a{3};
+    EuclideanVector b{v.begin(), v.end()};
+    EuclideanVector c{b};
+    EuclideanVector d{std::move(c)};
+
+    THEN("Each kind of construction and allocation is counted") {
+      EuclideanVectorStats stats = GetEuclideanVectorStats();
+      if (stats.enabled) {
+        REQUIRE(stats.Get(EvCounter::kFillConstruct) == 1);
+        REQUIRE(stats.Get(EvCounter::kRangeConstruct) == 1);
+        REQUIRE(stats.Get(EvCounter::kCopyConstruct) == 1);
+        REQUIRE(stats.Get(EvCounter::kMoveConstruct) == 1);
+        REQUIRE(stats.Get(EvCounter::kAllocation) == 3);
+        REQUIRE(stats.Get(EvCounter::kBytesAllocated) == 9 * sizeof(double));
+      } else {
+        REQUIRE(stats.Get(EvCounter::kAllocation) == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("Counting operator calls and bytes touched") {
+  WHEN("You add two vectors") {
+    EuclideanVector a{4, 1};
+    EuclideanVector b{4, 2};
+    ResetEuclideanVectorStats();
+    a += b;
+    a += b;
+
+    THEN("The calls and the bytes read and written are counted") {
+      EuclideanVectorStats stats = GetEuclideanVectorStats();
+      if (stats.enabled) {
+        REQUIRE(stats.Calls(EvOperation::kAddAssign) == 2);
+        REQUIRE(stats.Bytes(EvOperation::kAddAssign) == 2 * 3 * 4 * sizeof(double));
+        REQUIRE(stats.Calls(EvOperation::kDot) == 0);
+      } else {
+        REQUIRE(stats.Calls(EvOperation::kAddAssign) == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("Resetting and dumping the counters") {
+  WHEN("You reset the counters") {
+    EuclideanVector a{2};
+    a = EuclideanVector{2, 1};
+    ResetEuclideanVectorStats();
+
+    THEN("Every counter reads zero and the JSON dump has no operations") {
+      EuclideanVectorStats stats = GetEuclideanVectorStats();
+      REQUIRE(stats.Get(EvCounter::kMoveAssign) == 0);
+      std::string json = ToJson(stats);
+      REQUIRE(json.find("\"move_assign\":0") != std::string::npos);
+      REQUIRE(json.find("\"operations\":{}") != std::string::npos);
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include "assignments/ev/euclidean_vector_status.h"
+
+#include "assignments/ev/vector_kernels.h"
+
+/* METHODS */
+// Formats the message the throwing operations use for the same failure
+std::string Status::GetMessage() const {
+  switch (this->code_) {
+    case ErrorCode::kOk:
+      return "";
+    case ErrorCode::kDimensionMismatch:
+      return "Dimensions of LHS(" + std::to_string(this->lhs_) + ") and RHS(" +
+             std::to_string(this->rhs_) + ") do not match";
+    case ErrorCode::kIndexOutOfRange:
+      // No vector reaches PTRDIFF_MAX dimensions, so larger indices can only be negative ints
+      //  converted to std::size_t; print them as the caller wrote them
+      return "Index " + std::to_string(static_cast<std::ptrdiff_t>(this->lhs_)) +
+             " is not valid for this EuclideanVector object";
+    case ErrorCode::kDivisionByZero:
+      return "Invalid vector division by 0";
+    case ErrorCode::kNoValue:
+      return "Expected holds no value";
+  }
+  return "Unknown error";
+}
+
+// Kept out of line so ThrowIfError inlines to a single compare at every call site
+void Status::Throw() const {
+  throw EuclideanVectorError(this->GetMessage());
+}
+
+/* FUNCTIONS */
+Status CheckDimensions(const EuclideanVector& a, const EuclideanVector& b) noexcept {
+  if (a.GetNumDimensions() != b.GetNumDimensions()) {
+    return Status(ErrorCode::kDimensionMismatch, a.GetNumDimensions(), b.GetNumDimensions());
+  }
+  return Status();
+}
+
+Status CheckIndex(const EuclideanVector& v, std::size_t i) noexcept {
+  if (i >= v.GetNumDimensions()) {
+    return Status(ErrorCode::kIndexOutOfRange, i, v.GetNumDimensions());
+  }
+  return Status();
+}
+
+Status TryAdd(EuclideanVector& lhs, const EuclideanVector& rhs) noexcept {
+  Status status = CheckDimensions(lhs, rhs);
+  if (status.ok()) {
+    AddMagnitudes(lhs.data(), rhs.data(), lhs.data(), lhs.GetNumDimensions());
+  }
+  return status;
+}
+
+Status TrySubtract(EuclideanVector& lhs, const EuclideanVector& rhs) noexcept {
+  Status status = CheckDimensions(lhs, rhs);
+  if (status.ok()) {
+    SubtractMagnitudes(lhs.data(), rhs.data(), lhs.data(), lhs.GetNumDimensions());
+  }
+  return status;
+}
+
+Status TryDivide(EuclideanVector& lhs, double n) noexcept {
+  if (n == 0) {
+    return Status(ErrorCode::kDivisionByZero);
+  }
+  double* magnitudes = lhs.data();
+  for (std::size_t i = 0; i < lhs.GetNumDimensions(); ++i) {
+    magnitudes[i] /= n;
+  }
+  return Status();
+}
+
+Expected<double> TryDot(const EuclideanVector& a, const EuclideanVector& b) noexcept {
+  Status status = CheckDimensions(a, b);
+  if (!status.ok()) {
+    return status;
+  }
+  return Dot(a.data(), b.data(), a.GetNumDimensions());
+}
+
+Expected<double> TryAt(const EuclideanVector& v, std::size_t i) noexcept {
+  Status status = CheckIndex(v, i);
+  if (!status.ok()) {
+    return status;
+  }
+  return v.data()[i];
+}
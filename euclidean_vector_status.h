@@ -0,0 +1,95 @@
+#ifndef ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_STATUS_H_
+#define ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_STATUS_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "assignments/ev/euclidean_vector.h"
+
+// No-throw versions of the EuclideanVector operations that can fail.
+//  They return a Status (or an Expected value) instead of throwing. A Status is a code plus the
+//  two sizes its message needs, so checking one never allocates; the message is only formatted
+//  when GetMessage is called, and is the same text the throwing operations use.
+
+// Why an operation failed
+//  kDimensionMismatch - the operands' dimensions differ
+//  kIndexOutOfRange   - an index is outside the vector
+//  kDivisionByZero    - a vector was divided by 0
+//  kNoValue           - an Expected was made from an ok Status, so it has neither value nor error
+enum class ErrorCode { kOk, kDimensionMismatch, kIndexOutOfRange, kDivisionByZero, kNoValue };
+
+class Status {
+ public:
+  /* CONSTRUCTORS */
+  Status() noexcept = default;  // ok
+  // lhs and rhs are the two dimensions for kDimensionMismatch, or the index and the dimensions
+  //  for kIndexOutOfRange
+  explicit Status(ErrorCode code, std::size_t lhs = 0, std::size_t rhs = 0) noexcept
+    : code_(code), lhs_(lhs), rhs_(rhs) {}
+
+  /* METHODS */
+  bool ok() const noexcept { return this->code_ == ErrorCode::kOk; }
+  ErrorCode GetCode() const noexcept { return this->code_; }
+  std::string GetMessage() const;  // empty when ok
+  void ThrowIfError() const {      // throws EuclideanVectorError with GetMessage()
+    if (!this->ok()) {
+      this->Throw();
+    }
+  }
+
+ private:
+  [[noreturn]] void Throw() const;
+
+  ErrorCode code_ = ErrorCode::kOk;
+  std::size_t lhs_ = 0;
+  std::size_t rhs_ = 0;
+};
+
+// Either a value or the Status saying why there is none
+template <typename T>
+class Expected {
+ public:
+  /* CONSTRUCTORS */
+  Expected(T value) noexcept(std::is_nothrow_move_constructible<T>::value)
+    : value_(std::move(value)) {}
+  // status should be a failure; an ok one is replaced by kNoValue so value() still throws
+  Expected(Status status) noexcept
+    : status_(status.ok() ? Status(ErrorCode::kNoValue) : status) {}
+
+  /* METHODS */
+  bool ok() const noexcept { return this->status_.ok(); }
+  const Status& GetStatus() const noexcept { return this->status_; }
+  // The value; throws EuclideanVectorError if there is none
+  const T& value() const& {
+    this->status_.ThrowIfError();
+    return *this->value_;
+  }
+  T& value() & {
+    this->status_.ThrowIfError();
+    return *this->value_;
+  }
+  T value_or(T fallback) const& { return this->ok() ? *this->value_ : std::move(fallback); }
+
+ private:
+  Status status_;
+  std::optional<T> value_;
+};
+
+/* FUNCTIONS */
+// Ok if a and b have the same dimensions
+Status CheckDimensions(const EuclideanVector& a, const EuclideanVector& b) noexcept;
+// Ok if i is a valid index into v
+Status CheckIndex(const EuclideanVector& v, std::size_t i) noexcept;
+
+// In place like +=, -= and /=; lhs is left unchanged on failure
+Status TryAdd(EuclideanVector& lhs, const EuclideanVector& rhs) noexcept;
+Status TrySubtract(EuclideanVector& lhs, const EuclideanVector& rhs) noexcept;
+Status TryDivide(EuclideanVector& lhs, double n) noexcept;
+
+Expected<double> TryDot(const EuclideanVector& a, const EuclideanVector& b) noexcept;
+Expected<double> TryAt(const EuclideanVector& v, std::size_t i) noexcept;
+
+#endif  // ASSIGNMENTS_EV_EUCLIDEAN_VECTOR_STATUS_H_
@@ -0,0 +1,111 @@
+/*
+
+  == Explanation and rational of testing ==
+  Each no-throw operation is run once where it succeeds, comparing against the throwing operator,
+  and once where it fails, checking that the operand is unchanged and that the Status carries the
+  same message the throwing operator uses. Expected is checked for both its states, and the
+  throwing operators are checked to now throw EuclideanVectorError rather than a raw string.
+
+*/
+
+#include "assignments/ev/euclidean_vector_status.h"
+
+#include <vector>
+
+#include "catch.h"
+
+namespace {
+
+EuclideanVector Make(std::vector<double> magnitudes) {
+  return EuclideanVector(magnitudes.cbegin(), magnitudes.cend());
+}
+
+}  // namespace
+
+SCENARIO("No-throw operations that succeed") {
+  WHEN("You add, subtract, divide, dot and read vectors of matching dimensions") {
+    EuclideanVector a = Make({1, 2, 3});
+    EuclideanVector b = Make({0.5, -1, 4});
+    EuclideanVector sum = a;
+    EuclideanVector difference = a;
+    EuclideanVector quotient = a;
+    Status added = TryAdd(sum, b);
+    Status subtracted = TrySubtract(difference, b);
+    Status divided = TryDivide(quotient, 4);
+    Expected<double> dot = TryDot(a, b);
+    Expected<double> at = TryAt(a, 2);
+    THEN("Every status is ok and the results match the throwing operators") {
+      REQUIRE(added.ok());
+      REQUIRE(subtracted.ok());
+      REQUIRE(divided.ok());
+      REQUIRE(added.GetCode() == ErrorCode::kOk);
+      REQUIRE(added.GetMessage().empty());
+      REQUIRE(sum == a + b);
+      REQUIRE(difference == a - b);
+      REQUIRE(quotient == a / 4);
+      REQUIRE(dot.ok());
+      REQUIRE(dot.value() == a * b);
+      REQUIRE(at.value() == 3);
+      REQUIRE(CheckDimensions(a, b).ok());
+      REQUIRE(CheckIndex(a, 0).ok());
+    }
+  }
+}
+
+SCENARIO("No-throw operations that fail") {
+  WHEN("You combine vectors of different dimensions") {
+    EuclideanVector a = Make({1, 2, 3});
+    EuclideanVector b = Make({1, 2});
+    Status added = TryAdd(a, b);
+    Status subtracted = TrySubtract(a, b);
+    Expected<double> dot = TryDot(a, b);
+    THEN("The status reports the mismatch and the operand is unchanged") {
+      REQUIRE_FALSE(added.ok());
+      REQUIRE(added.GetCode() == ErrorCode::kDimensionMismatch);
+      REQUIRE(added.GetMessage() == "Dimensions of LHS(3) and RHS(2) do not match");
+      REQUIRE(subtracted.GetCode() == ErrorCode::kDimensionMismatch);
+      REQUIRE(a == Make({1, 2, 3}));
+      REQUIRE_FALSE(dot.ok());
+      REQUIRE(dot.GetStatus().GetCode() == ErrorCode::kDimensionMismatch);
+      REQUIRE(dot.value_or(-1) == -1);
+    }
+  }
+  WHEN("You read outside the vector or divide by 0") {
+    EuclideanVector a = Make({1, 2});
+    Expected<double> below = TryAt(a, -1);
+    Expected<double> above = TryAt(a, 2);
+    Status divided = TryDivide(a, 0);
+    THEN("The status reports it with the throwing operators' message") {
+      REQUIRE(below.GetStatus().GetMessage() ==
+              "Index -1 is not valid for this EuclideanVector object");
+      REQUIRE(above.GetStatus().GetCode() == ErrorCode::kIndexOutOfRange);
+      REQUIRE(divided.GetCode() == ErrorCode::kDivisionByZero);
+      REQUIRE(divided.GetMessage() == "Invalid vector division by 0");
+      REQUIRE(a == Make({1, 2}));
+    }
+  }
+}
+
+// EXCEPTION - Failed statuses and the throwing operators throw EuclideanVectorError
+SCENARIO("Converting failures to exceptions") {
+  WHEN("You throw from a failed status or read the value of an empty Expected") {
+    EuclideanVector a = Make({1, 2, 3});
+    EuclideanVector b = Make({1});
+    THEN("EuclideanVectorError is thrown with the same message") {
+      REQUIRE_NOTHROW(CheckDimensions(a, a).ThrowIfError());
+      REQUIRE_THROWS_WITH(CheckDimensions(a, b).ThrowIfError(),
+                          "Dimensions of LHS(3) and RHS(1) do not match");
+      REQUIRE_THROWS_WITH(TryAt(a, 3).value(),
+                          "Index 3 is not valid for this EuclideanVector object");
+      Expected<double> from_ok{Status()};
+      REQUIRE_FALSE(from_ok.ok());
+      REQUIRE(from_ok.GetStatus().GetCode() == ErrorCode::kNoValue);
+      REQUIRE(from_ok.value_or(4) == 4);
+      REQUIRE_THROWS_WITH(from_ok.value(), "Expected holds no value");
+      REQUIRE_THROWS_AS(a + b, EuclideanVectorError);
+      REQUIRE_THROWS_AS(a / 0, EuclideanVectorError);
+      REQUIRE_THROWS_AS(EuclideanVector(0).GetEuclideanNorm(), EuclideanVectorError);
+      REQUIRE_THROWS_AS(a.GetLpNorm(0.5), EuclideanVectorError);
+    }
+  }
+}
@@ -44,6 +44,10 @@
 */
 
 #include "assignments/ev/euclidean_vector.h"
+
+#include <limits>
+#include <unordered_set>
+
 #include "catch.h"
 
 /*
@@ -257,6 +261,72 @@ SCENARIO("Getting Euclidean Norm of a vector with no dimensions nor norm") {
   }
 }
 
+SCENARIO("Euclidean norm of vectors with extreme magnitudes") {
+  WHEN("You create vectors whose squares overflow or underflow") {
+    EuclideanVector huge{4, 1e200};
+    EuclideanVector tiny{4, 1e-200};
+
+    THEN("The fast norm fails but the scaled norm is exact") {
+      REQUIRE(std::isinf(huge.GetEuclideanNorm()));
+      REQUIRE(tiny.GetEuclideanNorm() == 0);
+      REQUIRE(huge.GetEuclideanNorm(NormMode::kScaled) == Approx(2e200));
+      REQUIRE(tiny.GetEuclideanNorm(NormMode::kScaled) == Approx(2e-200));
+    }
+  }
+
+  WHEN("You create a vector whose squares cancel badly when summed naively") {
+    std::vector<double> v{1e8, 1, 1, 1, 1};
+    EuclideanVector a{v.begin(), v.end()};
+
+    THEN("Every mode agrees with the exact answer to double precision") {
+      double exact = std::sqrt(1e16 + 4);
+      REQUIRE(a.GetEuclideanNorm(NormMode::kCompensated) == exact);
+      REQUIRE(a.GetEuclideanNorm(NormMode::kScaled) == Approx(exact));
+      REQUIRE(a.GetEuclideanNorm(NormMode::kFast) == Approx(exact));
+    }
+  }
+
+  WHEN("You create vectors with more than one infinite magnitude") {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> v{inf, -inf, 1};
+    std::vector<double> w{std::nan(""), inf};
+    EuclideanVector a{v.begin(), v.end()};
+    EuclideanVector b{w.begin(), w.end()};
+
+    THEN("The scaled and Lp norms are +inf rather than NaN") {
+      REQUIRE(a.GetEuclideanNorm(NormMode::kScaled) == inf);
+      REQUIRE(b.GetEuclideanNorm(NormMode::kScaled) == inf);
+      REQUIRE(a.GetLpNorm(2) == inf);
+      REQUIRE(a.GetLpNorm(3) == inf);
+    }
+  }
+}
+
+SCENARIO("L1, L-infinity and Lp norms") {
+  WHEN("You create a vector") {
+    std::vector<double> v{3, -4, 12};
+    EuclideanVector a{v.begin(), v.end()};
+
+    THEN("Each norm matches its definition") {
+      REQUIRE(a.GetL1Norm() == 19);
+      REQUIRE(a.GetInfinityNorm() == 12);
+      REQUIRE(a.GetLpNorm(2) == Approx(13));
+      REQUIRE(a.GetLpNorm(3) == Approx(std::cbrt(27 + 64 + 1728)));
+    }
+  }
+}
+
+// EXCEPTION - p < 1
+SCENARIO("Lp norm with p below 1") {
+  WHEN("You create a vector") {
+    EuclideanVector a{3, 1};
+
+    THEN("Asking for the L0.5 norm returns exception error") {
+      REQUIRE_THROWS_WITH(a.GetLpNorm(0.5), "Lp norm is only defined for p >= 1");
+    }
+  }
+}
+
 /* at (getter method) */
 SCENARIO("Accessing a specific magnitude in a dimension of the vector") {
   WHEN("You create a non-empty vector") {
@@ -344,6 +414,65 @@ SCENARIO("Copy assignment of a vector") {
   }
 }
 
+SCENARIO("Copy assignment into a vector with enough capacity") {
+  WHEN("You create a large vector and a smaller one") {
+    EuclideanVector a{5, 2};
+    std::vector<double> v{-1, 4};
+    EuclideanVector b{v.begin(), v.end()};
+    const double* buffer = a.data();
+
+    THEN("Copying the smaller vector into the larger one keeps the same buffer") {
+      a = b;
+      REQUIRE(a == b);
+      REQUIRE(a.GetNumDimensions() == 2);
+      REQUIRE(a.GetCapacity() == 5);
+      REQUIRE(a.data() == buffer);
+    }
+  }
+}
+
+SCENARIO("Self copy assignment of a vector") {
+  WHEN("You create a vector") {
+    std::vector<double> v{3, 1, 4};
+    EuclideanVector a{v.begin(), v.end()};
+    EuclideanVector& alias = a;
+
+    THEN("Copying it onto itself leaves it unchanged") {
+      a = alias;
+      REQUIRE(a.GetNumDimensions() == 3);
+      REQUIRE(a[2] == 4);
+    }
+  }
+}
+
+/* Assign / Reserve */
+SCENARIO("Refilling a vector from a range") {
+  WHEN("You reserve capacity for a vector") {
+    EuclideanVector a{2, 1};
+    a.Reserve(4);
+    const double* buffer = a.data();
+
+    REQUIRE(a.GetCapacity() == 4);
+    REQUIRE(a.GetNumDimensions() == 2);
+    REQUIRE(a[1] == 1);
+
+    THEN("Assigning ranges that fit reuses the buffer") {
+      std::list<double> l{7, 8, 9};
+      a.Assign(l.begin(), l.end());
+      REQUIRE(a.GetNumDimensions() == 3);
+      REQUIRE(a[0] == 7);
+      REQUIRE(a[2] == 9);
+      REQUIRE(a.data() == buffer);
+
+      std::vector<double> v{1, 2, 3, 4, 5};
+      a.Assign(v.begin(), v.end());
+      REQUIRE(a.GetNumDimensions() == 5);
+      REQUIRE(a.GetCapacity() == 5);
+      REQUIRE(a[4] == 5);
+    }
+  }
+}
+
 /* Move Assignment */
 SCENARIO("Move assignment of a vector") {
   WHEN("You create two vectors") {
@@ -784,6 +913,75 @@ SCENARIO("Displaying vectors in text form") {
   }
 }
 
+/* ApproxEqual */
+SCENARIO("Comparing vectors within a tolerance") {
+  WHEN("You create two vectors that differ by rounding error") {
+    std::vector<double> v1{0.1 + 0.2, 1e6, -3};
+    std::vector<double> v2{0.3, 1e6 + 1e-7, -3};
+    EuclideanVector a{v1.begin(), v1.end()};
+    EuclideanVector b{v2.begin(), v2.end()};
+
+    REQUIRE(a != b);
+
+    THEN("They are approximately equal but not under a zero tolerance") {
+      REQUIRE(ApproxEqual(a, b));
+      REQUIRE(ApproxEqual(a, b, 1e-6, 0, 0));
+      REQUIRE_FALSE(ApproxEqual(a, b, 0, 0, 0));
+      REQUIRE_FALSE(ApproxEqual(a, b, 0, 0, 1));
+    }
+  }
+
+  WHEN("You create vectors with a NaN or different dimensions") {
+    EuclideanVector a{2, std::nan("")};
+    EuclideanVector b{3, 1};
+
+    THEN("They are never approximately equal") {
+      REQUIRE_FALSE(ApproxEqual(a, a, 1, 1, 100));
+      REQUIRE_FALSE(ApproxEqual(b, EuclideanVector{2, 1}, 1, 1, 100));
+    }
+  }
+
+  WHEN("You create vectors with infinite magnitudes") {
+    const double inf = std::numeric_limits<double>::infinity();
+    EuclideanVector plus{1, inf};
+    EuclideanVector minus{1, -inf};
+    EuclideanVector one{1, 1.0};
+    EuclideanVector largest{1, std::numeric_limits<double>::max()};
+
+    THEN("An infinity is only approximately equal to the same infinity") {
+      REQUIRE(ApproxEqual(plus, plus));
+      REQUIRE_FALSE(ApproxEqual(plus, one));
+      REQUIRE_FALSE(ApproxEqual(one, minus, 1, 1, 100));
+      REQUIRE_FALSE(ApproxEqual(plus, minus, 1, 1, 100));
+      REQUIRE_FALSE(ApproxEqual(largest, plus, 0, 0, 100));
+    }
+  }
+}
+
+/* Hash */
+SCENARIO("Hashing vectors") {
+  WHEN("You create equal vectors in different ways, including a negative zero") {
+    std::vector<double> v{-0.0, 2.5, 7, 1, 9};
+    EuclideanVector a{v.begin(), v.end()};
+    EuclideanVector b{5};
+    b[1] = 2.5;
+    b[2] = 7;
+    b[3] = 1;
+    b[4] = 9;
+
+    REQUIRE(a == b);
+
+    THEN("They hash equally and a hash set keeps one copy") {
+      REQUIRE(Hash(a) == Hash(b));
+      REQUIRE(Hash(a) != Hash(EuclideanVector{5}));
+      REQUIRE(Hash(EuclideanVector{2}) != Hash(EuclideanVector{3}));
+
+      std::unordered_set<EuclideanVector> unique{a, b, EuclideanVector{5}};
+      REQUIRE(unique.size() == 2);
+    }
+  }
+}
+
 /*
  * Combination cases:
  *  Multiple methods/operators are used in each of these scenarios
@@ -0,0 +1,432 @@
+#include "assignments/ev/hnsw_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'H', 'N', 'S', 'W'};
+constexpr std::uint32_t kVersion = 1;
+
+// Highest level a loaded index may have: RandomLevel cannot exceed -ln(2^-53) / ln(2) = 53
+constexpr int kMaxLevel = 64;
+
+// Elements reserved up front when loading; sizes come from the stream, so beyond this storage
+//  only grows as data is actually read
+constexpr std::uint64_t kMaxLoadReserve = std::uint64_t{1} << 16;
+
+template <typename T>
+void Write(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T Read(std::istream& is) {
+  T value{};
+  if (!is.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw EuclideanVectorError("HnswIndex stream ended unexpectedly");
+  }
+  return value;
+}
+
+// Nodes seen by the current SearchLayer call on this thread. A node is marked with the epoch of
+//  the call that last visited it, so starting a call bumps the epoch instead of clearing a flag per
+//  node, which would make every greedy step of a query cost O(size of the index).
+class VisitedList {
+ public:
+  // Starts a search over an index of n nodes
+  void Reset(std::size_t n) {
+    if (this->marks_.size() < n) {
+      this->marks_.resize(n, 0);
+    }
+    if (++this->epoch_ == 0) {
+      std::fill(this->marks_.begin(), this->marks_.end(), 0);
+      this->epoch_ = 1;
+    }
+  }
+
+  // Marks id as visited, returning false if it already was
+  bool Visit(std::uint32_t id) noexcept {
+    if (this->marks_[id] == this->epoch_) {
+      return false;
+    }
+    this->marks_[id] = this->epoch_;
+    return true;
+  }
+
+ private:
+  std::vector<std::uint32_t> marks_;
+  std::uint32_t epoch_ = 0;
+};
+
+// One list per thread, shared by every index the thread searches, so concurrent searches of one
+//  index do not contend
+VisitedList& LocalVisitedList() {
+  thread_local VisitedList visited;
+  return visited;
+}
+
+// num_dimensions, checked before it sizes the row storage: rows of no dimensions would leave
+//  Row(id) pointing into an empty buffer
+int IndexDimensions(int num_dimensions) {
+  if (num_dimensions < 1) {
+    throw EuclideanVectorError("HnswIndex needs num_dimensions >= 1");
+  }
+  return num_dimensions;
+}
+
+}  // namespace
+
+/* CONSTRUCTORS */
+// Creates an empty index for vectors with num_dimensions dimensions
+HnswIndex::HnswIndex(int num_dimensions, HnswParams params)
+  : params_{params}, level_mult_{0}, data_{IndexDimensions(num_dimensions)}, entry_point_{0},
+    max_level_{-1}, rng_{params.seed} {
+  if (params.m < 2 || params.ef_construction < 1 || params.ef_search < 1) {
+    throw EuclideanVectorError("HnswIndex needs m >= 2, ef_construction >= 1 and ef_search >= 1");
+  }
+  this->level_mult_ = 1 / std::log(static_cast<double>(params.m));
+}
+
+// Moves index o into a new index (o is locked while its state is taken)
+HnswIndex::HnswIndex(HnswIndex&& o) noexcept
+  : params_{o.params_}, level_mult_{o.level_mult_}, data_{o.GetNumDimensions()} {
+  std::unique_lock lock{o.mutex_};
+  this->data_ = std::move(o.data_);
+  this->links_ = std::move(o.links_);
+  this->entry_point_ = o.entry_point_;
+  this->max_level_ = o.max_level_;
+  this->rng_ = o.rng_;
+  o.data_.Clear();
+  o.links_.clear();
+  o.max_level_ = -1;
+}
+
+/* METHODS */
+std::size_t HnswIndex::size() const {
+  std::shared_lock lock{this->mutex_};
+  return this->data_.size();
+}
+
+void HnswIndex::SetEfSearch(int ef_search) {
+  if (ef_search < 1) {
+    throw EuclideanVectorError("HnswIndex needs ef_search >= 1");
+  }
+  std::unique_lock lock{this->mutex_};
+  this->params_.ef_search = ef_search;
+}
+
+// Links ev into every layer from its randomly drawn level down to the bottom layer
+std::size_t HnswIndex::Insert(const EuclideanVector& ev) {
+  CheckDimensions(ev);
+  std::unique_lock lock{this->mutex_};
+
+  Id id = static_cast<Id>(this->data_.Add(ev));
+  int level = RandomLevel();
+  try {
+    this->links_.emplace_back(static_cast<std::size_t>(level) + 1);
+  } catch (...) {
+    this->data_.Resize(id);  // every row keeps its links
+    throw;
+  }
+  const double* q = this->data_.Row(id);
+
+  if (this->max_level_ < 0) {
+    this->entry_point_ = id;
+    this->max_level_ = level;
+    return id;
+  }
+
+  // Greedy descent through the layers above the new node's level
+  Id entry = this->entry_point_;
+  for (int l = this->max_level_; l > level; --l) {
+    entry = SearchLayer(q, entry, 1, l).front().second;
+  }
+
+  auto ef = static_cast<std::size_t>(this->params_.ef_construction);
+  for (int l = std::min(level, this->max_level_); l >= 0; --l) {
+    std::vector<Candidate> candidates = SearchLayer(q, entry, ef, l);
+    entry = candidates.front().second;
+
+    std::vector<Id> neighbours = SelectNeighbours(candidates, static_cast<std::size_t>(params_.m));
+    this->links_[id][l] = neighbours;
+
+    // Link back, pruning a neighbour's list once it is over capacity
+    for (Id n : neighbours) {
+      std::vector<Id>& back = this->links_[n][l];
+      back.push_back(id);
+      if (back.size() > MaxLinks(l)) {
+        std::vector<Candidate> pool;
+        pool.reserve(back.size());
+        for (Id b : back) {
+          pool.emplace_back(Distance(this->data_.Row(n), b), b);
+        }
+        std::sort(pool.begin(), pool.end());
+        back = SelectNeighbours(std::move(pool), MaxLinks(l));
+      }
+    }
+  }
+
+  if (level > this->max_level_) {
+    this->entry_point_ = id;
+    this->max_level_ = level;
+  }
+  return id;
+}
+
+// Greedy descent to the bottom layer followed by a best-first search of width ef_search
+std::vector<Neighbour> HnswIndex::Search(const EuclideanVector& query, std::size_t k) const {
+  CheckDimensions(query);
+  std::shared_lock lock{this->mutex_};
+
+  std::vector<Neighbour> result;
+  if (this->max_level_ < 0 || k == 0) {
+    return result;
+  }
+
+  const double* q = query.data();
+  Id entry = this->entry_point_;
+  for (int l = this->max_level_; l > 0; --l) {
+    entry = SearchLayer(q, entry, 1, l).front().second;
+  }
+
+  std::size_t ef = std::max(k, static_cast<std::size_t>(this->params_.ef_search));
+  std::vector<Candidate> candidates = SearchLayer(q, entry, ef, 0);
+  result.reserve(std::min(k, candidates.size()));
+  for (std::size_t i = 0; i < candidates.size() && i < k; ++i) {
+    result.push_back({candidates[i].second, std::sqrt(candidates[i].first)});
+  }
+  return result;
+}
+
+EuclideanVector HnswIndex::Get(std::size_t id) const {
+  std::shared_lock lock{this->mutex_};
+  if (id >= this->data_.size()) {
+    throw EuclideanVectorError("Id " + std::to_string(id) + " is not valid for this HnswIndex");
+  }
+  return this->data_.Get(id);
+}
+
+// Layout: magic, version, params, dimensions, count, entry point, max level, then for each node
+//  its magnitudes followed by its per-level neighbour lists
+void HnswIndex::Save(std::ostream& os) const {
+  std::shared_lock lock{this->mutex_};
+  os.write(kMagic, sizeof(kMagic));
+  Write(os, kVersion);
+  Write(os, static_cast<std::int32_t>(this->params_.m));
+  Write(os, static_cast<std::int32_t>(this->params_.ef_construction));
+  Write(os, static_cast<std::int32_t>(this->params_.ef_search));
+  Write(os, this->params_.seed);
+  Write(os, static_cast<std::int32_t>(GetNumDimensions()));
+  Write(os, static_cast<std::uint64_t>(this->data_.size()));
+  Write(os, this->entry_point_);
+  Write(os, static_cast<std::int32_t>(this->max_level_));
+
+  auto row_bytes = static_cast<std::streamsize>(sizeof(double) * GetNumDimensions());
+  for (std::size_t i = 0; i < this->data_.size(); ++i) {
+    os.write(reinterpret_cast<const char*>(this->data_.Row(i)), row_bytes);
+    Write(os, static_cast<std::uint32_t>(this->links_[i].size()));
+    for (const auto& level : this->links_[i]) {
+      Write(os, static_cast<std::uint32_t>(level.size()));
+      os.write(reinterpret_cast<const char*>(level.data()),
+               static_cast<std::streamsize>(sizeof(Id) * level.size()));
+    }
+  }
+  if (!os) {
+    throw EuclideanVectorError("HnswIndex could not be written");
+  }
+}
+
+void HnswIndex::Save(const std::string& path) const {
+  std::ofstream os{path, std::ios::binary};
+  if (!os) {
+    throw EuclideanVectorError("Could not open " + path + " for writing");
+  }
+  Save(os);
+}
+
+HnswIndex HnswIndex::Load(std::istream& is) {
+  char magic[sizeof(kMagic)];
+  if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic) ||
+      Read<std::uint32_t>(is) != kVersion) {
+    throw EuclideanVectorError("Stream does not hold a HnswIndex");
+  }
+
+  HnswParams params;
+  params.m = Read<std::int32_t>(is);
+  params.ef_construction = Read<std::int32_t>(is);
+  params.ef_search = Read<std::int32_t>(is);
+  params.seed = Read<std::uint32_t>(is);
+  auto num_dimensions = Read<std::int32_t>(is);
+  auto count = Read<std::uint64_t>(is);
+  if (num_dimensions < 1 || count > std::numeric_limits<Id>::max()) {
+    throw EuclideanVectorError("HnswIndex stream has an invalid header");
+  }
+
+  HnswIndex index{num_dimensions, params};
+  index.entry_point_ = Read<Id>(is);
+  index.max_level_ = Read<std::int32_t>(is);
+  if (count == 0 ? index.max_level_ != -1
+                 : index.entry_point_ >= count || index.max_level_ < 0 ||
+                       index.max_level_ > kMaxLevel) {
+    throw EuclideanVectorError("HnswIndex stream has an invalid entry point");
+  }
+
+  std::vector<double> row;
+  row.reserve(std::min(static_cast<std::uint64_t>(num_dimensions), kMaxLoadReserve));
+  index.links_.reserve(std::min(count, kMaxLoadReserve));
+  for (std::uint64_t i = 0; i < count; ++i) {
+    row.clear();
+    for (std::int32_t d = 0; d < num_dimensions; ++d) {
+      row.push_back(Read<double>(is));
+    }
+    index.data_.Add(row.data());
+    auto levels = Read<std::uint32_t>(is);
+    if (levels == 0 || levels > static_cast<std::uint32_t>(index.max_level_) + 1) {
+      throw EuclideanVectorError("HnswIndex stream has a node with an invalid level");
+    }
+    index.links_.emplace_back(levels);
+    for (std::size_t l = 0; l < levels; ++l) {
+      auto size = Read<std::uint32_t>(is);
+      if (size > index.MaxLinks(static_cast<int>(l))) {
+        throw EuclideanVectorError("HnswIndex stream has a node with too many links");
+      }
+      std::vector<Id>& level = index.links_.back()[l];
+      level.reserve(std::min(static_cast<std::uint64_t>(size), kMaxLoadReserve));
+      for (std::uint32_t k = 0; k < size; ++k) {
+        auto n = Read<Id>(is);
+        if (n >= count) {
+          throw EuclideanVectorError("HnswIndex stream has a link to a missing node");
+        }
+        level.push_back(n);
+      }
+    }
+  }
+
+  // Searches walk from the entry point down every level and follow links level by level, so the
+  //  entry point must reach the top and every link must land on a node that has its level
+  if (count > 0 &&
+      index.links_[index.entry_point_].size() != static_cast<std::size_t>(index.max_level_) + 1) {
+    throw EuclideanVectorError("HnswIndex stream has an invalid entry point");
+  }
+  for (const auto& node : index.links_) {
+    for (std::size_t l = 0; l < node.size(); ++l) {
+      for (Id n : node[l]) {
+        if (index.links_[n].size() <= l) {
+          throw EuclideanVectorError("HnswIndex stream has a link to a node without that level");
+        }
+      }
+    }
+  }
+  return index;
+}
+
+HnswIndex HnswIndex::Load(const std::string& path) {
+  std::ifstream is{path, std::ios::binary};
+  if (!is) {
+    throw EuclideanVectorError("Could not open " + path + " for reading");
+  }
+  return Load(is);
+}
+
+/* HELPERS */
+// Draws a level from the exponentially decaying distribution floor(-ln(U) / ln(m))
+int HnswIndex::RandomLevel() {
+  std::uniform_real_distribution<double> uniform{0.0, 1.0};
+  double u = 1.0 - uniform(this->rng_);  // (0, 1]
+  return static_cast<int>(-std::log(u) * this->level_mult_);
+}
+
+std::size_t HnswIndex::MaxLinks(int level) const noexcept {
+  auto m = static_cast<std::size_t>(this->params_.m);
+  return level == 0 ? 2 * m : m;
+}
+
+double HnswIndex::Distance(const double* q, Id id) const noexcept {
+  return SquaredDistance(q, this->data_.Row(id), GetNumDimensions());
+}
+
+// Best-first search of one layer, returning up to ef candidates sorted nearest first
+std::vector<HnswIndex::Candidate>
+HnswIndex::SearchLayer(const double* q, Id entry, std::size_t ef, int level) const {
+  VisitedList& visited = LocalVisitedList();
+  visited.Reset(this->data_.size());
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> frontier;  // min-heap
+  std::priority_queue<Candidate> found;                                              // max-heap
+
+  Candidate start{Distance(q, entry), entry};
+  visited.Visit(entry);
+  frontier.push(start);
+  found.push(start);
+
+  while (!frontier.empty()) {
+    Candidate current = frontier.top();
+    if (current.first > found.top().first && found.size() >= ef) {
+      break;
+    }
+    frontier.pop();
+
+    for (Id n : this->links_[current.second][static_cast<std::size_t>(level)]) {
+      if (!visited.Visit(n)) {
+        continue;
+      }
+      double d = Distance(q, n);
+      if (found.size() < ef || d < found.top().first) {
+        frontier.emplace(d, n);
+        found.emplace(d, n);
+        if (found.size() > ef) {
+          found.pop();
+        }
+      }
+    }
+  }
+
+  std::vector<Candidate> result(found.size());
+  for (auto it = result.rbegin(); it != result.rend(); ++it) {
+    *it = found.top();
+    found.pop();
+  }
+  return result;
+}
+
+// Neighbour selection heuristic: walking candidates nearest first, keep one only if it is closer
+//  to the query than to every neighbour kept so far. This keeps links spread across directions.
+//  Remaining slots are topped up with the nearest discarded candidates.
+std::vector<HnswIndex::Id> HnswIndex::SelectNeighbours(std::vector<Candidate> candidates,
+                                                       std::size_t max) const {
+  std::vector<Id> selected;
+  std::vector<Id> discarded;
+  selected.reserve(max);
+  for (const auto& [d, id] : candidates) {
+    if (selected.size() >= max) {
+      break;
+    }
+    bool keep = true;
+    for (Id s : selected) {
+      if (Distance(this->data_.Row(id), s) < d) {
+        keep = false;
+        break;
+      }
+    }
+    (keep ? selected : discarded).push_back(id);
+  }
+  for (std::size_t i = 0; i < discarded.size() && selected.size() < max; ++i) {
+    selected.push_back(discarded[i]);
+  }
+  return selected;
+}
+
+void HnswIndex::CheckDimensions(const EuclideanVector& ev) const {
+  if (ev.GetNumDimensions() != static_cast<std::size_t>(GetNumDimensions())) {
+    throw EuclideanVectorError("Dimensions of index(" + std::to_string(GetNumDimensions()) +
+                               ") and vector(" + std::to_string(ev.GetNumDimensions()) +
+                               ") do not match");
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef ASSIGNMENTS_EV_HNSW_INDEX_H_
+#define ASSIGNMENTS_EV_HNSW_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// Tuning knobs for HnswIndex
+//  m               - links kept per node on the upper layers (2 * m on the bottom layer)
+//  ef_construction - candidate list size used while inserting
+//  ef_search       - candidate list size used while querying (raised to k if smaller)
+struct HnswParams {
+  int m = 16;
+  int ef_construction = 200;
+  int ef_search = 50;
+  std::uint32_t seed = 100;
+};
+
+// Approximate nearest neighbour index (Hierarchical Navigable Small World graph).
+//  Vectors are inserted one at a time and are identified by their insertion order. Any number of
+//  threads may call Search concurrently; Insert takes an exclusive lock and waits for them.
+class HnswIndex {
+ public:
+  /* CONSTRUCTORS */
+  explicit HnswIndex(int num_dimensions, HnswParams params = HnswParams{});
+  HnswIndex(HnswIndex&& o) noexcept;
+
+  /* METHODS */
+  int GetNumDimensions() const noexcept { return this->data_.GetNumDimensions(); }
+  std::size_t size() const;
+  const HnswParams& GetParams() const noexcept { return this->params_; }
+  void SetEfSearch(int ef_search);
+
+  // Adds ev to the graph and returns its id
+  std::size_t Insert(const EuclideanVector& ev);
+
+  // Returns (up to) the k nearest stored vectors to query, nearest first
+  std::vector<Neighbour> Search(const EuclideanVector& query, std::size_t k) const;
+
+  // Copy of the stored vector with the given id
+  EuclideanVector Get(std::size_t id) const;
+
+  // Binary (de)serialisation
+  void Save(std::ostream& os) const;
+  void Save(const std::string& path) const;
+  static HnswIndex Load(std::istream& is);
+  static HnswIndex Load(const std::string& path);
+
+ private:
+  using Id = std::uint32_t;
+  using Candidate = std::pair<double, Id>;  // (squared distance, id)
+
+  int RandomLevel();
+  std::size_t MaxLinks(int level) const noexcept;
+  double Distance(const double* q, Id id) const noexcept;
+  std::vector<Candidate> SearchLayer(const double* q, Id entry, std::size_t ef, int level) const;
+  std::vector<Id> SelectNeighbours(std::vector<Candidate> candidates, std::size_t max) const;
+  void CheckDimensions(const EuclideanVector& ev) const;
+
+  HnswParams params_;
+  double level_mult_;
+  EuclideanVectorBatch data_;
+  std::vector<std::vector<std::vector<Id>>> links_;  // links_[node][level] = neighbour ids
+  Id entry_point_;
+  int max_level_;
+  std::mt19937 rng_;
+  mutable std::shared_mutex mutex_;
+};
+
+#endif  // ASSIGNMENTS_EV_HNSW_INDEX_H_
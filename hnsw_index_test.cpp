@@ -0,0 +1,272 @@
+/*
+
+  == Explanation and rational of testing ==
+  HNSW is approximate, so apart from the small exact cases the tests compare the index against the
+  exhaustive scan in euclidean_vector_batch.h and require a high recall rather than identical
+  answers. The seed is fixed in HnswParams so the graph (and therefore the recall) is repeatable.
+
+  Serialisation is tested by saving to a string stream, loading it back and checking that the
+  loaded index answers queries exactly like the original. Loading must reject truncated and
+  corrupted streams, including ones whose every field is in range on its own but whose graph
+  would send a search out of bounds, without trusting sizes in the stream for allocations.
+
+*/
+
+#include "assignments/ev/hnsw_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "catch.h"
+
+namespace {
+
+std::vector<EuclideanVector> RandomVectors(std::size_t count, int dims, unsigned seed) {
+  std::mt19937 rng{seed};
+  std::normal_distribution<double> normal{0.0, 1.0};
+  std::vector<EuclideanVector> evs;
+  evs.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    EuclideanVector ev{static_cast<std::size_t>(dims)};
+    for (int j = 0; j < dims; ++j) {
+      ev[j] = normal(rng);
+    }
+    evs.push_back(std::move(ev));
+  }
+  return evs;
+}
+
+template <typename T>
+void Put(std::string& bytes, T value) {
+  bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Overwrites the field at offset in a saved index
+template <typename T>
+std::string Patch(std::string bytes, std::size_t offset, T value) {
+  std::memcpy(&bytes[offset], &value, sizeof(T));
+  return bytes;
+}
+
+// Offsets of the header fields in a saved index
+constexpr std::size_t kDimensionsOffset = 24;
+constexpr std::size_t kCountOffset = 28;
+constexpr std::size_t kEntryPointOffset = 36;
+constexpr std::size_t kMaxLevelOffset = 40;
+constexpr std::size_t kFirstNodeLinksOffset = 56;  // level 0 link count of node 0 below
+
+// A saved index (m = 2) of two 1 dimensional nodes linked to each other on level 0, node 0 also
+//  on level 1 as the entry point. If level1_link, node 0 also links to node 1 on level 1, which
+//  node 1 does not have.
+std::string TwoNodeIndex(bool level1_link) {
+  std::string bytes = "HNSW";
+  Put<std::uint32_t>(bytes, 1);   // version
+  Put<std::int32_t>(bytes, 2);    // m
+  Put<std::int32_t>(bytes, 10);   // ef_construction
+  Put<std::int32_t>(bytes, 10);   // ef_search
+  Put<std::uint32_t>(bytes, 1);   // seed
+  Put<std::int32_t>(bytes, 1);    // dimensions
+  Put<std::uint64_t>(bytes, 2);   // count
+  Put<std::uint32_t>(bytes, 0);   // entry point
+  Put<std::int32_t>(bytes, 1);    // max level
+  Put<double>(bytes, 0.0);        // node 0
+  Put<std::uint32_t>(bytes, 2);
+  Put<std::uint32_t>(bytes, 1);
+  Put<std::uint32_t>(bytes, 1);
+  Put<std::uint32_t>(bytes, level1_link ? 1 : 0);
+  if (level1_link) {
+    Put<std::uint32_t>(bytes, 1);
+  }
+  Put<double>(bytes, 1.0);        // node 1
+  Put<std::uint32_t>(bytes, 1);
+  Put<std::uint32_t>(bytes, 1);
+  Put<std::uint32_t>(bytes, 0);
+  return bytes;
+}
+
+HnswIndex LoadBytes(const std::string& bytes) {
+  std::stringstream ss{bytes};
+  return HnswIndex::Load(ss);
+}
+
+}  // namespace
+
+SCENARIO("Searching an empty index") {
+  WHEN("You create an index without inserting anything") {
+    HnswIndex index{4};
+
+    THEN("Searching returns no neighbours") {
+      REQUIRE(index.size() == 0);
+      REQUIRE(index.Search(EuclideanVector{4}, 5).empty());
+    }
+  }
+}
+
+SCENARIO("Finding an inserted vector") {
+  WHEN("You insert a few vectors") {
+    HnswIndex index{3};
+    std::vector<EuclideanVector> evs = RandomVectors(50, 3, 1);
+    for (const auto& ev : evs) {
+      index.Insert(ev);
+    }
+
+    THEN("Searching for one of them returns it at distance 0") {
+      std::vector<Neighbour> result = index.Search(evs[17], 1);
+      REQUIRE(result.size() == 1);
+      REQUIRE(result[0].id == 17);
+      REQUIRE(result[0].distance == 0);
+      REQUIRE(index.Get(17) == evs[17]);
+    }
+  }
+}
+
+SCENARIO("Recall of the index against an exhaustive scan") {
+  WHEN("You insert a couple of thousand random vectors") {
+    const int dims = 16;
+    std::vector<EuclideanVector> evs = RandomVectors(2000, dims, 2);
+    HnswIndex index{dims, HnswParams{12, 100, 64, 7}};
+    EuclideanVectorBatch batch{dims};
+    for (const auto& ev : evs) {
+      index.Insert(ev);
+      batch.Add(ev);
+    }
+
+    THEN("At least 90% of the true 10 nearest neighbours are found") {
+      std::size_t hits = 0;
+      std::size_t total = 0;
+      for (const auto& query : RandomVectors(50, dims, 3)) {
+        std::vector<Neighbour> exact = FindNearest(batch, query, 10);
+        std::vector<Neighbour> approx = index.Search(query, 10);
+        for (const auto& e : exact) {
+          for (const auto& a : approx) {
+            hits += a.id == e.id ? 1 : 0;
+          }
+        }
+        total += exact.size();
+      }
+      REQUIRE(static_cast<double>(hits) / static_cast<double>(total) >= 0.9);
+    }
+  }
+}
+
+SCENARIO("Searching from several threads at once") {
+  WHEN("You build an index") {
+    std::vector<EuclideanVector> evs = RandomVectors(500, 8, 4);
+    HnswIndex index{8};
+    for (const auto& ev : evs) {
+      index.Insert(ev);
+    }
+
+    THEN("Concurrent searches each find their own vector") {
+      std::vector<int> found(4, 0);
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+          for (std::size_t i = static_cast<std::size_t>(t); i < evs.size(); i += 4) {
+            found[static_cast<std::size_t>(t)] += index.Search(evs[i], 1).front().id == i ? 1 : 0;
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      REQUIRE(found[0] + found[1] + found[2] + found[3] >= 495);
+    }
+  }
+}
+
+SCENARIO("Saving and loading an index") {
+  WHEN("You save a populated index to a stream") {
+    std::vector<EuclideanVector> evs = RandomVectors(300, 5, 5);
+    HnswIndex index{5, HnswParams{8, 40, 20, 9}};
+    for (const auto& ev : evs) {
+      index.Insert(ev);
+    }
+    std::stringstream ss;
+    index.Save(ss);
+
+    THEN("The loaded index has the same parameters and gives the same answers") {
+      HnswIndex loaded = HnswIndex::Load(ss);
+      REQUIRE(loaded.size() == index.size());
+      REQUIRE(loaded.GetParams().m == 8);
+      REQUIRE(loaded.GetParams().ef_search == 20);
+      for (const auto& query : RandomVectors(10, 5, 6)) {
+        std::vector<Neighbour> a = index.Search(query, 5);
+        std::vector<Neighbour> b = loaded.Search(query, 5);
+        REQUIRE(a.size() == b.size());
+        for (std::size_t i = 0; i < a.size(); ++i) {
+          REQUIRE(a[i].id == b[i].id);
+        }
+      }
+    }
+  }
+}
+
+// EXCEPTION - stream does not hold an index
+SCENARIO("Loading an index from a bad stream") {
+  WHEN("You have a stream of garbage") {
+    std::stringstream ss{"not an index"};
+
+    THEN("Loading returns exception error") {
+      REQUIRE_THROWS_WITH(HnswIndex::Load(ss), "Stream does not hold a HnswIndex");
+    }
+  }
+}
+
+// EXCEPTION - stream is truncated or its fields describe an index that cannot be searched
+SCENARIO("Loading an index from a corrupted stream") {
+  WHEN("You take a valid two node index and damage it") {
+    std::string valid = TwoNodeIndex(false);
+    HnswIndex index = LoadBytes(valid);
+
+    THEN("Only the undamaged stream loads") {
+      REQUIRE(index.size() == 2);
+      REQUIRE(index.Search(EuclideanVector{1, 0.9}, 2).front().id == 1);
+      REQUIRE_THROWS_WITH(LoadBytes(valid.substr(0, valid.size() - 2)),
+                          "HnswIndex stream ended unexpectedly");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::int32_t>(valid, kDimensionsOffset, -1)),
+                          "HnswIndex stream has an invalid header");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::int32_t>(valid, kDimensionsOffset, 0)),
+                          "HnswIndex stream has an invalid header");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::uint64_t>(valid, kCountOffset, 1ULL << 40)),
+                          "HnswIndex stream has an invalid header");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::uint64_t>(valid, kCountOffset, 4000000000ULL)),
+                          "HnswIndex stream ended unexpectedly");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::uint32_t>(valid, kEntryPointOffset, 2)),
+                          "HnswIndex stream has an invalid entry point");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::uint32_t>(valid, kEntryPointOffset, 1)),
+                          "HnswIndex stream has an invalid entry point");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::int32_t>(valid, kMaxLevelOffset, 1 << 30)),
+                          "HnswIndex stream has an invalid entry point");
+      REQUIRE_THROWS_WITH(LoadBytes(Patch<std::uint32_t>(valid, kFirstNodeLinksOffset, 1u << 31)),
+                          "HnswIndex stream has a node with too many links");
+      REQUIRE_THROWS_WITH(LoadBytes(TwoNodeIndex(true)),
+                          "HnswIndex stream has a link to a node without that level");
+    }
+  }
+}
+
+// EXCEPTION - an index needs at least one dimension
+SCENARIO("Creating an index of no dimensions") {
+  WHEN("You ask for 0 or -1 dimensional vectors") {
+    THEN("EuclideanVectorError is thrown") {
+      REQUIRE_THROWS_WITH(HnswIndex{0}, "HnswIndex needs num_dimensions >= 1");
+      REQUIRE_THROWS_WITH(HnswIndex{-1}, "HnswIndex needs num_dimensions >= 1");
+    }
+  }
+}
+
+// EXCEPTION - dimensions do not match
+SCENARIO("Inserting a vector of the wrong dimension") {
+  WHEN("You create an index of 4 dimensional vectors") {
+    HnswIndex index{4};
+
+    THEN("Inserting a 2 dimensional vector returns exception error") {
+      REQUIRE_THROWS_WITH(index.Insert(EuclideanVector{2}),
+                          "Dimensions of index(4) and vector(2) do not match");
+    }
+  }
+}
@@ -0,0 +1,228 @@
+#include "assignments/ev/ivf_pq_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "assignments/ev/kmeans.h"
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+// Codes summed per AdcScan call; their distances (1KB) stay in L1 until they are offered
+constexpr std::size_t kScanBlock = 256;
+
+}  // namespace
+
+static_assert(static_cast<std::size_t>(IvfPqIndex::kCodebookSize) == kAdcTableStride,
+              "lookup tables are laid out with one row of kAdcTableStride floats per sub-space");
+
+/* CONSTRUCTORS */
+// Creates an untrained index for vectors with num_dimensions dimensions
+IvfPqIndex::IvfPqIndex(int num_dimensions, IvfPqParams params)
+  : params_{params}, num_dimensions_{num_dimensions}, codebook_size_{0}, coarse_{num_dimensions},
+    size_{0} {
+  if (params.num_lists < 1 || params.num_subspaces < 1 || params.num_probes < 1) {
+    throw EuclideanVectorError("IvfPqIndex needs num_lists, num_subspaces and num_probes >= 1");
+  }
+  if (num_dimensions % params.num_subspaces != 0) {
+    throw EuclideanVectorError("Number of sub-spaces(" + std::to_string(params.num_subspaces) +
+                               ") does not divide dimensions(" + std::to_string(num_dimensions) +
+                               ")");
+  }
+}
+
+/* METHODS */
+void IvfPqIndex::SetNumProbes(int num_probes) {
+  if (num_probes < 1) {
+    throw EuclideanVectorError("IvfPqIndex needs num_probes >= 1");
+  }
+  this->params_.num_probes = num_probes;
+}
+
+// Trains the coarse quantizer on training, then trains one codebook per sub-space on the
+//  residuals of training against their coarse centroids
+void IvfPqIndex::Train(const EuclideanVectorBatch& training) {
+  if (training.GetNumDimensions() != this->num_dimensions_ || training.empty()) {
+    throw EuclideanVectorError("IvfPqIndex needs a non-empty training batch of dimension " +
+                               std::to_string(this->num_dimensions_));
+  }
+  if (this->size_ > 0) {
+    throw EuclideanVectorError("IvfPqIndex cannot be retrained once vectors are added");
+  }
+
+  KMeansParams coarse_params;
+  coarse_params.k = static_cast<std::size_t>(this->params_.num_lists);
+  coarse_params.max_iterations = this->params_.training_iterations;
+  coarse_params.seed = this->params_.seed;
+  KMeansResult coarse = KMeans(training, coarse_params);
+
+  const int m = this->params_.num_subspaces;
+  const int sub_dims = SubspaceDimensions();
+  std::vector<EuclideanVectorBatch> residuals(static_cast<std::size_t>(m),
+                                              EuclideanVectorBatch{sub_dims});
+  std::vector<double> residual(static_cast<std::size_t>(this->num_dimensions_));
+  for (std::size_t i = 0; i < training.size(); ++i) {
+    const double* v = training.Row(i);
+    const double* c = coarse.centroids.Row(coarse.assignments[i]);
+    for (int j = 0; j < this->num_dimensions_; ++j) {
+      residual[static_cast<std::size_t>(j)] = v[j] - c[j];
+    }
+    for (int s = 0; s < m; ++s) {
+      residuals[static_cast<std::size_t>(s)].Add(residual.data() + s * sub_dims);
+    }
+  }
+
+  this->codebook_size_ = static_cast<int>(std::min<std::size_t>(kCodebookSize, training.size()));
+  this->codebooks_.assign(static_cast<std::size_t>(m * kCodebookSize * sub_dims), 0.0);
+  for (int s = 0; s < m; ++s) {
+    KMeansParams sub_params = coarse_params;
+    sub_params.k = static_cast<std::size_t>(this->codebook_size_);
+    sub_params.seed = this->params_.seed + static_cast<std::uint32_t>(s) + 1;
+    KMeansResult sub = KMeans(residuals[static_cast<std::size_t>(s)], sub_params);
+    for (std::size_t c = 0; c < sub.centroids.size(); ++c) {
+      auto offset = (static_cast<std::size_t>(s * kCodebookSize) + c) *
+                    static_cast<std::size_t>(sub_dims);
+      std::copy(sub.centroids.Row(c), sub.centroids.Row(c) + sub_dims, &this->codebooks_[offset]);
+    }
+  }
+
+  this->coarse_ = std::move(coarse.centroids);
+  this->lists_.assign(this->coarse_.size(), InvertedList{});
+}
+
+// Stores ev as (nearest coarse list, PQ code of its residual)
+std::size_t IvfPqIndex::Add(const EuclideanVector& ev) {
+  CheckDimensions(ev);
+  if (!IsTrained()) {
+    throw EuclideanVectorError("IvfPqIndex must be trained before vectors are added");
+  }
+  if (this->size_ >= std::numeric_limits<std::uint32_t>::max()) {
+    throw EuclideanVectorError("IvfPqIndex is full");
+  }
+
+  std::size_t list = NearestCentroid(this->coarse_, ev.data());
+  const double* c = this->coarse_.Row(list);
+  std::vector<double> residual(static_cast<std::size_t>(this->num_dimensions_));
+  for (int j = 0; j < this->num_dimensions_; ++j) {
+    residual[static_cast<std::size_t>(j)] = ev.data()[j] - c[j];
+  }
+
+  InvertedList& inverted = this->lists_[list];
+  inverted.ids.push_back(static_cast<std::uint32_t>(this->size_));
+  auto m = static_cast<std::size_t>(this->params_.num_subspaces);
+  inverted.codes.resize(inverted.codes.size() + m);
+  Encode(residual.data(), &inverted.codes[inverted.codes.size() - m]);
+  return this->size_++;
+}
+
+// Scans the num_probes lists whose coarse centroids are closest to query
+std::vector<Neighbour> IvfPqIndex::Search(const EuclideanVector& query, std::size_t k) const {
+  CheckDimensions(query);
+  std::vector<Neighbour> best;
+  if (!IsTrained() || k == 0) {
+    return best;
+  }
+
+  std::vector<std::pair<double, std::size_t>> lists(this->coarse_.size());
+  for (std::size_t l = 0; l < lists.size(); ++l) {
+    lists[l] = {SquaredDistance(this->coarse_.Row(l), query.data(), this->num_dimensions_), l};
+  }
+  auto probes = std::min(lists.size(), static_cast<std::size_t>(this->params_.num_probes));
+  std::partial_sort(lists.begin(), lists.begin() + static_cast<std::ptrdiff_t>(probes),
+                    lists.end());
+
+  std::vector<double> residual(static_cast<std::size_t>(this->num_dimensions_));
+  std::vector<float> table(static_cast<std::size_t>(params_.num_subspaces * kCodebookSize));
+  best.reserve(k + 1);
+  for (std::size_t p = 0; p < probes; ++p) {
+    const double* c = this->coarse_.Row(lists[p].second);
+    for (int j = 0; j < this->num_dimensions_; ++j) {
+      residual[static_cast<std::size_t>(j)] = query.data()[j] - c[j];
+    }
+    ComputeTable(residual.data(), table.data());
+    ScanList(this->lists_[lists[p].second], table.data(), k, best);
+  }
+
+  auto closer = [](const Neighbour& a, const Neighbour& b) { return a.distance < b.distance; };
+  std::sort_heap(best.begin(), best.end(), closer);
+  for (auto& n : best) {
+    n.distance = std::sqrt(std::max(n.distance, 0.0));
+  }
+  return best;
+}
+
+/* HELPERS */
+const double* IvfPqIndex::Codeword(int subspace, int code) const noexcept {
+  auto offset = (subspace * kCodebookSize + code) * SubspaceDimensions();
+  return &this->codebooks_[static_cast<std::size_t>(offset)];
+}
+
+// Replaces each sub-vector of residual by the index of its nearest codeword
+void IvfPqIndex::Encode(const double* residual, std::uint8_t* code) const noexcept {
+  const int sub_dims = SubspaceDimensions();
+  for (int s = 0; s < this->params_.num_subspaces; ++s) {
+    const double* sub = residual + s * sub_dims;
+    int best = 0;
+    double best_distance = std::numeric_limits<double>::infinity();
+    for (int c = 0; c < this->codebook_size_; ++c) {
+      double d = SquaredDistance(sub, Codeword(s, c), sub_dims);
+      if (d < best_distance) {
+        best_distance = d;
+        best = c;
+      }
+    }
+    code[s] = static_cast<std::uint8_t>(best);
+  }
+}
+
+// table[s * kCodebookSize + c] = squared distance between sub-vector s of residual and codeword c.
+//  Unused codewords (small training sets) get +inf so they can never win.
+void IvfPqIndex::ComputeTable(const double* residual, float* table) const noexcept {
+  const int sub_dims = SubspaceDimensions();
+  for (int s = 0; s < this->params_.num_subspaces; ++s) {
+    float* row = table + s * kCodebookSize;
+    for (int c = 0; c < kCodebookSize; ++c) {
+      row[c] = c < this->codebook_size_
+                 ? static_cast<float>(SquaredDistance(residual + s * sub_dims, Codeword(s, c),
+                                                      sub_dims))
+                 : std::numeric_limits<float>::infinity();
+    }
+  }
+}
+
+// Sums table entries for every code in list and keeps the k smallest totals in the max-heap best.
+//  The sums come from the dispatched AdcScan, a block of codes at a time.
+void IvfPqIndex::ScanList(const InvertedList& list,
+                          const float* table,
+                          std::size_t k,
+                          std::vector<Neighbour>& best) const {
+  const auto m = static_cast<std::size_t>(this->params_.num_subspaces);
+  const std::size_t n = list.ids.size();
+  auto closer = [](const Neighbour& a, const Neighbour& b) { return a.distance < b.distance; };
+  float distances[kScanBlock];
+  for (std::size_t first = 0; first < n; first += kScanBlock) {
+    const std::size_t count = std::min(kScanBlock, n - first);
+    AdcScan(list.codes.data() + first * m, m, table, distances, count);
+    for (std::size_t j = 0; j < count; ++j) {
+      const float d = distances[j];
+      if (best.size() < k) {
+        best.push_back({list.ids[first + j], d});
+        std::push_heap(best.begin(), best.end(), closer);
+      } else if (d < best.front().distance) {
+        std::pop_heap(best.begin(), best.end(), closer);
+        best.back() = {list.ids[first + j], d};
+        std::push_heap(best.begin(), best.end(), closer);
+      }
+    }
+  }
+}
+
+void IvfPqIndex::CheckDimensions(const EuclideanVector& ev) const {
+  if (ev.GetNumDimensions() != static_cast<std::size_t>(this->num_dimensions_)) {
+    throw EuclideanVectorError("Dimensions of index(" + std::to_string(this->num_dimensions_) +
+                               ") and vector(" + std::to_string(ev.GetNumDimensions()) +
+                               ") do not match");
+  }
+}
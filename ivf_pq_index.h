@@ -0,0 +1,78 @@
+#ifndef ASSIGNMENTS_EV_IVF_PQ_INDEX_H_
+#define ASSIGNMENTS_EV_IVF_PQ_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// Tuning knobs for IvfPqIndex
+//  num_lists           - clusters of the coarse quantizer (inverted lists)
+//  num_subspaces       - product quantizer sub-vectors; must divide the number of dimensions.
+//                        Each stored vector costs num_subspaces bytes plus a 4 byte id.
+//  num_probes          - inverted lists scanned per query
+//  training_iterations - k-means iterations for the coarse and sub-space quantizers
+struct IvfPqParams {
+  int num_lists = 64;
+  int num_subspaces = 8;
+  int num_probes = 8;
+  int training_iterations = 20;
+  std::uint32_t seed = 100;
+};
+
+// Inverted file index with product-quantized residuals.
+//  Vectors are assigned to their nearest coarse centroid and only the (8-bit per sub-space) PQ
+//  code of the residual is kept. Queries scan the closest num_probes lists with asymmetric
+//  distances: the query is never quantized, distances are summed from per-list lookup tables.
+//  The index must be trained on a representative sample before vectors are added.
+class IvfPqIndex {
+ public:
+  static constexpr int kCodebookSize = 256;  // centroids per sub-space (one byte per code)
+
+  /* CONSTRUCTORS */
+  explicit IvfPqIndex(int num_dimensions, IvfPqParams params = IvfPqParams{});
+
+  /* METHODS */
+  int GetNumDimensions() const noexcept { return this->num_dimensions_; }
+  std::size_t size() const noexcept { return this->size_; }
+  bool IsTrained() const noexcept { return !this->coarse_.empty(); }
+  const IvfPqParams& GetParams() const noexcept { return this->params_; }
+  void SetNumProbes(int num_probes);
+
+  // Learns the coarse centroids and the PQ codebooks from training
+  void Train(const EuclideanVectorBatch& training);
+
+  // Encodes ev into the index and returns its id (ids are assigned in insertion order)
+  std::size_t Add(const EuclideanVector& ev);
+
+  // Returns (up to) the k nearest vectors by approximate distance, nearest first
+  std::vector<Neighbour> Search(const EuclideanVector& query, std::size_t k) const;
+
+ private:
+  struct InvertedList {
+    std::vector<std::uint32_t> ids;
+    std::vector<std::uint8_t> codes;  // num_subspaces bytes per id, in the same order as ids
+  };
+
+  int SubspaceDimensions() const noexcept { return num_dimensions_ / params_.num_subspaces; }
+  const double* Codeword(int subspace, int code) const noexcept;
+  void Encode(const double* residual, std::uint8_t* code) const noexcept;
+  void ComputeTable(const double* residual, float* table) const noexcept;
+  void ScanList(const InvertedList& list,
+                const float* table,
+                std::size_t k,
+                std::vector<Neighbour>& best) const;
+  void CheckDimensions(const EuclideanVector& ev) const;
+
+  IvfPqParams params_;
+  int num_dimensions_;
+  int codebook_size_;
+  EuclideanVectorBatch coarse_;
+  std::vector<double> codebooks_;  // [subspace][code][SubspaceDimensions()]
+  std::vector<InvertedList> lists_;
+  std::size_t size_;
+};
+
+#endif  // ASSIGNMENTS_EV_IVF_PQ_INDEX_H_
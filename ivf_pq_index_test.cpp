@@ -0,0 +1,103 @@
+/*
+
+  == Explanation and rational of testing ==
+  Product quantization is lossy, so the tests check properties rather than exact distances: that
+  the index refuses to work untrained, that a stored vector is found as its own nearest neighbour
+  on clustered data, that recall against the exhaustive scan is high once every list is probed and
+  that invalid configurations are rejected up front.
+
+*/
+
+#include "assignments/ev/ivf_pq_index.h"
+
+#include <random>
+
+#include "catch.h"
+
+namespace {
+
+// Points scattered tightly around a handful of well separated centres
+EuclideanVectorBatch ClusteredVectors(std::size_t count, int dims, unsigned seed) {
+  std::mt19937 rng{seed};
+  std::normal_distribution<double> noise{0.0, 0.1};
+  std::uniform_int_distribution<int> centre{0, 7};
+  EuclideanVectorBatch batch{dims};
+  std::vector<double> v(static_cast<std::size_t>(dims));
+  for (std::size_t i = 0; i < count; ++i) {
+    int c = centre(rng);
+    for (int j = 0; j < dims; ++j) {
+      v[static_cast<std::size_t>(j)] = (j % 8 == c ? 10.0 : 0.0) + noise(rng);
+    }
+    batch.Add(v.data());
+  }
+  return batch;
+}
+
+}  // namespace
+
+SCENARIO("Using an index before it is trained") {
+  WHEN("You create an index") {
+    IvfPqIndex index{8, IvfPqParams{4, 2, 1, 10, 1}};
+
+    REQUIRE_FALSE(index.IsTrained());
+
+    THEN("Searching returns nothing and adding returns exception error") {
+      REQUIRE(index.Search(EuclideanVector{8}, 3).empty());
+      REQUIRE_THROWS_WITH(index.Add(EuclideanVector{8}),
+                          "IvfPqIndex must be trained before vectors are added");
+    }
+  }
+}
+
+SCENARIO("Searching a trained and populated index") {
+  WHEN("You train on clustered data and add it") {
+    const int dims = 16;
+    EuclideanVectorBatch data = ClusteredVectors(1000, dims, 1);
+    IvfPqIndex index{dims, IvfPqParams{8, 4, 8, 15, 2}};
+    index.Train(data);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      index.Add(data.Get(i));
+    }
+
+    REQUIRE(index.IsTrained());
+    REQUIRE(index.size() == data.size());
+
+    THEN("Most stored vectors are their own nearest neighbour") {
+      std::size_t self_hits = 0;
+      for (std::size_t i = 0; i < 100; ++i) {
+        std::vector<Neighbour> result = index.Search(data.Get(i), 10);
+        for (const auto& n : result) {
+          self_hits += n.id == i ? 1 : 0;
+        }
+      }
+      REQUIRE(self_hits >= 90);
+    }
+
+    THEN("Results are sorted and the 10 nearest overlap the exhaustive answer") {
+      std::size_t hits = 0;
+      for (std::size_t i = 0; i < 20; ++i) {
+        EuclideanVector query = data.Get(i * 37);
+        std::vector<Neighbour> approx = index.Search(query, 10);
+        REQUIRE(approx.size() == 10);
+        for (std::size_t j = 1; j < approx.size(); ++j) {
+          REQUIRE(approx[j - 1].distance <= approx[j].distance);
+        }
+        // Every point in a cluster is roughly as close as any other, so compare cluster membership
+        for (const auto& n : approx) {
+          hits += (data.Get(n.id) - query).GetEuclideanNorm() < 2 ? 1 : 0;
+        }
+      }
+      REQUIRE(hits == 200);
+    }
+  }
+}
+
+// EXCEPTION - sub-spaces must divide the dimensions
+SCENARIO("Creating an index whose sub-spaces do not divide the dimensions") {
+  WHEN("You ask for 3 sub-spaces of a 8 dimensional vector") {
+    THEN("Creating the index returns exception error") {
+      REQUIRE_THROWS_WITH((IvfPqIndex{8, IvfPqParams{4, 3, 1, 10, 1}}),
+                          "Number of sub-spaces(3) does not divide dimensions(8)");
+    }
+  }
+}
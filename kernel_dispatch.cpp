@@ -0,0 +1,443 @@
+#include "assignments/ev/kernel_dispatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/vector_kernels.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define EV_X86_KERNELS
+#include <immintrin.h>
+#define EV_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace {
+
+constexpr const char* kIsaNames[] = {"scalar", "sse4.2", "avx2", "avx512"};
+
+/* SCALAR */
+// Four independent accumulators let the compiler pipeline the additions instead of waiting on a
+//  single running sum; lane k sums the indices i with i % 4 == k
+
+double ScalarDot(const double* a, const double* b, std::size_t n) noexcept {
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += a[i] * b[i];
+    s1 += a[i + 1] * b[i + 1];
+    s2 += a[i + 2] * b[i + 2];
+    s3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; ++i) {
+    s0 += a[i] * b[i];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+double ScalarSquaredDistance(const double* a, const double* b, std::size_t n) noexcept {
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    double d0 = a[i] - b[i];
+    double d1 = a[i + 1] - b[i + 1];
+    double d2 = a[i + 2] - b[i + 2];
+    double d3 = a[i + 3] - b[i + 3];
+    s0 += d0 * d0;
+    s1 += d1 * d1;
+    s2 += d2 * d2;
+    s3 += d3 * d3;
+  }
+  for (; i < n; ++i) {
+    double d = a[i] - b[i];
+    s0 += d * d;
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+void ScalarAdd(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] + b[i];
+  }
+}
+
+void ScalarSubtract(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] - b[i];
+  }
+}
+
+void ScalarScale(const double* a, double s, double* out, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] * s;
+  }
+}
+
+// Four codes at a time so that their independent table lookups overlap; each code's lookups are
+//  still added in order of sub-space, which any vector version has to keep per lane
+void ScalarAdcScan(const std::uint8_t* codes,
+                   std::size_t m,
+                   const float* table,
+                   float* distances,
+                   std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const std::uint8_t* c0 = codes + i * m;
+    const std::uint8_t* c1 = c0 + m;
+    const std::uint8_t* c2 = c1 + m;
+    const std::uint8_t* c3 = c2 + m;
+    float d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+    for (std::size_t s = 0; s < m; ++s) {
+      const float* row = table + s * kAdcTableStride;
+      d0 += row[c0[s]];
+      d1 += row[c1[s]];
+      d2 += row[c2[s]];
+      d3 += row[c3[s]];
+    }
+    distances[i] = d0;
+    distances[i + 1] = d1;
+    distances[i + 2] = d2;
+    distances[i + 3] = d3;
+  }
+  for (; i < n; ++i) {
+    const std::uint8_t* c = codes + i * m;
+    float d = 0;
+    for (std::size_t s = 0; s < m; ++s) {
+      d += table[s * kAdcTableStride + c[s]];
+    }
+    distances[i] = d;
+  }
+}
+
+#ifdef EV_X86_KERNELS
+/* SSE4.2 */
+// Two 2-lane accumulators hold the same four partial sums as the scalar kernels, in the same
+//  order, so these give bit-identical results
+
+EV_TARGET("sse4.2")
+double Sse42Dot(const double* a, const double* b, std::size_t n) noexcept {
+  __m128d s01 = _mm_setzero_pd();
+  __m128d s23 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s01 = _mm_add_pd(s01, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    s23 = _mm_add_pd(s23, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+  }
+  double s[4];
+  _mm_storeu_pd(s, s01);
+  _mm_storeu_pd(s + 2, s23);
+  for (; i < n; ++i) {
+    s[0] += a[i] * b[i];
+  }
+  return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+EV_TARGET("sse4.2")
+double Sse42SquaredDistance(const double* a, const double* b, std::size_t n) noexcept {
+  __m128d s01 = _mm_setzero_pd();
+  __m128d s23 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128d d01 = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+    __m128d d23 = _mm_sub_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2));
+    s01 = _mm_add_pd(s01, _mm_mul_pd(d01, d01));
+    s23 = _mm_add_pd(s23, _mm_mul_pd(d23, d23));
+  }
+  double s[4];
+  _mm_storeu_pd(s, s01);
+  _mm_storeu_pd(s + 2, s23);
+  for (; i < n; ++i) {
+    double d = a[i] - b[i];
+    s[0] += d * d;
+  }
+  return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+EV_TARGET("sse4.2")
+void Sse42Add(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = a[i] + b[i];
+  }
+}
+
+EV_TARGET("sse4.2")
+void Sse42Subtract(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = a[i] - b[i];
+  }
+}
+
+EV_TARGET("sse4.2")
+void Sse42Scale(const double* a, double s, double* out, std::size_t n) noexcept {
+  const __m128d factor = _mm_set1_pd(s);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), factor));
+  }
+  for (; i < n; ++i) {
+    out[i] = a[i] * s;
+  }
+}
+
+/* AVX2 + FMA */
+// Two 4-lane accumulators, so two independent fused multiply-adds are in flight per iteration
+
+EV_TARGET("avx2,fma")
+double Avx2Dot(const double* a, const double* b, std::size_t n) noexcept {
+  __m256d s0 = _mm256_setzero_pd();
+  __m256d s1 = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+    s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+  }
+  if (i + 4 <= n) {
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+    i += 4;
+  }
+  double s[4];
+  _mm256_storeu_pd(s, _mm256_add_pd(s0, s1));
+  for (; i < n; ++i) {
+    s[0] += a[i] * b[i];
+  }
+  return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+EV_TARGET("avx2,fma")
+double Avx2SquaredDistance(const double* a, const double* b, std::size_t n) noexcept {
+  __m256d s0 = _mm256_setzero_pd();
+  __m256d s1 = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+    __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+    s0 = _mm256_fmadd_pd(d0, d0, s0);
+    s1 = _mm256_fmadd_pd(d1, d1, s1);
+  }
+  if (i + 4 <= n) {
+    __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+    s0 = _mm256_fmadd_pd(d0, d0, s0);
+    i += 4;
+  }
+  double s[4];
+  _mm256_storeu_pd(s, _mm256_add_pd(s0, s1));
+  for (; i < n; ++i) {
+    double d = a[i] - b[i];
+    s[0] += d * d;
+  }
+  return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+EV_TARGET("avx2,fma")
+void Avx2Add(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = a[i] + b[i];
+  }
+}
+
+EV_TARGET("avx2,fma")
+void Avx2Subtract(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = a[i] - b[i];
+  }
+}
+
+EV_TARGET("avx2,fma")
+void Avx2Scale(const double* a, double s, double* out, std::size_t n) noexcept {
+  const __m256d factor = _mm256_set1_pd(s);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+  }
+  for (; i < n; ++i) {
+    out[i] = a[i] * s;
+  }
+}
+
+/* AVX-512 */
+// The last partial block is handled with masked loads and stores instead of a scalar loop
+
+EV_TARGET("avx512f")
+__mmask8 TailMask(std::size_t remaining) noexcept {
+  return static_cast<__mmask8>((1u << remaining) - 1);
+}
+
+// Horizontal sum, paired like the AVX2 reduction (_mm512_reduce_add_pd trips -Wuninitialized in
+//  gcc 12's headers)
+EV_TARGET("avx512f")
+double Sum8(__m512d v) noexcept {
+  double s[8];
+  _mm512_storeu_pd(s, v);
+  return ((s[0] + s[4]) + (s[1] + s[5])) + ((s[2] + s[6]) + (s[3] + s[7]));
+}
+
+EV_TARGET("avx512f")
+double Avx512Dot(const double* a, const double* b, std::size_t n) noexcept {
+  __m512d s0 = _mm512_setzero_pd();
+  __m512d s1 = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), s0);
+    s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), s1);
+  }
+  for (; i < n; i += 8) {
+    __mmask8 mask = TailMask(n - i < 8 ? n - i : 8);
+    s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i),
+                         s0);
+  }
+  return Sum8(_mm512_add_pd(s0, s1));
+}
+
+EV_TARGET("avx512f")
+double Avx512SquaredDistance(const double* a, const double* b, std::size_t n) noexcept {
+  __m512d s0 = _mm512_setzero_pd();
+  __m512d s1 = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+    __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8));
+    s0 = _mm512_fmadd_pd(d0, d0, s0);
+    s1 = _mm512_fmadd_pd(d1, d1, s1);
+  }
+  for (; i < n; i += 8) {
+    __mmask8 mask = TailMask(n - i < 8 ? n - i : 8);
+    __m512d d = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, a + i),
+                              _mm512_maskz_loadu_pd(mask, b + i));
+    s0 = _mm512_fmadd_pd(d, d, s0);
+  }
+  return Sum8(_mm512_add_pd(s0, s1));
+}
+
+EV_TARGET("avx512f")
+void Avx512Add(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; i += 8) {
+    __mmask8 mask = TailMask(n - i < 8 ? n - i : 8);
+    _mm512_mask_storeu_pd(out + i, mask,
+                          _mm512_add_pd(_mm512_maskz_loadu_pd(mask, a + i),
+                                        _mm512_maskz_loadu_pd(mask, b + i)));
+  }
+}
+
+EV_TARGET("avx512f")
+void Avx512Subtract(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; i += 8) {
+    __mmask8 mask = TailMask(n - i < 8 ? n - i : 8);
+    _mm512_mask_storeu_pd(out + i, mask,
+                          _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, a + i),
+                                        _mm512_maskz_loadu_pd(mask, b + i)));
+  }
+}
+
+EV_TARGET("avx512f")
+void Avx512Scale(const double* a, double s, double* out, std::size_t n) noexcept {
+  const __m512d factor = _mm512_set1_pd(s);
+  for (std::size_t i = 0; i < n; i += 8) {
+    __mmask8 mask = TailMask(n - i < 8 ? n - i : 8);
+    _mm512_mask_storeu_pd(out + i, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + i), factor));
+  }
+}
+#endif  // EV_X86_KERNELS
+
+const KernelTable kTables[] = {
+  {KernelIsa::kScalar, ScalarDot, ScalarSquaredDistance, ScalarAdd, ScalarSubtract, ScalarScale,
+   ScalarAdcScan},
+#ifdef EV_X86_KERNELS
+  // Every instruction set scans with the scalar kernel: gathers from 8-bit code tables (AVX2
+  //  _mm256_i32gather_ps, AVX-512 _mm512_i32gather_ps) measured 10-15% slower than its four
+  //  interleaved lookups, since both are bound by the loads. A faster scan needs 4-bit codes
+  //  whose tables fit in a register for shuffle-based lookups.
+  {KernelIsa::kSse42, Sse42Dot, Sse42SquaredDistance, Sse42Add, Sse42Subtract, Sse42Scale,
+   ScalarAdcScan},
+  {KernelIsa::kAvx2, Avx2Dot, Avx2SquaredDistance, Avx2Add, Avx2Subtract, Avx2Scale,
+   ScalarAdcScan},
+  {KernelIsa::kAvx512, Avx512Dot, Avx512SquaredDistance, Avx512Add, Avx512Subtract,
+   Avx512Scale, ScalarAdcScan},
+#endif
+};
+
+std::atomic<const KernelTable*> g_active{nullptr};
+
+// The detected instruction set, capped by EV_KERNEL_ISA if it names a known one
+const KernelTable* InitialTable() noexcept {
+  KernelIsa isa = DetectKernelIsa();
+  if (const char* name = std::getenv("EV_KERNEL_ISA")) {
+    try {
+      isa = std::min(isa, KernelIsaFromString(name));
+    } catch (const EuclideanVectorError&) {
+      // an unknown name leaves the detected choice in place
+    }
+  }
+  return &kTables[static_cast<int>(isa)];
+}
+
+}  // namespace
+
+const char* ToString(KernelIsa isa) noexcept {
+  return kIsaNames[static_cast<int>(isa)];
+}
+
+KernelIsa KernelIsaFromString(const std::string& name) {
+  for (int i = 0; i < 4; ++i) {
+    if (name == kIsaNames[i]) {
+      return static_cast<KernelIsa>(i);
+    }
+  }
+  throw EuclideanVectorError("Unknown kernel instruction set " + name);
+}
+
+KernelIsa DetectKernelIsa() noexcept {
+#ifdef EV_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return KernelIsa::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return KernelIsa::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return KernelIsa::kSse42;
+  }
+#endif
+  return KernelIsa::kScalar;
+}
+
+const KernelTable& ActiveKernels() noexcept {
+  const KernelTable* table = g_active.load(std::memory_order_acquire);
+  if (table == nullptr) {
+    const KernelTable* expected = nullptr;
+    table = InitialTable();
+    if (!g_active.compare_exchange_strong(expected, table, std::memory_order_acq_rel)) {
+      table = expected;
+    }
+  }
+  return *table;
+}
+
+const KernelTable& GetKernelTable(KernelIsa isa) {
+  if (isa > DetectKernelIsa()) {
+    throw EuclideanVectorError(std::string("This CPU does not support ") + ToString(isa) +
+                               " kernels");
+  }
+  return kTables[static_cast<int>(isa)];
+}
+
+void SetKernelIsa(KernelIsa isa) {
+  g_active.store(&GetKernelTable(isa), std::memory_order_release);
+}
@@ -0,0 +1,60 @@
+#ifndef ASSIGNMENTS_EV_KERNEL_DISPATCH_H_
+#define ASSIGNMENTS_EV_KERNEL_DISPATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Runtime selection of the hot kernels behind Dot, SquaredNorm, SquaredDistance and the
+//  element-wise add/subtract/scale used by EuclideanVector.
+//  Every instruction set's version is compiled into the binary (with per-function target
+//  attributes, so no -march flag is needed) and the best one the CPU supports is picked on first
+//  use. Setting the environment variable EV_KERNEL_ISA to scalar, sse4.2, avx2 or avx512 caps the
+//  choice, e.g. to reproduce results from an older host; values the CPU cannot run are lowered to
+//  the best it can.
+//
+//  The avx2 and avx512 kernels use fused multiply-adds and wider accumulators, so reductions (dot
+//  products, norms, distances) can differ from the scalar ones in the last bits. Add, subtract
+//  and scale give identical results whichever kernel runs, and so does the product quantisation
+//  scan, which adds its lookups in the same order on every instruction set.
+
+// Instruction sets with their own kernels, slowest first
+//  kAvx2   - AVX2 plus FMA
+//  kAvx512 - AVX-512F (which implies FMA)
+enum class KernelIsa { kScalar, kSse42, kAvx2, kAvx512 };
+
+// The kernels for one instruction set
+struct KernelTable {
+  KernelIsa isa;
+  double (*dot)(const double* a, const double* b, std::size_t n) noexcept;
+  double (*squared_distance)(const double* a, const double* b, std::size_t n) noexcept;
+  void (*add)(const double* a, const double* b, double* out, std::size_t n) noexcept;
+  void (*subtract)(const double* a, const double* b, double* out, std::size_t n) noexcept;
+  void (*scale)(const double* a, double s, double* out, std::size_t n) noexcept;
+  void (*adc_scan)(const std::uint8_t* codes,
+                   std::size_t m,
+                   const float* table,
+                   float* distances,
+                   std::size_t n) noexcept;
+};
+
+const char* ToString(KernelIsa isa) noexcept;
+// Inverse of ToString; throws for an unknown name
+KernelIsa KernelIsaFromString(const std::string& name);
+
+// Best instruction set this CPU supports
+KernelIsa DetectKernelIsa() noexcept;
+
+// The kernels in use
+const KernelTable& ActiveKernels() noexcept;
+inline KernelIsa GetActiveKernelIsa() noexcept {
+  return ActiveKernels().isa;
+}
+
+// isa's kernels, for calling directly without switching; throws if the CPU does not support it
+const KernelTable& GetKernelTable(KernelIsa isa);
+
+// Switches every later kernel call to isa's kernels; throws if the CPU does not support it
+void SetKernelIsa(KernelIsa isa);
+
+#endif  // ASSIGNMENTS_EV_KERNEL_DISPATCH_H_
@@ -0,0 +1,159 @@
+/*
+
+  == Explanation and rational of testing ==
+  Every instruction set the test machine supports is switched in turn and compared against the
+  scalar kernels on lengths 0 to 70, which covers every combination of full vector blocks and
+  leftover elements. The element-wise kernels, the SSE4.2 reductions and the product quantisation
+  scans (on 1 to 9 sub-spaces, so that codes straddle every alignment) must match exactly; the
+  FMA reductions only to rounding. Instruction sets the machine lacks cannot be tested here beyond
+  checking that selecting them is refused. Each scenario restores the kernels it started with.
+
+*/
+
+#include "assignments/ev/kernel_dispatch.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/vector_kernels.h"
+#include "catch.h"
+
+namespace {
+
+std::vector<double> Values(int n, double seed) {
+  std::vector<double> values(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    values[static_cast<std::size_t>(i)] = std::sin(seed + 1.7 * i) * (1 + i % 5);
+  }
+  return values;
+}
+
+}  // namespace
+
+SCENARIO("Naming and detecting instruction sets") {
+  WHEN("You convert names both ways") {
+    THEN("They round trip, and an unknown name is an error") {
+      for (int isa = 0; isa <= static_cast<int>(KernelIsa::kAvx512); ++isa) {
+        REQUIRE(KernelIsaFromString(ToString(static_cast<KernelIsa>(isa))) ==
+                static_cast<KernelIsa>(isa));
+      }
+      REQUIRE(std::string(ToString(KernelIsa::kSse42)) == "sse4.2");
+      REQUIRE_THROWS_WITH(KernelIsaFromString("neon"), "Unknown kernel instruction set neon");
+    }
+  }
+  WHEN("You query the active kernels") {
+    THEN("They never exceed what the CPU supports") {
+      REQUIRE(GetActiveKernelIsa() <= DetectKernelIsa());
+    }
+  }
+}
+
+SCENARIO("Every supported instruction set agrees with the scalar kernels") {
+  const KernelIsa original = GetActiveKernelIsa();
+  WHEN("You switch to each supported instruction set in turn") {
+    THEN("Reductions agree to rounding and element-wise results exactly") {
+      for (int isa = 0; isa <= static_cast<int>(DetectKernelIsa()); ++isa) {
+        for (int n = 0; n <= 70; ++n) {
+          auto a = Values(n, 0.5);
+          auto b = Values(n, 2.0);
+          SetKernelIsa(KernelIsa::kScalar);
+          double dot = Dot(a.data(), b.data(), n);
+          double distance = SquaredDistance(a.data(), b.data(), n);
+          std::vector<double> sum(a.size()), difference(a.size()), scaled(a.size());
+          AddMagnitudes(a.data(), b.data(), sum.data(), n);
+          SubtractMagnitudes(a.data(), b.data(), difference.data(), n);
+          ScaleMagnitudes(a.data(), -0.3, scaled.data(), n);
+
+          SetKernelIsa(static_cast<KernelIsa>(isa));
+          INFO(ToString(GetActiveKernelIsa()) << " n=" << n);
+          if (GetActiveKernelIsa() <= KernelIsa::kSse42) {
+            REQUIRE(Dot(a.data(), b.data(), n) == dot);
+            REQUIRE(SquaredDistance(a.data(), b.data(), n) == distance);
+          } else {
+            REQUIRE(Dot(a.data(), b.data(), n) == Approx(dot).epsilon(1e-13).margin(1e-13));
+            REQUIRE(SquaredDistance(a.data(), b.data(), n) == Approx(distance).epsilon(1e-13));
+          }
+          std::vector<double> out(a.size());
+          AddMagnitudes(a.data(), b.data(), out.data(), n);
+          REQUIRE(out == sum);
+          SubtractMagnitudes(a.data(), b.data(), out.data(), n);
+          REQUIRE(out == difference);
+          ScaleMagnitudes(a.data(), -0.3, out.data(), n);
+          REQUIRE(out == scaled);
+          ScaleMagnitudes(a.data(), -0.3, a.data(), n);  // in place
+          REQUIRE(a == scaled);
+        }
+      }
+      SetKernelIsa(original);
+    }
+  }
+  WHEN("You scan product quantisation codes with each supported instruction set") {
+    std::vector<float> table(9 * kAdcTableStride);
+    for (std::size_t i = 0; i < table.size(); ++i) {
+      table[i] = static_cast<float>(std::sin(0.37 * static_cast<double>(i)) * 1e3);
+    }
+    THEN("Every scan gives exactly the scalar sums") {
+      for (std::size_t m = 1; m <= 9; ++m) {
+        for (std::size_t n = 0; n <= 70; ++n) {
+          std::vector<std::uint8_t> codes(n * m);
+          for (std::size_t i = 0; i < codes.size(); ++i) {
+            codes[i] = static_cast<std::uint8_t>(i * 97 + m);
+          }
+          std::vector<float> expected(n);
+          GetKernelTable(KernelIsa::kScalar)
+              .adc_scan(codes.data(), m, table.data(), expected.data(), n);
+          for (int isa = 0; isa <= static_cast<int>(DetectKernelIsa()); ++isa) {
+            INFO(ToString(static_cast<KernelIsa>(isa)) << " m=" << m << " n=" << n);
+            std::vector<float> distances(n);
+            GetKernelTable(static_cast<KernelIsa>(isa))
+                .adc_scan(codes.data(), m, table.data(), distances.data(), n);
+            REQUIRE(distances == expected);
+          }
+          if (n > 0) {
+            float sum = 0;
+            for (std::size_t s = 0; s < m; ++s) {
+              sum += table[s * kAdcTableStride + codes[(n - 1) * m + s]];
+            }
+            REQUIRE(expected[n - 1] == sum);
+          }
+        }
+      }
+    }
+  }
+  WHEN("You use EuclideanVector operators with the best kernels") {
+    auto a = Values(13, 0.1);
+    auto b = Values(13, 0.2);
+    EuclideanVector x{a.cbegin(), a.cend()};
+    EuclideanVector y{b.cbegin(), b.cend()};
+    SetKernelIsa(DetectKernelIsa());
+    EuclideanVector sum = x + y;
+    double dot = x * y;
+    SetKernelIsa(original);
+    THEN("The results match the definitions") {
+      for (int i = 0; i < 13; ++i) {
+        REQUIRE(sum[i] == a[static_cast<std::size_t>(i)] + b[static_cast<std::size_t>(i)]);
+      }
+      double expected = 0;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+        expected += a[i] * b[i];
+      }
+      REQUIRE(dot == Approx(expected));
+    }
+  }
+}
+
+// EXCEPTION - Kernels the CPU cannot run cannot be selected
+SCENARIO("Selecting an unsupported instruction set") {
+  WHEN("The CPU lacks AVX-512") {
+    THEN("Selecting it throws and leaves the active kernels alone") {
+      if (DetectKernelIsa() < KernelIsa::kAvx512) {
+        KernelIsa active = GetActiveKernelIsa();
+        REQUIRE_THROWS_WITH(SetKernelIsa(KernelIsa::kAvx512),
+                            "This CPU does not support avx512 kernels");
+        REQUIRE(GetActiveKernelIsa() == active);
+      }
+    }
+  }
+}
@@ -0,0 +1,377 @@
+#include "assignments/ev/kernel_fuzz.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+
+namespace {
+
+constexpr const char* kDistributionNames[] = {"uniform", "wide_range", "denormal", "huge",
+                                              "special"};
+constexpr int kNumDistributions = 5;
+
+// Kernels of a KernelTable in declaration order; the first two are reductions
+constexpr const char* kKernelNames[] = {"dot", "squared_distance", "add", "subtract", "scale"};
+constexpr int kNumKernels = 5;
+constexpr int kNumReductions = 2;
+
+// Doubles kept on each side of an operand (64 bytes, so the alignment is unchanged) and the bit
+//  pattern they hold, which element-wise kernels must leave alone
+constexpr std::size_t kGuard = 8;
+constexpr std::uint64_t kSentinelBits = 0x7ff4dead0000beefULL;  // a signalling NaN
+
+// Magnitudes each timing repetition runs through, so short vectors are called many times
+constexpr std::size_t kTimedMagnitudes = std::size_t{1} << 20;
+
+using Clock = std::chrono::steady_clock;
+
+std::uint64_t Bits(double value) noexcept {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof bits);
+  return bits;
+}
+
+double Draw(FuzzDistribution distribution, std::mt19937_64& rng) {
+  std::uniform_real_distribution<double> uniform{-1, 1};
+  std::uniform_real_distribution<double> mantissa{1, 2};
+  double sign = (rng() & 1) ? -1 : 1;
+  switch (distribution) {
+    case FuzzDistribution::kUniform:
+      return uniform(rng);
+    case FuzzDistribution::kWideRange:
+      return sign * std::ldexp(mantissa(rng), std::uniform_int_distribution<int>{-300, 300}(rng));
+    case FuzzDistribution::kDenormal:
+      if (rng() & 1) {
+        auto steps = std::uniform_int_distribution<std::int64_t>{1, (std::int64_t{1} << 52) - 1};
+        return sign * std::numeric_limits<double>::denorm_min() * static_cast<double>(steps(rng));
+      }
+      return sign * std::ldexp(mantissa(rng), std::uniform_int_distribution<int>{-1022, -990}(rng));
+    case FuzzDistribution::kHuge:
+      return sign * std::ldexp(mantissa(rng), std::uniform_int_distribution<int>{480, 1022}(rng));
+    case FuzzDistribution::kSpecial:
+    default: {
+      constexpr double kSpecials[] = {
+          std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(),
+          -std::numeric_limits<double>::infinity(), 0.0, -0.0,
+          std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max(),
+          std::numeric_limits<double>::lowest()};
+      if (rng() % 10 != 0) {
+        return uniform(rng);
+      }
+      return kSpecials[rng() % (sizeof kSpecials / sizeof kSpecials[0])];
+    }
+  }
+}
+
+// n doubles starting offset doubles past a 64-byte boundary, with kGuard sentinels either side
+struct Operand {
+  std::vector<double> storage;
+  double* data;
+};
+
+Operand MakeOperand(std::size_t n, std::size_t offset) {
+  Operand operand;
+  operand.storage.resize(n + offset + 2 * kGuard + 8);
+  auto address = reinterpret_cast<std::uintptr_t>(operand.storage.data());
+  std::size_t skip = (64 - address % 64) % 64 / sizeof(double);
+  operand.data = operand.storage.data() + skip + kGuard + offset;
+  double sentinel;
+  std::memcpy(&sentinel, &kSentinelBits, sizeof sentinel);
+  std::fill(operand.storage.begin(), operand.storage.end(), sentinel);
+  return operand;
+}
+
+bool GuardsIntact(const Operand& operand, std::size_t n) noexcept {
+  for (std::size_t i = 1; i <= kGuard; ++i) {
+    if (Bits(operand.data[-static_cast<std::ptrdiff_t>(i)]) != kSentinelBits ||
+        Bits(operand.data[n + i - 1]) != kSentinelBits) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs kernel from table; reductions return their result, element-wise kernels 0
+double RunKernel(const KernelTable& table,
+                 int kernel,
+                 const double* a,
+                 const double* b,
+                 double s,
+                 double* out,
+                 std::size_t n) noexcept {
+  switch (kernel) {
+    case 0:
+      return table.dot(a, b, n);
+    case 1:
+      return table.squared_distance(a, b, n);
+    case 2:
+      table.add(a, b, out, n);
+      break;
+    case 3:
+      table.subtract(a, b, out, n);
+      break;
+    default:
+      table.scale(a, s, out, n);
+      break;
+  }
+  return 0;
+}
+
+// Sum of the absolute values of the terms the reduction adds up; its rounding error grows with
+//  this rather than with the result, which cancellation can make arbitrarily small
+double TermScale(int kernel, const double* a, const double* b, std::size_t n) noexcept {
+  double sum = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    double term = kernel == 0 ? a[i] * b[i] : (a[i] - b[i]) * (a[i] - b[i]);
+    sum += std::fabs(term);
+  }
+  return sum;
+}
+
+// Spacing of doubles at x >= 0
+double UlpOf(double x) noexcept {
+  if (x == 0) {
+    return std::numeric_limits<double>::denorm_min();
+  }
+  double up = std::nextafter(x, std::numeric_limits<double>::infinity());
+  return std::isinf(up) ? x - std::nextafter(x, 0.0) : up - x;
+}
+
+bool AnyNaN(const double* a, std::size_t n) noexcept {
+  return std::any_of(a, a + n, [](double value) { return std::isnan(value); });
+}
+
+// Whether some summation order of a reduction can give actual, for NaN-free inputs whose sum of
+//  absolute terms overflows. A term made infinite by an infinite input (or by a - b overflowing)
+//  stays infinite in any order and when fused, whereas where finite terms overflow depends on
+//  both, so:
+//  - an invalid term (0 * inf, inf - inf) or infinite terms of both signs give NaN
+//  - infinite terms of one sign give that infinity, or NaN if terms of the other sign exist
+//  - finite terms of one sign give a result of that sign, infinite or close to it
+//  Finite terms of both signs can overflow and cancel in any order, so any result is possible.
+bool OverflowPossible(int kernel,
+                      const double* a,
+                      const double* b,
+                      std::size_t n,
+                      double actual) noexcept {
+  bool invalid = false;
+  bool positive[2] = {false, false};  // finite, infinite
+  bool negative[2] = {false, false};
+  for (std::size_t i = 0; i < n; ++i) {
+    double term = kernel == 0 ? a[i] * b[i] : a[i] - b[i];
+    bool infinite = kernel == 0 ? std::isinf(a[i]) || std::isinf(b[i]) : std::isinf(term);
+    if (kernel != 0) {
+      term = std::fabs(term);  // the sign of the square, without its overflow
+    }
+    if (std::isnan(term)) {
+      invalid = true;
+    } else if (term > 0) {
+      positive[infinite] = true;
+    } else if (term < 0) {
+      negative[infinite] = true;
+    }
+  }
+  if (invalid || (positive[1] && negative[1])) {
+    return std::isnan(actual);
+  }
+  if (positive[1] || negative[1]) {
+    double infinity = positive[1] ? std::numeric_limits<double>::infinity()
+                                  : -std::numeric_limits<double>::infinity();
+    return actual == infinity || (std::isnan(actual) && (positive[1] ? negative[0] : positive[0]));
+  }
+  if (positive[0] != negative[0]) {
+    return positive[0] ? actual > 0 : actual < 0;
+  }
+  return true;
+}
+
+std::string Describe(FuzzDistribution distribution,
+                     std::size_t n,
+                     const std::size_t (&offsets)[3],
+                     bool in_place) {
+  std::ostringstream os;
+  os << ToString(distribution) << " n=" << n << " offsets=" << offsets[0] << "/" << offsets[1]
+     << "/" << offsets[2] << (in_place ? " in place" : "");
+  return os.str();
+}
+
+// Best per call time of kernel from table over the repetitions
+double TimeKernel(const KernelTable& table,
+                  int kernel,
+                  const std::vector<double>& a,
+                  const std::vector<double>& b,
+                  std::vector<double>& out,
+                  std::size_t calls,
+                  int repetitions) {
+  double best = std::numeric_limits<double>::infinity();
+  volatile double sink = 0;
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = Clock::now();
+    double total = 0;
+    for (std::size_t c = 0; c < calls; ++c) {
+      total += RunKernel(table, kernel, a.data(), b.data(), 1.5, out.data(), a.size());
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    sink = sink + total;
+    best = std::min(best, elapsed.count() / static_cast<double>(calls));
+  }
+  return best;
+}
+
+}  // namespace
+
+const char* ToString(FuzzDistribution distribution) noexcept {
+  return kDistributionNames[static_cast<int>(distribution)];
+}
+
+double UlpDistance(double a, double b) noexcept {
+  if (std::isnan(a) || std::isnan(b)) {
+    return std::isnan(a) && std::isnan(b) ? 0 : std::numeric_limits<double>::infinity();
+  }
+  // Maps doubles to integers in the same order, with -0 and +0 both on 0
+  auto ordered = [](double value) {
+    auto bits = static_cast<std::int64_t>(Bits(value));
+    return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+  };
+  std::int64_t x = ordered(a);
+  std::int64_t y = ordered(b);
+  return x > y ? static_cast<double>(static_cast<std::uint64_t>(x) - static_cast<std::uint64_t>(y))
+               : static_cast<double>(static_cast<std::uint64_t>(y) - static_cast<std::uint64_t>(x));
+}
+
+std::vector<KernelFuzzResult> FuzzKernels(const KernelTable& candidate,
+                                          const KernelFuzzParams& params) {
+  const KernelTable& scalar = GetKernelTable(KernelIsa::kScalar);
+  std::vector<KernelFuzzResult> results;
+  for (int kernel = 0; kernel < kNumKernels; ++kernel) {
+    KernelFuzzResult result{kKernelNames[kernel], candidate.isa, 0, 0, 0, ""};
+    // Each kernel has its own stream so its cases do not depend on the kernels before it
+    std::mt19937_64 rng{params.seed * kNumKernels + static_cast<std::uint64_t>(kernel)};
+    for (int c = 0; c < params.cases; ++c) {
+      auto distribution = static_cast<FuzzDistribution>(c % kNumDistributions);
+      std::size_t n = std::uniform_int_distribution<std::size_t>{0, params.max_dimensions}(rng);
+      std::size_t offsets[3] = {rng() % 8, rng() % 8, rng() % 8};
+      bool in_place = kernel >= kNumReductions && rng() % 4 == 0;
+      Operand a = MakeOperand(n, offsets[0]);
+      Operand b = MakeOperand(n, offsets[1]);
+      Operand out = MakeOperand(n, offsets[2]);
+      for (std::size_t i = 0; i < n; ++i) {
+        a.data[i] = Draw(distribution, rng);
+        b.data[i] = Draw(distribution, rng);
+      }
+      double s = Draw(distribution, rng);
+      ++result.cases;
+
+      bool ok = true;
+      std::ostringstream failure;
+      failure << std::setprecision(17);
+      if (kernel < kNumReductions) {
+        double expected = RunKernel(scalar, kernel, a.data, b.data, s, nullptr, n);
+        double actual = RunKernel(candidate, kernel, a.data, b.data, s, nullptr, n);
+        double scale = TermScale(kernel, a.data, b.data, n);
+        if (AnyNaN(a.data, n) || AnyNaN(b.data, n)) {
+          ok = std::isnan(expected) && std::isnan(actual);
+        } else if (std::isfinite(scale)) {
+          // Without overflow both results are finite and within the rounding bound
+          double ulps = std::fabs(actual - expected) / UlpOf(scale);
+          ok = std::isfinite(actual) && ulps <= params.ulps_per_dimension * static_cast<double>(n);
+          if (std::isfinite(ulps)) {
+            result.max_ulps = std::max(result.max_ulps, ulps);
+          }
+        } else {
+          // Some partial sum overflows, and where depends on the order of the additions
+          ok = OverflowPossible(kernel, a.data, b.data, n, actual);
+        }
+        failure << ": scalar " << expected << ", " << ToString(candidate.isa) << " " << actual;
+      } else {
+        std::vector<double> expected(n);
+        RunKernel(scalar, kernel, a.data, b.data, s, expected.data(), n);
+        Operand& target = in_place ? a : out;
+        RunKernel(candidate, kernel, a.data, b.data, s, target.data, n);
+        for (std::size_t i = 0; i < n && ok; ++i) {
+          double x = target.data[i];
+          result.max_ulps = std::max(result.max_ulps, UlpDistance(x, expected[i]));
+          // Exact, down to the sign of zero; any NaN matches any other
+          if (Bits(x) != Bits(expected[i]) && !(std::isnan(x) && std::isnan(expected[i]))) {
+            ok = false;
+            failure << ": element " << i << " scalar " << expected[i] << ", "
+                    << ToString(candidate.isa) << " " << x;
+          }
+        }
+        if (ok && !GuardsIntact(target, n)) {
+          ok = false;
+          failure << ": wrote outside the output";
+        }
+      }
+      if (!ok) {
+        if (result.failures++ == 0) {
+          result.first_failure = Describe(distribution, n, offsets, in_place) + failure.str();
+        }
+      }
+    }
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+std::vector<KernelTiming> TimeKernels(const KernelTable& candidate,
+                                      const std::vector<std::size_t>& dimensions,
+                                      int repetitions) {
+  const KernelTable& scalar = GetKernelTable(KernelIsa::kScalar);
+  std::vector<KernelTiming> timings;
+  std::mt19937_64 rng{1};
+  for (std::size_t n : dimensions) {
+    std::vector<double> a(n), b(n), out(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      a[i] = Draw(FuzzDistribution::kUniform, rng);
+      b[i] = Draw(FuzzDistribution::kUniform, rng);
+    }
+    std::size_t calls = std::max<std::size_t>(kTimedMagnitudes / std::max<std::size_t>(n, 1), 1);
+    for (int kernel = 0; kernel < kNumKernels; ++kernel) {
+      double scalar_ns = TimeKernel(scalar, kernel, a, b, out, calls, repetitions);
+      double ns = TimeKernel(candidate, kernel, a, b, out, calls, repetitions);
+      timings.push_back({kKernelNames[kernel], candidate.isa, n, scalar_ns, ns});
+    }
+  }
+  return timings;
+}
+
+void WriteKernelReport(std::ostream& os,
+                       const std::vector<KernelFuzzResult>& results,
+                       const std::vector<KernelTiming>& timings) {
+  std::ios_base::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::left << std::setw(18) << "kernel" << std::setw(8) << "isa" << std::right
+     << std::setw(8) << "cases" << std::setw(10) << "failures" << std::setw(12) << "max ulps"
+     << '\n';
+  for (const KernelFuzzResult& result : results) {
+    os << std::left << std::setw(18) << result.kernel << std::setw(8) << ToString(result.isa)
+       << std::right << std::setw(8) << result.cases << std::setw(10) << result.failures
+       << std::setw(12) << std::fixed << std::setprecision(1) << result.max_ulps << '\n';
+  }
+  for (const KernelFuzzResult& result : results) {
+    if (result.failures > 0) {
+      os << result.kernel << " first failure: " << result.first_failure << '\n';
+    }
+  }
+  if (!timings.empty()) {
+    os << '\n'
+       << std::left << std::setw(18) << "kernel" << std::setw(8) << "isa" << std::right
+       << std::setw(12) << "dimensions" << std::setw(14) << "scalar ns" << std::setw(14) << "ns"
+       << std::setw(10) << "speedup" << '\n';
+  }
+  for (const KernelTiming& timing : timings) {
+    os << std::left << std::setw(18) << timing.kernel << std::setw(8) << ToString(timing.isa)
+       << std::right << std::setw(12) << timing.dimensions << std::fixed << std::setprecision(1)
+       << std::setw(14) << timing.scalar_ns << std::setw(14) << timing.ns << std::setprecision(2)
+       << std::setw(9) << timing.Speedup() << "x\n";
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
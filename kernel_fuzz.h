@@ -0,0 +1,88 @@
+#ifndef ASSIGNMENTS_EV_KERNEL_FUZZ_H_
+#define ASSIGNMENTS_EV_KERNEL_FUZZ_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "assignments/ev/kernel_dispatch.h"
+
+// Differential testing of optimised kernels against the scalar ones.
+//  FuzzKernels runs every kernel of a KernelTable and of the scalar table on the same random
+//  inputs: random lengths, random offsets from a 64-byte boundary for each operand, in-place and
+//  out-of-place outputs, and magnitudes drawn from the distributions below. Element-wise kernels
+//  must match exactly and must not write past their output. Reductions are allowed to differ by
+//  rounding: since both sides may reorder and fuse the additions, the bound is a number of ULPs
+//  of the sum of the terms' absolute values per dimension, which is how far any summation order
+//  can drift. Where that sum overflows, a reduction must still give the NaN, the infinity or the
+//  sign that every summation order would. TimeKernels then measures both tables side by side.
+
+// Distributions the fuzzer draws magnitudes from
+//  kUniform   - uniform in [-1, 1]
+//  kWideRange - random sign and exponents from 2^-300 to 2^300, so terms differ wildly in scale
+//  kDenormal  - subnormals and values just above the smallest normal, so products underflow
+//  kHuge      - exponents from 2^480 up to the largest double, so products and sums overflow
+//  kSpecial   - mostly uniform, with NaN, infinities, signed zeros and the extreme finite values
+enum class FuzzDistribution { kUniform, kWideRange, kDenormal, kHuge, kSpecial };
+
+const char* ToString(FuzzDistribution distribution) noexcept;
+
+// Settings for FuzzKernels
+//  seed                - seed for the inputs; the same seed reproduces the same cases
+//  cases               - random inputs per kernel, cycling through the distributions
+//  max_dimensions      - lengths are drawn from 0 to max_dimensions
+//  ulps_per_dimension  - reductions may differ from the scalar ones by this many ULPs of the sum
+//                        of absolute terms per dimension (the worst case for two summation orders
+//                        is about 2, plus 1 for products that underflow differently when fused)
+struct KernelFuzzParams {
+  std::uint64_t seed = 1;
+  int cases = 2000;
+  std::size_t max_dimensions = 257;
+  double ulps_per_dimension = 3;
+};
+
+// Outcome of fuzzing one kernel
+//  max_ulps      - largest difference from the scalar kernel on a case that was checked; for
+//                  reductions in ULPs of the sum of absolute terms
+//  first_failure - the first failing case, with its inputs' shape and both results; empty if none
+struct KernelFuzzResult {
+  std::string kernel;
+  KernelIsa isa;
+  int cases;
+  int failures;
+  double max_ulps;
+  std::string first_failure;
+};
+
+// Per call time of one kernel on vectors of the given dimensions, best of the repetitions
+struct KernelTiming {
+  std::string kernel;
+  KernelIsa isa;
+  std::size_t dimensions;
+  double scalar_ns;
+  double ns;
+
+  double Speedup() const noexcept { return this->scalar_ns / this->ns; }
+};
+
+// Number of representable doubles between a and b: 0 if they are equal (including +0 and -0) or
+//  both NaN, infinite if only one is NaN
+double UlpDistance(double a, double b) noexcept;
+
+// Compares every kernel of candidate with the scalar kernels, one result per kernel
+std::vector<KernelFuzzResult> FuzzKernels(const KernelTable& candidate,
+                                          const KernelFuzzParams& params = KernelFuzzParams{});
+
+// Times every kernel of candidate and of the scalar table at each of the dimensions
+std::vector<KernelTiming> TimeKernels(const KernelTable& candidate,
+                                      const std::vector<std::size_t>& dimensions,
+                                      int repetitions = 5);
+
+// Writes the fuzz results and the timings as two aligned tables
+void WriteKernelReport(std::ostream& os,
+                       const std::vector<KernelFuzzResult>& results,
+                       const std::vector<KernelTiming>& timings);
+
+#endif  // ASSIGNMENTS_EV_KERNEL_FUZZ_H_
@@ -0,0 +1,135 @@
+/*
+
+  == Explanation and rational of testing ==
+  The harness is only useful if it passes correct kernels and catches wrong ones, so both are
+  tested: every instruction set the test machine supports is fuzzed and must have no failures,
+  while tables with a deliberately wrong kernel (an off-by-one write, a dropped term, a lost sign
+  of zero, an overflow saturated to a finite value) must each be reported with their first
+  failing case. UlpDistance is checked on the
+  values the bounds hinge on, and the timings and report only for their shape, since speed
+  depends on the machine.
+
+*/
+
+#include "assignments/ev/kernel_fuzz.h"
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "catch.h"
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+const KernelFuzzResult& Result(const std::vector<KernelFuzzResult>& results,
+                               const std::string& kernel) {
+  for (const KernelFuzzResult& result : results) {
+    if (result.kernel == kernel) {
+      return result;
+    }
+  }
+  FAIL("No result for " << kernel);
+  return results.front();
+}
+
+}  // namespace
+
+SCENARIO("Distances in ULPs") {
+  WHEN("You compare neighbouring, equal and special doubles") {
+    THEN("The distance counts the doubles between them") {
+      REQUIRE(UlpDistance(1, 1) == 0);
+      REQUIRE(UlpDistance(1, std::nextafter(1.0, 2.0)) == 1);
+      REQUIRE(UlpDistance(0.0, -0.0) == 0);
+      REQUIRE(UlpDistance(std::numeric_limits<double>::denorm_min(),
+                          -std::numeric_limits<double>::denorm_min()) == 2);
+      REQUIRE(UlpDistance(std::numeric_limits<double>::max(), kInf) == 1);
+      REQUIRE(UlpDistance(std::nan(""), std::nan("")) == 0);
+      REQUIRE(UlpDistance(std::nan(""), 1) == kInf);
+    }
+  }
+}
+
+SCENARIO("Fuzzing the supported instruction sets") {
+  WHEN("You fuzz every instruction set the CPU supports twice with the same seed") {
+    KernelFuzzParams params;
+    params.cases = 500;
+    std::vector<std::vector<KernelFuzzResult>> runs;
+    for (int isa = 0; isa <= static_cast<int>(DetectKernelIsa()); ++isa) {
+      runs.push_back(FuzzKernels(GetKernelTable(static_cast<KernelIsa>(isa)), params));
+    }
+    auto again = FuzzKernels(GetKernelTable(DetectKernelIsa()), params);
+    THEN("Every kernel passes every case, and the runs repeat") {
+      for (const auto& results : runs) {
+        REQUIRE(results.size() == 5);
+        for (const KernelFuzzResult& result : results) {
+          INFO(result.kernel << " " << ToString(result.isa) << ": " << result.first_failure);
+          REQUIRE(result.cases == 500);
+          REQUIRE(result.failures == 0);
+        }
+        REQUIRE(Result(results, "add").max_ulps == 0);
+        REQUIRE(Result(results, "scale").max_ulps == 0);
+      }
+      REQUIRE(Result(runs[0], "dot").max_ulps == 0);  // scalar against itself
+      REQUIRE(Result(again, "dot").max_ulps == Result(runs.back(), "dot").max_ulps);
+    }
+  }
+}
+
+SCENARIO("Fuzzing broken kernels") {
+  WHEN("You fuzz kernels that overrun, drop a term, lose the sign of zero or saturate") {
+    KernelTable broken = GetKernelTable(KernelIsa::kScalar);
+    broken.add = [](const double* a, const double* b, double* out, std::size_t n) noexcept {
+      for (std::size_t i = 0; i <= n; ++i) {
+        out[i] = a[i] + b[i];
+      }
+    };
+    broken.dot = [](const double* a, const double* b, std::size_t n) noexcept {
+      return n < 2 ? GetKernelTable(KernelIsa::kScalar).dot(a, b, n)
+                   : GetKernelTable(KernelIsa::kScalar).dot(a, b, n - 1);
+    };
+    broken.scale = [](const double* a, double s, double* out, std::size_t n) noexcept {
+      for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] * s + 0.0;
+      }
+    };
+    broken.squared_distance = [](const double* a, const double* b, std::size_t n) noexcept {
+      double result = GetKernelTable(KernelIsa::kScalar).squared_distance(a, b, n);
+      return std::isinf(result) ? std::numeric_limits<double>::max() : result;
+    };
+    KernelFuzzParams params;
+    params.cases = 200;
+    auto results = FuzzKernels(broken, params);
+    std::ostringstream report;
+    WriteKernelReport(report, results, {});
+    THEN("Each is reported with its first failing case, and the others pass") {
+      REQUIRE(Result(results, "add").failures > 0);
+      REQUIRE(Result(results, "add").first_failure.find("wrote outside the output") !=
+              std::string::npos);
+      REQUIRE(Result(results, "dot").failures > 0);
+      REQUIRE(Result(results, "scale").failures > 0);
+      REQUIRE(Result(results, "squared_distance").failures > 0);
+      REQUIRE(Result(results, "subtract").failures == 0);
+      REQUIRE(report.str().find("dot first failure: ") != std::string::npos);
+    }
+  }
+}
+
+SCENARIO("Timing kernels side by side") {
+  WHEN("You time the best kernels at two lengths") {
+    auto timings = TimeKernels(GetKernelTable(DetectKernelIsa()), {16, 1000}, 1);
+    std::ostringstream report;
+    WriteKernelReport(report, FuzzKernels(GetKernelTable(DetectKernelIsa()), {1, 10}), timings);
+    THEN("Every kernel has a positive time at each length in the report") {
+      REQUIRE(timings.size() == 10);
+      for (const KernelTiming& timing : timings) {
+        REQUIRE(timing.scalar_ns > 0);
+        REQUIRE(timing.ns > 0);
+      }
+      REQUIRE(timings[9].kernel == "scale");
+      REQUIRE(timings[9].dimensions == 1000);
+      REQUIRE(report.str().find("speedup") != std::string::npos);
+    }
+  }
+}
@@ -0,0 +1,333 @@
+#include "assignments/ev/kmeans.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "assignments/ev/parallel_for.h"
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+// Vectors per thread below which spawning another thread costs more than it saves
+constexpr std::size_t kMinVectorsPerThread = 1024;
+
+// Per-thread partial sums for the centroid update, merged once the assignment step is done
+struct Accumulator {
+  std::vector<double> sums;
+  std::vector<std::size_t> counts;
+  bool changed = false;
+
+  void Reset(std::size_t k, int dims) {
+    this->sums.assign(k * static_cast<std::size_t>(dims), 0.0);
+    this->counts.assign(k, 0);
+    this->changed = false;
+  }
+
+  void Add(std::size_t c, const double* v, int dims) noexcept {
+    double* sum = &this->sums[c * static_cast<std::size_t>(dims)];
+    for (int j = 0; j < dims; ++j) {
+      sum[j] += v[j];
+    }
+    ++this->counts[c];
+  }
+};
+
+// Folds every thread's accumulator into the first one
+void Merge(std::vector<Accumulator>& accumulators) {
+  Accumulator& total = accumulators.front();
+  for (std::size_t t = 1; t < accumulators.size(); ++t) {
+    const Accumulator& a = accumulators[t];
+    for (std::size_t i = 0; i < total.sums.size(); ++i) {
+      total.sums[i] += a.sums[i];
+    }
+    for (std::size_t c = 0; c < total.counts.size(); ++c) {
+      total.counts[c] += a.counts[c];
+    }
+    total.changed = total.changed || a.changed;
+  }
+}
+
+// Finds the nearest and second nearest centroids to v (euclidean, not squared, distances)
+void NearestTwo(const EuclideanVectorBatch& centroids,
+                const double* v,
+                std::size_t* best,
+                double* first,
+                double* second) noexcept {
+  double d1 = std::numeric_limits<double>::infinity();
+  double d2 = d1;
+  for (std::size_t c = 0; c < centroids.size(); ++c) {
+    double d = SquaredDistance(centroids.Row(c), v, centroids.GetNumDimensions());
+    if (d < d1) {
+      d2 = d1;
+      d1 = d;
+      *best = c;
+    } else if (d < d2) {
+      d2 = d;
+    }
+  }
+  *first = std::sqrt(d1);
+  *second = std::sqrt(d2);
+}
+
+EuclideanVectorBatch InitialCentroids(const EuclideanVectorBatch& data,
+                                      std::size_t k,
+                                      const KMeansParams& params,
+                                      int threads,
+                                      std::mt19937& rng) {
+  const std::size_t n = data.size();
+  const int dims = data.GetNumDimensions();
+  EuclideanVectorBatch centroids{dims};
+  centroids.Reserve(k);
+
+  if (params.init == KMeansInit::kRandom) {
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    for (std::size_t c = 0; c < k; ++c) {
+      centroids.Add(data.Row(order[c]));
+    }
+    return centroids;
+  }
+
+  // k-means++: distances[i] holds the squared distance from vector i to its closest centroid
+  std::vector<double> distances(n, std::numeric_limits<double>::infinity());
+  std::size_t next = std::uniform_int_distribution<std::size_t>{0, n - 1}(rng);
+  while (true) {
+    centroids.Add(data.Row(next));
+    if (centroids.size() == k) {
+      break;
+    }
+
+    const double* centroid = data.Row(next);
+    ParallelFor(n, threads, [&](std::size_t, std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        distances[i] = std::min(distances[i], SquaredDistance(data.Row(i), centroid, dims));
+      }
+    });
+
+    double total = std::accumulate(distances.begin(), distances.end(), 0.0);
+    if (total <= 0) {
+      next = std::uniform_int_distribution<std::size_t>{0, n - 1}(rng);
+      continue;
+    }
+    double target = std::uniform_real_distribution<double>{0.0, total}(rng);
+    next = n - 1;
+    for (std::size_t i = 0; i < n; ++i) {
+      target -= distances[i];
+      if (target < 0 && distances[i] > 0) {
+        next = i;
+        break;
+      }
+    }
+  }
+  return centroids;
+}
+
+// Assigns every vector to its nearest centroid and returns the total squared distance
+double AssignAll(const EuclideanVectorBatch& data,
+                 const EuclideanVectorBatch& centroids,
+                 std::vector<std::size_t>& assignments,
+                 int threads) {
+  std::vector<double> inertia(static_cast<std::size_t>(threads), 0.0);
+  ParallelFor(data.size(), threads, [&](std::size_t t, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      double d = 0;
+      assignments[i] = NearestCentroid(centroids, data.Row(i), &d);
+      inertia[t] += d;
+    }
+  });
+  return std::accumulate(inertia.begin(), inertia.end(), 0.0);
+}
+
+// Lloyd's algorithm with Hamerly's bounds. upper[i] bounds the distance from vector i to its own
+//  centroid from above and lower[i] bounds the distance to every other centroid from below; when
+//  upper[i] <= max(lower[i], half the gap from its centroid to the nearest other centroid) the
+//  vector cannot change cluster and its k distance computations are skipped.
+int Lloyd(const EuclideanVectorBatch& data,
+          const KMeansParams& params,
+          int threads,
+          KMeansResult& result) {
+  const std::size_t n = data.size();
+  const std::size_t k = result.centroids.size();
+  const int dims = data.GetNumDimensions();
+
+  std::vector<double> upper(n, std::numeric_limits<double>::infinity());
+  std::vector<double> lower(n, 0.0);
+  std::vector<double> half_gap(k, 0.0);
+  std::vector<double> moved(k, 0.0);
+  std::vector<double> previous(static_cast<std::size_t>(dims));
+  std::vector<Accumulator> accumulators(static_cast<std::size_t>(threads));
+
+  int iteration = 1;
+  for (; iteration <= params.max_iterations; ++iteration) {
+    if (params.prune) {
+      for (std::size_t c = 0; c < k; ++c) {
+        double gap = std::numeric_limits<double>::infinity();
+        for (std::size_t o = 0; o < k; ++o) {
+          if (o != c) {
+            gap = std::min(gap, SquaredDistance(result.centroids.Row(c), result.centroids.Row(o),
+                                                dims));
+          }
+        }
+        half_gap[c] = std::sqrt(gap) / 2;
+      }
+    }
+
+    ParallelFor(n, threads, [&](std::size_t t, std::size_t begin, std::size_t end) {
+      Accumulator& acc = accumulators[t];
+      acc.Reset(k, dims);
+      for (std::size_t i = begin; i < end; ++i) {
+        const double* v = data.Row(i);
+        std::size_t a = result.assignments[i];
+        if (a < k && params.prune) {
+          double bound = std::max(half_gap[a], lower[i]);
+          if (upper[i] > bound) {
+            upper[i] = std::sqrt(SquaredDistance(v, result.centroids.Row(a), dims));
+          }
+          if (upper[i] <= bound) {
+            acc.Add(a, v, dims);
+            continue;
+          }
+        }
+        std::size_t best = 0;
+        NearestTwo(result.centroids, v, &best, &upper[i], &lower[i]);
+        acc.changed = acc.changed || best != a;
+        result.assignments[i] = best;
+        acc.Add(best, v, dims);
+      }
+    });
+
+    Merge(accumulators);
+    const Accumulator& total = accumulators.front();
+    if (!total.changed) {
+      break;
+    }
+
+    // Move each centroid to the mean of its cluster; an empty cluster takes the vector that is
+    //  (by its upper bound) furthest from its centroid
+    double max_moved = 0;
+    for (std::size_t c = 0; c < k; ++c) {
+      double* centroid = result.centroids.Row(c);
+      std::copy(centroid, centroid + dims, previous.begin());
+      if (total.counts[c] == 0) {
+        std::size_t furthest = n;
+        for (std::size_t i = 0; i < n; ++i) {
+          if (std::isfinite(upper[i]) && (furthest == n || upper[i] > upper[furthest])) {
+            furthest = i;
+          }
+        }
+        if (furthest < n) {
+          std::copy(data.Row(furthest), data.Row(furthest) + dims, centroid);
+          upper[furthest] = std::numeric_limits<double>::infinity();  // forces a full re-check
+          lower[furthest] = 0;
+        }
+      } else {
+        const double* sum = &total.sums[c * static_cast<std::size_t>(dims)];
+        for (int j = 0; j < dims; ++j) {
+          centroid[j] = sum[j] / static_cast<double>(total.counts[c]);
+        }
+      }
+      moved[c] = std::sqrt(SquaredDistance(previous.data(), centroid, dims));
+      max_moved = std::max(max_moved, moved[c]);
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+      upper[i] += moved[result.assignments[i]];
+      lower[i] = std::max(lower[i] - max_moved, 0.0);
+    }
+  }
+  return std::min(iteration, params.max_iterations);
+}
+
+// Mini-batch k-means: every iteration assigns batch_size sampled vectors and moves each centroid
+//  to the running mean of all the samples it has ever been assigned
+int MiniBatch(const EuclideanVectorBatch& data,
+              const KMeansParams& params,
+              int threads,
+              std::mt19937& rng,
+              KMeansResult& result) {
+  const std::size_t k = result.centroids.size();
+  const int dims = data.GetNumDimensions();
+  std::uniform_int_distribution<std::size_t> pick{0, data.size() - 1};
+  std::vector<std::size_t> batch(params.batch_size);
+  std::vector<double> seen(k, 0.0);
+  std::vector<Accumulator> accumulators(static_cast<std::size_t>(threads));
+
+  for (int iteration = 1; iteration <= params.max_iterations; ++iteration) {
+    for (std::size_t& i : batch) {
+      i = pick(rng);
+    }
+    ParallelFor(batch.size(), threads, [&](std::size_t t, std::size_t begin, std::size_t end) {
+      Accumulator& acc = accumulators[t];
+      acc.Reset(k, dims);
+      for (std::size_t b = begin; b < end; ++b) {
+        const double* v = data.Row(batch[b]);
+        acc.Add(NearestCentroid(result.centroids, v), v, dims);
+      }
+    });
+
+    Merge(accumulators);
+    const Accumulator& total = accumulators.front();
+    for (std::size_t c = 0; c < k; ++c) {
+      if (total.counts[c] == 0) {
+        continue;
+      }
+      double* centroid = result.centroids.Row(c);
+      const double* sum = &total.sums[c * static_cast<std::size_t>(dims)];
+      double count = seen[c] + static_cast<double>(total.counts[c]);
+      for (int j = 0; j < dims; ++j) {
+        centroid[j] = (centroid[j] * seen[c] + sum[j]) / count;
+      }
+      seen[c] = count;
+    }
+  }
+  return params.max_iterations;
+}
+
+}  // namespace
+
+/* FUNCTIONS */
+// Picks the initial centroids, then refines them with full Lloyd iterations or mini-batches.
+//  The final assignments and inertia are always computed exactly over every vector.
+KMeansResult KMeans(const EuclideanVectorBatch& data, const KMeansParams& params) {
+  const std::size_t n = data.size();
+  const std::size_t k = std::min(params.k, n);
+  if (k == 0) {
+    throw EuclideanVectorError("KMeans needs k > 0 and at least one vector");
+  }
+
+  std::mt19937 rng{params.seed};
+  int threads = NumThreads(params.num_threads, n, kMinVectorsPerThread);
+  KMeansResult result{InitialCentroids(data, k, params, threads, rng),
+                      std::vector<std::size_t>(n, k), 0, 0};
+
+  if (params.batch_size > 0) {
+    int batch_threads = NumThreads(params.num_threads, params.batch_size, kMinVectorsPerThread);
+    result.iterations = MiniBatch(data, params, batch_threads, rng, result);
+  } else {
+    result.iterations = Lloyd(data, params, threads, result);
+  }
+  result.inertia = AssignAll(data, result.centroids, result.assignments, threads);
+  return result;
+}
+
+std::size_t NearestCentroid(const EuclideanVectorBatch& centroids,
+                            const double* v,
+                            double* distance) noexcept {
+  std::size_t best = 0;
+  double best_distance = std::numeric_limits<double>::infinity();
+  for (std::size_t c = 0; c < centroids.size(); ++c) {
+    double d = SquaredDistance(centroids.Row(c), v, centroids.GetNumDimensions());
+    if (d < best_distance) {
+      best_distance = d;
+      best = c;
+    }
+  }
+  if (distance != nullptr) {
+    *distance = best_distance;
+  }
+  return best;
+}
@@ -0,0 +1,51 @@
+#ifndef ASSIGNMENTS_EV_KMEANS_H_
+#define ASSIGNMENTS_EV_KMEANS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// How the initial centroids are picked
+//  kRandom   - k distinct vectors uniformly at random
+//  kPlusPlus - k-means++: each next centroid is drawn with probability proportional to its squared
+//              distance from the centroids picked so far
+enum class KMeansInit { kRandom, kPlusPlus };
+
+// Settings for KMeans
+//  k              - number of clusters (clamped to the number of vectors)
+//  max_iterations - Lloyd iterations (or mini-batches) before stopping
+//  seed           - seed for initialisation and mini-batch sampling
+//  init           - initialisation scheme
+//  batch_size     - 0 runs full Lloyd iterations; otherwise each iteration updates the centroids
+//                   from batch_size randomly sampled vectors (mini-batch k-means)
+//  num_threads    - threads for the assignment step (<= 0 means one per hardware thread)
+//  prune          - skip distance computations that the triangle inequality proves unnecessary
+//                   (Hamerly's bounds; full Lloyd only, the result is unchanged)
+struct KMeansParams {
+  std::size_t k = 8;
+  int max_iterations = 25;
+  std::uint32_t seed = 100;
+  KMeansInit init = KMeansInit::kPlusPlus;
+  std::size_t batch_size = 0;
+  int num_threads = 0;
+  bool prune = true;
+};
+
+struct KMeansResult {
+  EuclideanVectorBatch centroids;
+  std::vector<std::size_t> assignments;  // assignments[i] = cluster of the i-th vector
+  double inertia;                        // sum of squared distances to the assigned centroids
+  int iterations;
+};
+
+// Clusters the vectors of data into params.k clusters
+KMeansResult KMeans(const EuclideanVectorBatch& data, const KMeansParams& params);
+
+// Returns the index of the centroid closest to v and stores the squared distance in distance
+std::size_t NearestCentroid(const EuclideanVectorBatch& centroids,
+                            const double* v,
+                            double* distance = nullptr) noexcept;
+
+#endif  // ASSIGNMENTS_EV_KMEANS_H_
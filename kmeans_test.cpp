@@ -0,0 +1,133 @@
+/*
+
+  == Explanation and rational of testing ==
+  k-means is tested on data whose clusters are obvious, so the expected partition is known without
+  depending on which centroids the seed happens to pick first.
+
+*/
+
+#include "assignments/ev/kmeans.h"
+
+#include <random>
+
+#include "catch.h"
+
+SCENARIO("Clustering well separated groups") {
+  WHEN("You create two groups of points far apart") {
+    std::vector<double> v{0, 0, 0.1, 0, 0, 0.1, 10, 10, 10.1, 10, 10, 10.1};
+    EuclideanVectorBatch data{2};
+    for (std::size_t i = 0; i < v.size(); i += 2) {
+      data.Add(&v[i]);
+    }
+
+    THEN("Each group becomes one cluster with its centroid at the group's mean") {
+      KMeansParams params;
+      params.k = 2;
+      KMeansResult result = KMeans(data, params);
+
+      REQUIRE(result.centroids.size() == 2);
+      REQUIRE(result.assignments[0] == result.assignments[1]);
+      REQUIRE(result.assignments[0] == result.assignments[2]);
+      REQUIRE(result.assignments[3] == result.assignments[4]);
+      REQUIRE(result.assignments[0] != result.assignments[3]);
+
+      const double* low = result.centroids.Row(result.assignments[0]);
+      REQUIRE(low[0] == Approx(0.1 / 3));
+      REQUIRE(low[1] == Approx(0.1 / 3));
+      REQUIRE(result.inertia == Approx(24.0 / 900));
+    }
+  }
+}
+
+SCENARIO("Asking for more clusters than vectors") {
+  WHEN("You cluster three vectors into five clusters") {
+    std::vector<double> v{1, 2, 3};
+    EuclideanVectorBatch data{1};
+    for (double& d : v) {
+      data.Add(&d);
+    }
+    KMeansParams params;
+    params.k = 5;
+
+    THEN("Every vector becomes its own cluster") {
+      KMeansResult result = KMeans(data, params);
+      REQUIRE(result.centroids.size() == 3);
+      REQUIRE(result.inertia == 0);
+    }
+  }
+}
+
+// EXCEPTION - nothing to cluster
+SCENARIO("Clustering an empty batch") {
+  WHEN("You create an empty batch") {
+    EuclideanVectorBatch data{3};
+
+    THEN("Clustering returns exception error") {
+      REQUIRE_THROWS_WITH(KMeans(data, KMeansParams{}),
+                          "KMeans needs k > 0 and at least one vector");
+    }
+  }
+}
+
+SCENARIO("Pruning and threading do not change the clustering") {
+  WHEN("You cluster the same random data with different settings") {
+    std::mt19937 rng{3};
+    std::normal_distribution<double> normal{0.0, 1.0};
+    EuclideanVectorBatch data{6};
+    std::vector<double> v(6);
+    for (int i = 0; i < 5000; ++i) {
+      for (double& d : v) {
+        d = normal(rng);
+      }
+      data.Add(v.data());
+    }
+
+    KMeansParams plain;
+    plain.k = 12;
+    plain.max_iterations = 50;
+    plain.prune = false;
+    plain.num_threads = 1;
+    KMeansParams fast = plain;
+    fast.prune = true;
+    fast.num_threads = 4;
+
+    THEN("The assignments and centroids are the same") {
+      KMeansResult a = KMeans(data, plain);
+      KMeansResult b = KMeans(data, fast);
+
+      REQUIRE(a.assignments == b.assignments);
+      REQUIRE(a.iterations == b.iterations);
+      REQUIRE(a.inertia == Approx(b.inertia));
+      for (std::size_t c = 0; c < a.centroids.size(); ++c) {
+        REQUIRE(a.centroids.Get(c).GetEuclideanNorm() ==
+                Approx(b.centroids.Get(c).GetEuclideanNorm()));
+      }
+    }
+  }
+}
+
+SCENARIO("Mini-batch clustering of well separated groups") {
+  WHEN("You create four tight groups of points") {
+    std::mt19937 rng{4};
+    std::normal_distribution<double> noise{0.0, 0.05};
+    EuclideanVectorBatch data{2};
+    for (int i = 0; i < 4000; ++i) {
+      double v[2] = {(i % 4) * 10 + noise(rng), (i % 2) * 5 + noise(rng)};
+      data.Add(v);
+    }
+
+    THEN("Each group ends up in its own cluster") {
+      KMeansParams params;
+      params.k = 4;
+      params.batch_size = 256;
+      params.max_iterations = 30;
+      KMeansResult result = KMeans(data, params);
+
+      REQUIRE(result.centroids.size() == 4);
+      for (std::size_t i = 4; i < data.size(); ++i) {
+        REQUIRE(result.assignments[i] == result.assignments[i % 4]);
+      }
+      REQUIRE(result.inertia < 4000 * 0.05);
+    }
+  }
+}
@@ -0,0 +1,149 @@
+#include "assignments/ev/pairwise_distance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "assignments/ev/parallel_for.h"
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+// Cache budget for the two tiles of vectors being compared (half of a typical 256KB L2)
+constexpr std::size_t kTileBytes = 128 * 1024;
+
+std::size_t TileSize(const PairwiseParams& params, int dims) noexcept {
+  if (params.tile_size > 0) {
+    return params.tile_size;
+  }
+  auto row_bytes = sizeof(double) * static_cast<std::size_t>(std::max(dims, 1));
+  std::size_t rows = kTileBytes / (2 * row_bytes);
+  return std::clamp<std::size_t>(rows, 16, 512);
+}
+
+// Converts a dot product and the two squared norms into the requested distance
+double Distance(DistanceMetric metric, double dot, double norm_a, double norm_b) noexcept {
+  switch (metric) {
+    case DistanceMetric::kCosine: {
+      double denominator = std::sqrt(norm_a) * std::sqrt(norm_b);
+      return denominator == 0 ? 1.0 : 1.0 - dot / denominator;
+    }
+    case DistanceMetric::kSquaredEuclidean:
+      return std::max(norm_a + norm_b - 2 * dot, 0.0);
+    case DistanceMetric::kEuclidean:
+    default:
+      return std::sqrt(std::max(norm_a + norm_b - 2 * dot, 0.0));
+  }
+}
+
+// Fills tile.values for one block. Every entry goes through the same dispatched Dot, so a pair
+//  gets the same value whichever tile it lands in and at whatever position within the tile.
+void ComputeTile(const EuclideanVectorBatch& batch,
+                 const std::vector<double>& norms,
+                 DistanceMetric metric,
+                 DistanceTile& tile,
+                 std::vector<double>& values) {
+  const int dims = batch.GetNumDimensions();
+  const std::size_t cols = tile.col_end - tile.col_begin;
+  values.resize((tile.row_end - tile.row_begin) * cols);
+
+  for (std::size_t i = tile.row_begin; i < tile.row_end; ++i) {
+    const double* a = batch.Row(i);
+    double* out = &values[(i - tile.row_begin) * cols];
+    for (std::size_t j = tile.col_begin; j < tile.col_end; ++j) {
+      out[j - tile.col_begin] = Distance(metric, Dot(a, batch.Row(j), dims), norms[i], norms[j]);
+    }
+    // A vector is at distance 0 from itself; the identity above only gets within rounding error
+    if (i >= tile.col_begin && i < tile.col_end && metric != DistanceMetric::kCosine) {
+      out[i - tile.col_begin] = 0;
+    }
+  }
+  tile.values = values.data();
+}
+
+template <typename T>
+void Write(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+/* FUNCTIONS */
+// Splits the matrix into tile_size blocks and spreads the upper-triangle blocks over the threads
+void ComputePairwiseDistances(const EuclideanVectorBatch& batch,
+                              const PairwiseParams& params,
+                              const std::function<void(const DistanceTile&)>& on_tile) {
+  const std::size_t n = batch.size();
+  if (n == 0) {
+    return;
+  }
+  const int dims = batch.GetNumDimensions();
+  const std::size_t tile_size = TileSize(params, dims);
+
+  std::vector<double> norms(n);
+  ParallelFor(n, NumThreads(params.num_threads, n, 4096),
+              [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                  norms[i] = SquaredNorm(batch.Row(i), dims);
+                }
+              });
+
+  std::vector<std::pair<std::size_t, std::size_t>> tiles;
+  for (std::size_t row = 0; row < n; row += tile_size) {
+    for (std::size_t col = row; col < n; col += tile_size) {
+      tiles.emplace_back(row, col);
+    }
+  }
+
+  std::mutex callback_mutex;
+  ParallelFor(tiles.size(), NumThreads(params.num_threads, tiles.size()),
+              [&](std::size_t, std::size_t begin, std::size_t end) {
+                std::vector<double> values;
+                for (std::size_t t = begin; t < end; ++t) {
+                  DistanceTile tile{tiles[t].first, std::min(tiles[t].first + tile_size, n),
+                                    tiles[t].second, std::min(tiles[t].second + tile_size, n),
+                                    nullptr};
+                  ComputeTile(batch, norms, params.metric, tile, values);
+                  std::lock_guard lock{callback_mutex};
+                  on_tile(tile);
+                }
+              });
+}
+
+// Copies each tile into place and mirrors it across the diagonal
+std::vector<double> PairwiseDistanceMatrix(const EuclideanVectorBatch& batch,
+                                           const PairwiseParams& params) {
+  const std::size_t n = batch.size();
+  std::vector<double> matrix(n * n);
+  ComputePairwiseDistances(batch, params, [&](const DistanceTile& tile) {
+    for (std::size_t i = tile.row_begin; i < tile.row_end; ++i) {
+      for (std::size_t j = tile.col_begin; j < tile.col_end; ++j) {
+        matrix[i * n + j] = tile.At(i, j);
+        matrix[j * n + i] = tile.At(i, j);
+      }
+    }
+  });
+  return matrix;
+}
+
+void WritePairwiseDistances(const EuclideanVectorBatch& batch,
+                            const PairwiseParams& params,
+                            std::ostream& os) {
+  os.write("EVPD", 4);
+  Write(os, static_cast<std::uint64_t>(batch.size()));
+  Write(os, static_cast<std::uint64_t>(params.metric));
+  ComputePairwiseDistances(batch, params, [&](const DistanceTile& tile) {
+    Write(os, static_cast<std::uint64_t>(tile.row_begin));
+    Write(os, static_cast<std::uint64_t>(tile.row_end));
+    Write(os, static_cast<std::uint64_t>(tile.col_begin));
+    Write(os, static_cast<std::uint64_t>(tile.col_end));
+    auto count = (tile.row_end - tile.row_begin) * (tile.col_end - tile.col_begin);
+    os.write(reinterpret_cast<const char*>(tile.values),
+             static_cast<std::streamsize>(count * sizeof(double)));
+  });
+  if (!os) {
+    throw EuclideanVectorError("Pairwise distances could not be written");
+  }
+}
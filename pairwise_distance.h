@@ -0,0 +1,60 @@
+#ifndef ASSIGNMENTS_EV_PAIRWISE_DISTANCE_H_
+#define ASSIGNMENTS_EV_PAIRWISE_DISTANCE_H_
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// Distance between two vectors a and b
+//  kEuclidean        - ||a - b||
+//  kSquaredEuclidean - ||a - b||^2
+//  kCosine           - 1 - (a . b) / (||a|| ||b||), taken as 1 when either vector is all zeros
+enum class DistanceMetric { kEuclidean, kSquaredEuclidean, kCosine };
+
+// Settings for the pairwise distance engine
+//  tile_size   - rows/columns per tile; 0 picks a size so that two tiles of vectors fit in L2
+//  num_threads - worker threads (<= 0 means one per hardware thread)
+struct PairwiseParams {
+  DistanceMetric metric = DistanceMetric::kEuclidean;
+  std::size_t tile_size = 0;
+  int num_threads = 0;
+};
+
+// A block of the distance matrix: rows [row_begin, row_end) against columns [col_begin, col_end).
+//  Only tiles on or above the diagonal are produced (col_begin >= row_begin); on diagonal tiles
+//  the entries below the diagonal are filled in too.
+struct DistanceTile {
+  std::size_t row_begin;
+  std::size_t row_end;
+  std::size_t col_begin;
+  std::size_t col_end;
+  const double* values;  // row-major, (row_end - row_begin) x (col_end - col_begin)
+
+  double At(std::size_t row, std::size_t col) const noexcept {
+    return values[(row - row_begin) * (col_end - col_begin) + (col - col_begin)];
+  }
+};
+
+// Computes every upper-triangle tile of the distance matrix of batch and hands each one to
+//  on_tile. Distances use ||a||^2 + ||b||^2 - 2 a.b with the squared norms computed once per
+//  vector. Calls to on_tile are serialised (it need not be thread-safe) but arrive in no fixed
+//  order, and tile.values is only valid for the duration of the call.
+void ComputePairwiseDistances(const EuclideanVectorBatch& batch,
+                              const PairwiseParams& params,
+                              const std::function<void(const DistanceTile&)>& on_tile);
+
+// Full n x n row-major distance matrix (both triangles)
+std::vector<double> PairwiseDistanceMatrix(const EuclideanVectorBatch& batch,
+                                           const PairwiseParams& params = PairwiseParams{});
+
+// Streams the tiles to os without materialising the matrix. Layout: "EVPD", the number of vectors
+//  and the metric as uint64s, then for each tile its four bounds as uint64s followed by its values
+//  as doubles.
+void WritePairwiseDistances(const EuclideanVectorBatch& batch,
+                            const PairwiseParams& params,
+                            std::ostream& os);
+
+#endif  // ASSIGNMENTS_EV_PAIRWISE_DISTANCE_H_
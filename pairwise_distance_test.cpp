@@ -0,0 +1,137 @@
+/*
+
+  == Explanation and rational of testing ==
+  The engine is checked against the plain operators: every entry of the matrix must match
+  (a - b).GetEuclideanNorm() (or the squared/cosine equivalent) for the same pair. Small tile sizes
+  and several threads are used on purpose so that partial tiles, diagonal tiles and concurrent
+  callbacks are all exercised on a small input.
+
+*/
+
+#include "assignments/ev/pairwise_distance.h"
+
+#include <random>
+#include <sstream>
+
+#include "catch.h"
+
+namespace {
+
+EuclideanVectorBatch RandomBatch(std::size_t count, int dims, unsigned seed) {
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<double> uniform{-5.0, 5.0};
+  EuclideanVectorBatch batch{dims};
+  std::vector<double> v(static_cast<std::size_t>(dims));
+  for (std::size_t i = 0; i < count; ++i) {
+    for (double& d : v) {
+      d = uniform(rng);
+    }
+    batch.Add(v.data());
+  }
+  return batch;
+}
+
+}  // namespace
+
+SCENARIO("Pairwise euclidean distances match the vector operators") {
+  WHEN("You compute the distance matrix of a batch with small tiles") {
+    EuclideanVectorBatch batch = RandomBatch(37, 7, 1);
+    PairwiseParams params;
+    params.tile_size = 8;
+    params.num_threads = 3;
+    std::vector<double> matrix = PairwiseDistanceMatrix(batch, params);
+
+    THEN("Every entry equals the norm of the difference") {
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        REQUIRE(matrix[i * batch.size() + i] == 0);
+        for (std::size_t j = 0; j < batch.size(); ++j) {
+          double expected = (batch.Get(i) - batch.Get(j)).GetEuclideanNorm();
+          REQUIRE(matrix[i * batch.size() + j] == Approx(expected).margin(1e-9));
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Pairwise distances do not depend on the tiling") {
+  WHEN("You compute the matrix of the same batch with tiles of 5, 8 and 64") {
+    EuclideanVectorBatch batch = RandomBatch(29, 13, 3);
+    PairwiseParams params;
+    params.num_threads = 2;
+    params.tile_size = 5;
+    std::vector<double> fives = PairwiseDistanceMatrix(batch, params);
+    params.tile_size = 8;
+    std::vector<double> eights = PairwiseDistanceMatrix(batch, params);
+    params.tile_size = 64;
+    std::vector<double> whole = PairwiseDistanceMatrix(batch, params);
+
+    THEN("Every entry is bit for bit the same, and the matrix is exactly symmetric") {
+      REQUIRE(fives == whole);
+      REQUIRE(eights == whole);
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        for (std::size_t j = 0; j < batch.size(); ++j) {
+          REQUIRE(whole[i * batch.size() + j] == whole[j * batch.size() + i]);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Squared euclidean and cosine distances") {
+  WHEN("You create three vectors") {
+    std::vector<double> v{1, 0, 0, 1, 2, 0};
+    EuclideanVectorBatch batch{2};
+    for (std::size_t i = 0; i < v.size(); i += 2) {
+      batch.Add(&v[i]);
+    }
+
+    THEN("Each metric follows its definition") {
+      PairwiseParams params;
+      params.metric = DistanceMetric::kSquaredEuclidean;
+      std::vector<double> squared = PairwiseDistanceMatrix(batch, params);
+      REQUIRE(squared[0 * 3 + 1] == Approx(2));
+      REQUIRE(squared[1 * 3 + 2] == Approx(5));
+
+      params.metric = DistanceMetric::kCosine;
+      std::vector<double> cosine = PairwiseDistanceMatrix(batch, params);
+      REQUIRE(cosine[0 * 3 + 1] == Approx(1));
+      REQUIRE(cosine[0 * 3 + 2] == Approx(0));
+      REQUIRE(cosine[2 * 3 + 0] == Approx(0));
+    }
+  }
+}
+
+SCENARIO("Streaming tiles instead of materialising the matrix") {
+  WHEN("You stream the tiles of a batch") {
+    EuclideanVectorBatch batch = RandomBatch(50, 3, 2);
+    PairwiseParams params;
+    params.tile_size = 16;
+    params.num_threads = 2;
+
+    THEN("Every upper-triangle pair is produced exactly once") {
+      std::vector<int> seen(batch.size() * batch.size(), 0);
+      ComputePairwiseDistances(batch, params, [&](const DistanceTile& tile) {
+        REQUIRE(tile.col_begin >= tile.row_begin);
+        for (std::size_t i = tile.row_begin; i < tile.row_end; ++i) {
+          for (std::size_t j = std::max(i, tile.col_begin); j < tile.col_end; ++j) {
+            ++seen[i * batch.size() + j];
+          }
+        }
+      });
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        for (std::size_t j = i; j < batch.size(); ++j) {
+          REQUIRE(seen[i * batch.size() + j] == 1);
+        }
+      }
+    }
+
+    THEN("Writing them to a stream gives a header and one record per tile") {
+      std::stringstream ss;
+      WritePairwiseDistances(batch, params, ss);
+      // Tiles of 16, 16, 16 and 2 rows per side give 10 upper-triangle tiles; summing the product
+      //  of the sides over those tiles gives ((sum of sides)^2 + sum of squared sides) / 2 values
+      std::size_t values = (50 * 50 + 3 * 16 * 16 + 2 * 2) / 2;
+      REQUIRE(ss.str().size() == 4 + 2 * 8 + 10 * 4 * 8 + values * sizeof(double));
+    }
+  }
+}
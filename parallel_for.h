@@ -0,0 +1,67 @@
+#ifndef ASSIGNMENTS_EV_PARALLEL_FOR_H_
+#define ASSIGNMENTS_EV_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Hardware threads, looked up once: glibc reads it from sysfs on every call, which costs
+//  microseconds on each small vector that asks how many threads to fill itself with
+inline unsigned HardwareThreads() noexcept {
+  static const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  return threads;
+}
+
+// Number of threads to use for n items when the caller asked for requested threads (<= 0 means
+//  one per hardware thread), giving every thread at least min_per_thread items
+inline int NumThreads(int requested, std::size_t n, std::size_t min_per_thread = 1) noexcept {
+  std::size_t threads = requested > 0 ? static_cast<std::size_t>(requested) : HardwareThreads();
+  threads = std::min(threads, n / std::max<std::size_t>(min_per_thread, 1));
+  return static_cast<int>(std::max<std::size_t>(threads, 1));
+}
+
+// Splits [0, n) into num_threads contiguous chunks and calls fn(chunk, begin, end) for each chunk,
+//  chunk 0 on the calling thread and the rest on their own threads. The first exception thrown by
+//  any chunk is rethrown once every chunk has finished. A chunk whose thread cannot be started
+//  is run on the calling thread instead.
+template <typename Fn>
+void ParallelFor(std::size_t n, int num_threads, Fn&& fn) {
+  auto chunks = static_cast<std::size_t>(std::max(num_threads, 1));
+  if (chunks == 1) {
+    fn(std::size_t{0}, std::size_t{0}, n);
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(chunks);
+  auto run = [&](std::size_t chunk) {
+    try {
+      fn(chunk, n * chunk / chunks, n * (chunk + 1) / chunks);
+    } catch (...) {
+      errors[chunk] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(chunks - 1);
+  for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+    try {
+      threads.emplace_back(run, chunk);
+    } catch (const std::system_error&) {
+      run(chunk);
+    }
+  }
+  run(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+#endif  // ASSIGNMENTS_EV_PARALLEL_FOR_H_
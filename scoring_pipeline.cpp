@@ -0,0 +1,180 @@
+#include "assignments/ev/scoring_pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "assignments/ev/bounded_queue.h"
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+// Scales every vector of batch to unit length, exactly as CreateUnitVector would
+void Normalise(EuclideanVectorBatch& batch) {
+  const int dims = batch.GetNumDimensions();
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    double* row = batch.Row(i);
+    double norm = std::sqrt(SquaredNorm(row, dims));
+    if (norm == 0) {
+      throw EuclideanVectorError(
+          "EuclideanVector with euclidean normal of 0 does not have a unit vector");
+    }
+    for (int j = 0; j < dims; ++j) {
+      row[j] /= norm;
+    }
+  }
+}
+
+void Score(const EuclideanVectorBatch& references, ScoredBatch& batch) {
+  const int dims = references.GetNumDimensions();
+  batch.scores.resize(batch.vectors.size() * references.size());
+  for (std::size_t i = 0; i < batch.vectors.size(); ++i) {
+    const double* row = batch.vectors.Row(i);
+    for (std::size_t r = 0; r < references.size(); ++r) {
+      batch.scores[i * references.size() + r] = Dot(row, references.Row(r), dims);
+    }
+  }
+}
+
+}  // namespace
+
+/* CONSTRUCTORS */
+ScoringPipeline::ScoringPipeline(EuclideanVectorBatch references,
+                                 const ScoringPipelineParams& params)
+  : references_{std::move(references)}, params_{params} {
+  if (this->references_.GetNumDimensions() == 0) {
+    throw EuclideanVectorError("EuclideanVector with no dimensions does not have a unit vector");
+  }
+  this->params_.batch_size = std::max<std::size_t>(this->params_.batch_size, 1);
+  this->params_.queue_depth = std::max<std::size_t>(this->params_.queue_depth, 1);
+
+  // Enough buffers for both hand-over queues to be full while every stage holds one
+  const std::size_t num_buffers = 2 * this->params_.queue_depth + 3;
+  this->buffers_.reserve(num_buffers);
+  for (std::size_t i = 0; i < num_buffers; ++i) {
+    this->buffers_.push_back(ScoredBatch{0, EuclideanVectorBatch{this->GetNumDimensions()}, {},
+                                         this->references_.size()});
+    this->buffers_.back().vectors.Reserve(this->params_.batch_size);
+  }
+}
+
+/* METHODS */
+// Every stage owns the batches it has popped until it pushes them on; the scoring stage returns
+//  them to the reading stage through free, which can hold all of them and so never blocks
+void ScoringPipeline::Run(const VectorSource& source, const ScoredBatchSink& sink) {
+  BoundedQueue<ScoredBatch*> free{this->buffers_.size()};
+  BoundedQueue<ScoredBatch*> read{this->params_.queue_depth};
+  BoundedQueue<ScoredBatch*> normalised{this->params_.queue_depth};
+  for (auto& buffer : this->buffers_) {
+    free.TryPush(&buffer);
+  }
+
+  std::atomic<bool> cancel{false};
+  std::exception_ptr errors[3];
+  auto fail = [&](std::exception_ptr& error) {
+    error = std::current_exception();
+    cancel.store(true, std::memory_order_relaxed);
+  };
+
+  std::thread reader([&] {
+    try {
+      std::size_t index = 0;
+      bool more = true;
+      ScoredBatch* batch = nullptr;
+      while (more && !cancel.load(std::memory_order_relaxed)) {
+        if (batch == nullptr && !free.Pop(batch, cancel)) {
+          break;
+        }
+        batch->vectors.Clear();
+        batch->first_index = index;
+        more = source(batch->vectors, this->params_.batch_size);
+        if (batch->vectors.empty()) {
+          continue;
+        }
+        index += batch->vectors.size();
+        if (!read.Push(batch, cancel)) {
+          break;
+        }
+        batch = nullptr;
+      }
+    } catch (...) {
+      fail(errors[0]);
+    }
+    read.Close();
+  });
+
+  // If the second thread cannot start, the first has to be stopped and joined before the error
+  //  unwinds past it
+  std::thread normaliser;
+  try {
+    normaliser = std::thread([&] {
+      try {
+        ScoredBatch* batch;
+        while (!cancel.load(std::memory_order_relaxed) && read.Pop(batch, cancel)) {
+          Normalise(batch->vectors);
+          if (!normalised.Push(batch, cancel)) {
+            break;
+          }
+        }
+      } catch (...) {
+        fail(errors[1]);
+      }
+      normalised.Close();
+    });
+  } catch (...) {
+    cancel.store(true, std::memory_order_relaxed);
+    reader.join();
+    throw;
+  }
+
+  try {
+    ScoredBatch* batch;
+    while (!cancel.load(std::memory_order_relaxed) && normalised.Pop(batch, cancel)) {
+      Score(this->references_, *batch);
+      sink(*batch);
+      free.Push(batch, cancel);
+    }
+  } catch (...) {
+    fail(errors[2]);
+  }
+
+  reader.join();
+  normaliser.join();
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+/* FUNCTIONS */
+VectorSource ReadVectors(std::istream& is, int num_dimensions) {
+  std::vector<double> magnitudes(static_cast<std::size_t>(num_dimensions));
+  return [&is, magnitudes](EuclideanVectorBatch& batch, std::size_t max_vectors) mutable {
+    if (static_cast<std::size_t>(batch.GetNumDimensions()) != magnitudes.size()) {
+      throw EuclideanVectorError("Dimensions of batch(" + std::to_string(batch.GetNumDimensions()) +
+                                 ") and input(" + std::to_string(magnitudes.size()) +
+                                 ") do not match");
+    }
+    while (batch.size() < max_vectors) {
+      for (std::size_t j = 0; j < magnitudes.size(); ++j) {
+        if (is >> magnitudes[j]) {
+          continue;
+        }
+        if (!is.eof()) {
+          throw EuclideanVectorError("Magnitude could not be read");
+        }
+        if (j != 0) {
+          throw EuclideanVectorError("Input ended in the middle of a vector");
+        }
+        return false;
+      }
+      batch.Add(magnitudes.data());
+    }
+    return true;
+  };
+}
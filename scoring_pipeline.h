@@ -0,0 +1,70 @@
+#ifndef ASSIGNMENTS_EV_SCORING_PIPELINE_H_
+#define ASSIGNMENTS_EV_SCORING_PIPELINE_H_
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// Settings for the scoring pipeline
+//  batch_size  - vectors read, normalised and scored together
+//  queue_depth - batches that may wait between two stages before the stage upstream blocks
+struct ScoringPipelineParams {
+  std::size_t batch_size = 256;
+  std::size_t queue_depth = 4;
+};
+
+// A batch after the last stage
+//  first_index - position in the input stream of the first vector of the batch
+//  vectors     - the vectors of the batch, normalised to unit length
+//  scores      - row-major vectors.size() x number of references; Score(i, r) is vector i . ref r
+struct ScoredBatch {
+  std::size_t first_index;
+  EuclideanVectorBatch vectors;
+  std::vector<double> scores;
+  std::size_t num_references;
+
+  double Score(std::size_t i, std::size_t reference) const noexcept {
+    return scores[i * num_references + reference];
+  }
+};
+
+// Fills batch (handed over empty) with up to max_vectors vectors; returns false once the input is
+//  exhausted (anything added on that call is still processed)
+using VectorSource = std::function<bool(EuclideanVectorBatch& batch, std::size_t max_vectors)>;
+using ScoredBatchSink = std::function<void(const ScoredBatch& batch)>;
+
+// Scores a stream of vectors against a fixed set of references in three overlapping stages:
+//  reading (source, on its own thread), normalising (CreateUnitVector, on its own thread) and
+//  scoring (dot product with every reference, then sink, on the calling thread). Stages hand
+//  batches over through bounded lock-free queues, so a slow stage makes the ones upstream wait
+//  rather than letting batches pile up, and a fixed set of batch buffers circulates through the
+//  stages so that a warmed-up pipeline does not allocate.
+class ScoringPipeline {
+ public:
+  /* CONSTRUCTORS */
+  explicit ScoringPipeline(EuclideanVectorBatch references,
+                           const ScoringPipelineParams& params = ScoringPipelineParams{});
+
+  /* METHODS */
+  int GetNumDimensions() const noexcept { return this->references_.GetNumDimensions(); }
+  const EuclideanVectorBatch& GetReferences() const noexcept { return this->references_; }
+
+  // Runs source to exhaustion. Batches reach sink in input order and are only valid for the
+  //  duration of the call. An exception thrown by any stage (including for a vector with a norm
+  //  of 0, which has no unit vector) stops every stage and is rethrown here, as is a failure to
+  //  start a stage's thread.
+  void Run(const VectorSource& source, const ScoredBatchSink& sink);
+
+ private:
+  EuclideanVectorBatch references_;
+  ScoringPipelineParams params_;
+  std::vector<ScoredBatch> buffers_;  // kept between runs so later runs reuse their capacity
+};
+
+// Source reading whitespace separated magnitudes, num_dimensions per vector, until the end of is
+VectorSource ReadVectors(std::istream& is, int num_dimensions);
+
+#endif  // ASSIGNMENTS_EV_SCORING_PIPELINE_H_
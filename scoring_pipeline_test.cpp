@@ -0,0 +1,184 @@
+/*
+
+  == Explanation and rational of testing ==
+  The pipeline must give exactly what the sequential code gives: every vector turned into
+  CreateUnitVector() and dotted with each reference using operator*. That is checked for a stream
+  that does not divide evenly into batches, with the smallest queues (so the stages are forever
+  waiting on each other) and over several runs of the same pipeline (so the recycled buffers are
+  exercised). The queue is tested on its own with a producer and consumer thread. The exception
+  scenarios cover each stage failing, which must stop the other stages rather than hang them.
+
+*/
+
+#include "assignments/ev/scoring_pipeline.h"
+
+#include <atomic>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+#include "assignments/ev/bounded_queue.h"
+#include "catch.h"
+
+namespace {
+
+std::vector<EuclideanVector> MakeVectors(std::size_t n, int dims, double offset) {
+  std::vector<EuclideanVector> evs;
+  for (std::size_t i = 0; i < n; ++i) {
+    EuclideanVector ev(dims);
+    for (int j = 0; j < dims; ++j) {
+      ev[j] = std::sin(offset + static_cast<double>(i * 7 + static_cast<std::size_t>(j))) + 0.1;
+    }
+    evs.push_back(ev);
+  }
+  return evs;
+}
+
+// Source handing out evs in order
+VectorSource FromVectors(const std::vector<EuclideanVector>& evs) {
+  std::size_t next = 0;
+  return [&evs, next](EuclideanVectorBatch& batch, std::size_t max_vectors) mutable {
+    while (batch.size() < max_vectors && next < evs.size()) {
+      batch.Add(evs[next++]);
+    }
+    return next < evs.size();
+  };
+}
+
+}  // namespace
+
+SCENARIO("Pushing and popping across two threads") {
+  WHEN("A producer pushes 10000 values through a queue of capacity 3") {
+    BoundedQueue<int> queue{3};
+    std::atomic<bool> cancel{false};
+    std::thread producer([&] {
+      for (int i = 0; i < 10000; ++i) {
+        queue.Push(i, cancel);
+      }
+      queue.Close();
+    });
+    std::vector<int> popped;
+    int value;
+    while (queue.Pop(value, cancel)) {
+      popped.push_back(value);
+    }
+    producer.join();
+
+    THEN("The capacity is rounded up and every value arrives once, in order") {
+      REQUIRE(queue.GetCapacity() == 4);
+      REQUIRE(popped.size() == 10000);
+      for (int i = 0; i < 10000; ++i) {
+        REQUIRE(popped[static_cast<std::size_t>(i)] == i);
+      }
+    }
+  }
+  WHEN("You push to a full queue") {
+    BoundedQueue<int> queue{2};
+    std::atomic<bool> cancel{true};
+    THEN("TryPush and a cancelled Push fail") {
+      REQUIRE(queue.TryPush(1));
+      REQUIRE(queue.TryPush(2));
+      REQUIRE_FALSE(queue.TryPush(3));
+      REQUIRE_FALSE(queue.Push(3, cancel));
+    }
+  }
+}
+
+SCENARIO("Scoring a stream matches the sequential computation") {
+  const auto references = MakeVectors(5, 6, 0.0);
+  const auto inputs = MakeVectors(103, 6, 1.0);
+
+  WHEN("You run the stream twice through pipelines with different batching") {
+    std::vector<std::size_t> counts;
+    for (std::size_t batch_size : {1u, 10u, 256u}) {
+      ScoringPipeline pipeline{EuclideanVectorBatch{references}, {batch_size, 1}};
+      for (int run = 0; run < 2; ++run) {
+        std::size_t expected_index = 0;
+        pipeline.Run(FromVectors(inputs), [&](const ScoredBatch& batch) {
+          REQUIRE(batch.first_index == expected_index);
+          REQUIRE(batch.vectors.size() <= batch_size);
+          for (std::size_t i = 0; i < batch.vectors.size(); ++i) {
+            EuclideanVector unit = inputs[expected_index + i].CreateUnitVector();
+            REQUIRE(batch.vectors.Get(i) == unit);
+            for (std::size_t r = 0; r < references.size(); ++r) {
+              REQUIRE(batch.Score(i, r) == Approx(unit * references[r]).epsilon(1e-12));
+            }
+          }
+          expected_index += batch.vectors.size();
+        });
+        counts.push_back(expected_index);
+      }
+    }
+
+    THEN("Every vector arrives once, in input order, normalised and scored") {
+      REQUIRE(counts == std::vector<std::size_t>(6, inputs.size()));
+    }
+  }
+}
+
+SCENARIO("Reading vectors from text") {
+  WHEN("You score whitespace separated magnitudes") {
+    EuclideanVectorBatch axes{2};
+    double magnitudes[] = {1, 0, 0, 1};
+    axes.Add(magnitudes);
+    axes.Add(magnitudes + 2);
+    ScoringPipeline pipeline{axes};
+    std::istringstream is{"3 4\n0 -2\n\n6 8 \n"};
+    std::vector<double> scores;
+    pipeline.Run(ReadVectors(is, 2), [&](const ScoredBatch& batch) {
+      scores.insert(scores.end(), batch.scores.cbegin(), batch.scores.cend());
+    });
+
+    THEN("Each line is one vector") {
+      REQUIRE(scores == std::vector<double>{0.6, 0.8, 0, -1, 0.6, 0.8});
+    }
+  }
+}
+
+// EXCEPTION - A vector with a norm of 0 has no unit vector
+SCENARIO("A stream containing a zero vector") {
+  auto inputs = MakeVectors(500, 3, 0.0);
+  inputs[321] = EuclideanVector(3);
+  WHEN("You run it through the pipeline") {
+    ScoringPipeline pipeline{EuclideanVectorBatch{MakeVectors(2, 3, 1.0)}, {8, 1}};
+    std::size_t scored = 0;
+    THEN("The normalisation error reaches the caller and later vectors are not scored") {
+      REQUIRE_THROWS_WITH(pipeline.Run(FromVectors(inputs),
+                                       [&](const ScoredBatch& batch) {
+                                         scored += batch.vectors.size();
+                                       }),
+                          "EuclideanVector with euclidean normal of 0 does not have a unit vector");
+      REQUIRE(scored <= 320);
+    }
+  }
+}
+
+// EXCEPTION - Failures in the reading and scoring stages stop the pipeline
+SCENARIO("A failing source or sink") {
+  const auto inputs = MakeVectors(100, 3, 0.0);
+  ScoringPipeline pipeline{EuclideanVectorBatch{MakeVectors(2, 3, 1.0)}, {4, 1}};
+  WHEN("The input is malformed or the wrong size") {
+    std::istringstream truncated{"1 2 3 4 5"};
+    std::istringstream garbage{"1 2 x"};
+    auto ignore = [](const ScoredBatch&) {};
+    THEN("The reader's error is rethrown") {
+      REQUIRE_THROWS_WITH(pipeline.Run(ReadVectors(truncated, 3), ignore),
+                          "Input ended in the middle of a vector");
+      REQUIRE_THROWS_WITH(pipeline.Run(ReadVectors(garbage, 3), ignore),
+                          "Magnitude could not be read");
+      REQUIRE_THROWS_WITH(pipeline.Run(ReadVectors(garbage, 2), ignore),
+                          "Dimensions of batch(3) and input(2) do not match");
+    }
+  }
+  WHEN("The sink throws") {
+    THEN("The sink's error is rethrown") {
+      REQUIRE_THROWS_WITH(pipeline.Run(FromVectors(inputs),
+                                       [](const ScoredBatch& batch) {
+                                         if (batch.first_index >= 40) {
+                                           throw EuclideanVectorError("Sink is full");
+                                         }
+                                       }),
+                          "Sink is full");
+    }
+  }
+}
@@ -0,0 +1,118 @@
+#include "assignments/ev/shared_euclidean_vector.h"
+
+#include <utility>
+
+#include "assignments/ev/euclidean_vector_status.h"
+
+/* CONSTRUCTORS */
+SharedEuclideanVector::SharedEuclideanVector(std::size_t size, double magnitude)
+  : SharedEuclideanVector(EuclideanVector(size, magnitude)) {}
+
+SharedEuclideanVector::SharedEuclideanVector(EuclideanVector ev)
+  : block_{new Block{{1}, std::move(ev)}} {}
+
+// Shares o's vector; relaxed is enough since o's reference keeps the block alive meanwhile
+SharedEuclideanVector::SharedEuclideanVector(const SharedEuclideanVector& o) noexcept
+  : block_{o.block_} {
+  if (this->block_ != nullptr) {
+    this->block_->references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+SharedEuclideanVector::SharedEuclideanVector(SharedEuclideanVector&& o) noexcept
+  : block_{std::exchange(o.block_, nullptr)} {}
+
+/* DESTRUCTORS */
+SharedEuclideanVector::~SharedEuclideanVector() noexcept {
+  this->Release();
+}
+
+/* METHODS */
+const EuclideanVector& SharedEuclideanVector::GetVector() const noexcept {
+  static const EuclideanVector empty(0);
+  return this->block_ == nullptr ? empty : this->block_->vector;
+}
+
+double* SharedEuclideanVector::data() {
+  return this->Mutable().data();
+}
+
+// Checked before detaching, as are the compound operators, so a failed call leaves this copy shared
+double& SharedEuclideanVector::at(std::size_t i) {
+  CheckIndex(this->GetVector(), i).ThrowIfError();
+  return this->Mutable()[i];
+}
+
+std::size_t SharedEuclideanVector::UseCount() const noexcept {
+  return this->block_ == nullptr ? 0 : this->block_->references.load(std::memory_order_relaxed);
+}
+
+// The acquire load pairs with the release in other copies' Release: once this copy sees itself as
+//  the only one left, every read those copies made has finished, so writing is safe
+void SharedEuclideanVector::Detach() {
+  if (this->block_ != nullptr && this->block_->references.load(std::memory_order_acquire) == 1) {
+    return;
+  }
+  Block* copy = new Block{{1}, this->GetVector()};
+  this->Release();
+  this->block_ = copy;
+}
+
+void SharedEuclideanVector::Release() noexcept {
+  if (this->block_ != nullptr &&
+      this->block_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this->block_;
+  }
+  this->block_ = nullptr;
+}
+
+EuclideanVector& SharedEuclideanVector::Mutable() {
+  this->Detach();
+  return this->block_->vector;
+}
+
+/* OPERATIONS */
+SharedEuclideanVector& SharedEuclideanVector::operator=(const SharedEuclideanVector& o) noexcept {
+  if (this->block_ != o.block_) {
+    SharedEuclideanVector copy{o};
+    std::swap(this->block_, copy.block_);
+  }
+  return *this;
+}
+
+SharedEuclideanVector& SharedEuclideanVector::operator=(SharedEuclideanVector&& o) noexcept {
+  if (this != &o) {
+    this->Release();
+    this->block_ = std::exchange(o.block_, nullptr);
+  }
+  return *this;
+}
+
+double& SharedEuclideanVector::operator[](std::size_t i) {
+  return this->Mutable()[i];
+}
+
+SharedEuclideanVector& SharedEuclideanVector::operator+=(const EuclideanVector& ev) {
+  CheckDimensions(this->GetVector(), ev).ThrowIfError();
+  this->Mutable() += ev;
+  return *this;
+}
+
+SharedEuclideanVector& SharedEuclideanVector::operator-=(const EuclideanVector& ev) {
+  CheckDimensions(this->GetVector(), ev).ThrowIfError();
+  this->Mutable() -= ev;
+  return *this;
+}
+
+SharedEuclideanVector& SharedEuclideanVector::operator*=(double n) {
+  this->Mutable() *= n;
+  return *this;
+}
+
+SharedEuclideanVector& SharedEuclideanVector::operator/=(double n) {
+  if (n == 0) {
+    Status(ErrorCode::kDivisionByZero).ThrowIfError();
+  }
+  this->Mutable() /= n;
+  return *this;
+}
@@ -0,0 +1,85 @@
+#ifndef ASSIGNMENTS_EV_SHARED_EUCLIDEAN_VECTOR_H_
+#define ASSIGNMENTS_EV_SHARED_EUCLIDEAN_VECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+
+#include "assignments/ev/euclidean_vector.h"
+
+// A copy-on-write EuclideanVector for handing one large vector to many readers.
+//  Copies share a single EuclideanVector under an atomic reference count, so copying is O(1) and
+//  needs no lock whichever threads the copies end up on. The first mutation through a copy whose
+//  vector is shared (the non-const at, operator[] and data, or a compound operator) detaches it:
+//  that copy gets a private EuclideanVector and the others keep the old one.
+//
+//  As with other copy-on-write types, a reference or pointer returned by a mutating accessor
+//  must not be written through once the vector has been copied, since the copy would see the
+//  write. A single SharedEuclideanVector object is no more thread-safe than a EuclideanVector;
+//  only separate copies may be used from different threads.
+class SharedEuclideanVector {
+ public:
+  /* CONSTRUCTORS */
+  explicit SharedEuclideanVector(std::size_t size = 1) : SharedEuclideanVector(size, 0.0) {}
+  SharedEuclideanVector(std::size_t size, double magnitude);
+  explicit SharedEuclideanVector(EuclideanVector ev);            // takes over ev's magnitudes
+  SharedEuclideanVector(const SharedEuclideanVector& o) noexcept;  // shares o's vector
+  SharedEuclideanVector(SharedEuclideanVector&& o) noexcept;       // leaves o empty
+  ~SharedEuclideanVector() noexcept;
+
+  /* METHODS */
+  // The shared vector, for any read-only EuclideanVector operation
+  const EuclideanVector& GetVector() const noexcept;
+  std::size_t GetNumDimensions() const noexcept { return this->GetVector().GetNumDimensions(); }
+  const double* data() const noexcept { return this->GetVector().data(); }
+  double* data();  // detaches
+  double at(std::size_t i) const { return this->GetVector().at(i); }
+  double& at(std::size_t i);  // detaches
+
+  // Copies (including this one) sharing this vector; 0 once moved from
+  std::size_t UseCount() const noexcept;
+  // Gives this copy a private vector if it is shared, so later mutations do not copy
+  void Detach();
+
+  /* OPERATIONS */
+  SharedEuclideanVector& operator=(const SharedEuclideanVector& o) noexcept;
+  SharedEuclideanVector& operator=(SharedEuclideanVector&& o) noexcept;
+
+  double operator[](std::size_t i) const noexcept { return this->GetVector()[i]; }
+  double& operator[](std::size_t i);  // detaches
+
+  // Compound operators detach, then behave as EuclideanVector's
+  SharedEuclideanVector& operator+=(const EuclideanVector& ev);
+  SharedEuclideanVector& operator-=(const EuclideanVector& ev);
+  SharedEuclideanVector& operator*=(double n);
+  SharedEuclideanVector& operator/=(double n);
+
+  /* FRIENDS */
+  friend bool operator==(const SharedEuclideanVector& o1,
+                         const SharedEuclideanVector& o2) noexcept {
+    return o1.GetVector() == o2.GetVector();
+  }
+  friend bool operator!=(const SharedEuclideanVector& o1,
+                         const SharedEuclideanVector& o2) noexcept {
+    return !(o1 == o2);
+  }
+  friend std::ostream& operator<<(std::ostream& os, const SharedEuclideanVector& v) noexcept {
+    return os << v.GetVector();
+  }
+
+ private:
+  // The vector and the number of copies pointing at it
+  struct Block {
+    std::atomic<std::size_t> references;
+    EuclideanVector vector;
+  };
+
+  // Drops this copy's reference, deleting the block with the last one
+  void Release() noexcept;
+  // The vector, detached first so it can be written
+  EuclideanVector& Mutable();
+
+  Block* block_;  // nullptr once moved from, which reads as a 0 dimensional vector
+};
+
+#endif  // ASSIGNMENTS_EV_SHARED_EUCLIDEAN_VECTOR_H_
@@ -0,0 +1,150 @@
+/*
+
+  == Explanation and rational of testing ==
+  Sharing is observed through UseCount and through the address of the magnitudes: copies must
+  point at the same buffer until one of them is mutated, at which point only that copy moves to a
+  new buffer and the others keep the old values. Every mutating entry point is checked to detach,
+  and failed ones to leave the copy shared. Threads copy, read and mutate their own copies of one
+  vector at once so that the reference counting runs under contention (and under -fsanitize=thread
+  when built with it).
+
+*/
+
+#include "assignments/ev/shared_euclidean_vector.h"
+
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "catch.h"
+
+namespace {
+
+// Where v's magnitudes are, without the mutable data() detaching them
+const double* Address(const SharedEuclideanVector& v) {
+  return v.data();
+}
+
+}  // namespace
+
+SCENARIO("Copies share one vector until written") {
+  WHEN("You copy a shared vector and read both copies") {
+    SharedEuclideanVector a{1000, 2.0};
+    SharedEuclideanVector b = a;
+    SharedEuclideanVector c;
+    c = b;
+    const SharedEuclideanVector& reader = b;
+    THEN("They share the same magnitudes") {
+      REQUIRE(a.UseCount() == 3);
+      REQUIRE(Address(a) == Address(c));
+      REQUIRE(c.GetNumDimensions() == 1000);
+      REQUIRE(reader[999] == 2.0);
+      REQUIRE(reader.at(0) == 2.0);
+      REQUIRE(b.UseCount() == 3);
+      REQUIRE(a.GetVector().GetEuclideanNorm() == Approx(std::sqrt(4000.0)));
+      REQUIRE(a == c);
+    }
+  }
+  WHEN("You write through each mutating entry point of a copy") {
+    SharedEuclideanVector original{3, 1.0};
+    SharedEuclideanVector subscript = original;
+    SharedEuclideanVector at = original;
+    SharedEuclideanVector added = original;
+    SharedEuclideanVector scaled = original;
+    SharedEuclideanVector divided = original;
+    SharedEuclideanVector raw = original;
+    subscript[0] = 5;
+    at.at(1) = 6;
+    added += original.GetVector();
+    scaled *= 3;
+    divided /= 2;
+    raw.data()[2] = 7;
+    THEN("Only that copy changes, and it no longer shares") {
+      REQUIRE(original.UseCount() == 1);
+      REQUIRE(original.GetVector() == EuclideanVector(3, 1.0));
+      REQUIRE(subscript[0] == 5);
+      REQUIRE(at[1] == 6);
+      REQUIRE(added.GetVector() == EuclideanVector(3, 2.0));
+      REQUIRE(scaled.GetVector() == EuclideanVector(3, 3.0));
+      REQUIRE(divided.GetVector() == EuclideanVector(3, 0.5));
+      REQUIRE(raw[2] == 7);
+      REQUIRE(subscript.UseCount() == 1);
+    }
+  }
+  WHEN("You detach explicitly") {
+    SharedEuclideanVector a{4, 1.0};
+    const double* unique = Address(a);
+    a.Detach();
+    const double* after_unique = Address(a);
+    SharedEuclideanVector b = a;
+    b.Detach();
+    THEN("Only a shared vector is copied") {
+      REQUIRE(after_unique == unique);
+      REQUIRE(Address(b) != unique);
+      REQUIRE(a.UseCount() == 1);
+      REQUIRE(b.UseCount() == 1);
+      REQUIRE(a == b);
+    }
+  }
+  WHEN("You move a shared vector") {
+    SharedEuclideanVector a{4, 1.0};
+    SharedEuclideanVector b = std::move(a);
+    SharedEuclideanVector c{EuclideanVector(2, 3.0)};
+    c = std::move(b);
+    THEN("The moved from vector is empty until written and the reference moves along") {
+      REQUIRE(a.UseCount() == 0);
+      REQUIRE(a.GetNumDimensions() == 0);
+      REQUIRE(c.UseCount() == 1);
+      REQUIRE(c.GetVector() == EuclideanVector(4, 1.0));
+      REQUIRE_NOTHROW(a *= 2);
+      REQUIRE(a.UseCount() == 1);
+    }
+  }
+}
+
+SCENARIO("Sharing across threads") {
+  WHEN("Threads copy one vector, read it and mutate their own copies") {
+    SharedEuclideanVector shared{10000, 1.0};
+    std::vector<double> norms(8);
+    std::vector<double> sums(8);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < 8; ++t) {
+      threads.emplace_back([&shared, &norms, &sums, t] {
+        for (int i = 0; i < 1000; ++i) {
+          SharedEuclideanVector copy = shared;
+          norms[t] = copy.GetVector().GetL1Norm();
+        }
+        SharedEuclideanVector mine = shared;
+        mine[0] = static_cast<double>(t);
+        sums[t] = mine.GetVector().GetL1Norm();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    THEN("Every thread read the original, and only its own copy changed") {
+      REQUIRE(shared.UseCount() == 1);
+      REQUIRE(shared.GetVector() == EuclideanVector(10000, 1.0));
+      for (std::size_t t = 0; t < 8; ++t) {
+        REQUIRE(norms[t] == 10000);
+        REQUIRE(sums[t] == 9999 + static_cast<double>(t));
+      }
+    }
+  }
+}
+
+// EXCEPTION - Failed mutations throw before detaching
+SCENARIO("Failed mutations of a shared vector") {
+  WHEN("You index out of range, mismatch dimensions or divide by 0") {
+    SharedEuclideanVector a{3, 1.0};
+    SharedEuclideanVector b = a;
+    THEN("EuclideanVectorError is thrown and the copies still share") {
+      REQUIRE_THROWS_WITH(b.at(3), "Index 3 is not valid for this EuclideanVector object");
+      REQUIRE_THROWS_WITH(b += EuclideanVector(2), "Dimensions of LHS(3) and RHS(2) do not match");
+      REQUIRE_THROWS_WITH(b -= EuclideanVector(4), "Dimensions of LHS(3) and RHS(4) do not match");
+      REQUIRE_THROWS_WITH(b /= 0, "Invalid vector division by 0");
+      REQUIRE(a.UseCount() == 2);
+    }
+  }
+}
@@ -0,0 +1,173 @@
+#include "assignments/ev/vector_geometry.h"
+
+#include <string>
+
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+void CheckDimensions(const EuclideanVector& a, const EuclideanVector& b) {
+  if (a.GetNumDimensions() != b.GetNumDimensions()) {
+    throw EuclideanVectorError("Dimensions of LHS(" + std::to_string(a.GetNumDimensions()) +
+                               ") and RHS(" + std::to_string(b.GetNumDimensions()) +
+                               ") do not match");
+  }
+}
+
+void CheckNonZero(const EuclideanVector& v, const char* operation) {
+  if (SquaredNorm(v.data(), v.GetNumDimensions()) == 0) {
+    throw EuclideanVectorError(std::string("Cannot ") + operation +
+                               " a EuclideanVector with euclidean normal of 0");
+  }
+}
+
+// out = keep v - factor (v . d / d . d) d for any dimension: projection is keep 0, factor -1 and
+//  reflection keep 1, factor 2
+void ProjectGeneric(const double* v, const double* d, std::size_t n, double keep, double factor,
+                    double* out) {
+  double scale = factor * Dot(v, d, n) / SquaredNorm(d, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = keep * v[i] - scale * d[i];
+  }
+}
+
+}  // namespace
+
+/* EUCLIDEAN VECTORS */
+EuclideanVector Cross(const EuclideanVector& a, const EuclideanVector& b) {
+  CheckDimensions(a, b);
+  if (a.GetNumDimensions() != 3) {
+    throw EuclideanVectorError("Cross product is only defined for 3 dimensional EuclideanVectors");
+  }
+  EuclideanVector out(3);
+  Cross3(a.data(), b.data(), out.data());
+  return out;
+}
+
+EuclideanVector Project(const EuclideanVector& v, const EuclideanVector& onto) {
+  CheckDimensions(v, onto);
+  CheckNonZero(onto, "project onto");
+  EuclideanVector out(v.GetNumDimensions());
+  switch (v.GetNumDimensions()) {
+    case 2:
+      Project<2>(v.data(), onto.data(), out.data());
+      break;
+    case 3:
+      Project<3>(v.data(), onto.data(), out.data());
+      break;
+    case 4:
+      Project<4>(v.data(), onto.data(), out.data());
+      break;
+    default:
+      ProjectGeneric(v.data(), onto.data(), v.GetNumDimensions(), 0, -1, out.data());
+  }
+  return out;
+}
+
+EuclideanVector Reflect(const EuclideanVector& v, const EuclideanVector& normal) {
+  CheckDimensions(v, normal);
+  CheckNonZero(normal, "reflect in");
+  EuclideanVector out(v.GetNumDimensions());
+  switch (v.GetNumDimensions()) {
+    case 2:
+      Reflect<2>(v.data(), normal.data(), out.data());
+      break;
+    case 3:
+      Reflect<3>(v.data(), normal.data(), out.data());
+      break;
+    case 4:
+      Reflect<4>(v.data(), normal.data(), out.data());
+      break;
+    default:
+      ProjectGeneric(v.data(), normal.data(), v.GetNumDimensions(), 1, 2, out.data());
+  }
+  return out;
+}
+
+EuclideanVector Rotate(const EuclideanVector& v, const EuclideanVector& q) {
+  if (q.GetNumDimensions() != 4) {
+    throw EuclideanVectorError("Quaternion must have 4 dimensions, not " +
+                               std::to_string(q.GetNumDimensions()));
+  }
+  if (v.GetNumDimensions() != 3 && v.GetNumDimensions() != 4) {
+    throw EuclideanVectorError("Only 3 and 4 dimensional EuclideanVectors can be rotated");
+  }
+  EuclideanVector out = v;
+  QuaternionRotate(q.data(), v.data(), out.data());
+  return out;
+}
+
+/* BATCHES */
+void Vector3Batch::Resize(std::size_t size) {
+  this->x_.resize(size);
+  this->y_.resize(size);
+  this->z_.resize(size);
+}
+
+void Vector3Batch::Add(double x, double y, double z) {
+  this->x_.push_back(x);
+  this->y_.push_back(y);
+  this->z_.push_back(z);
+}
+
+// The batched kernels read every input component of vector i before writing vector i, which keeps
+//  them correct when out is in, and have no dependencies between iterations so the compiler can
+//  vectorise them across vectors
+
+void Cross(const Vector3Batch& in, const std::array<double, 3>& b, Vector3Batch& out) {
+  out.Resize(in.size());
+  const double *x = in.X(), *y = in.Y(), *z = in.Z();
+  double *ox = out.X(), *oy = out.Y(), *oz = out.Z();
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    double cx = y[i] * b[2] - z[i] * b[1];
+    double cy = z[i] * b[0] - x[i] * b[2];
+    double cz = x[i] * b[1] - y[i] * b[0];
+    ox[i] = cx;
+    oy[i] = cy;
+    oz[i] = cz;
+  }
+}
+
+void Project(const Vector3Batch& in, const std::array<double, 3>& onto, Vector3Batch& out) {
+  out.Resize(in.size());
+  const double inverse = 1 / FixedDot<3>(onto.data(), onto.data());
+  const double *x = in.X(), *y = in.Y(), *z = in.Z();
+  double *ox = out.X(), *oy = out.Y(), *oz = out.Z();
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    double scale = (x[i] * onto[0] + y[i] * onto[1] + z[i] * onto[2]) * inverse;
+    ox[i] = scale * onto[0];
+    oy[i] = scale * onto[1];
+    oz[i] = scale * onto[2];
+  }
+}
+
+void Reflect(const Vector3Batch& in, const std::array<double, 3>& normal, Vector3Batch& out) {
+  out.Resize(in.size());
+  const double inverse = 2 / FixedDot<3>(normal.data(), normal.data());
+  const double *x = in.X(), *y = in.Y(), *z = in.Z();
+  double *ox = out.X(), *oy = out.Y(), *oz = out.Z();
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    double scale = (x[i] * normal[0] + y[i] * normal[1] + z[i] * normal[2]) * inverse;
+    ox[i] = x[i] - scale * normal[0];
+    oy[i] = y[i] - scale * normal[1];
+    oz[i] = z[i] - scale * normal[2];
+  }
+}
+
+void Rotate(const Vector3Batch& in, const std::array<double, 4>& q, Vector3Batch& out) {
+  out.Resize(in.size());
+  const double w = q[0], qx = q[1], qy = q[2], qz = q[3];
+  const double *x = in.X(), *y = in.Y(), *z = in.Z();
+  double *ox = out.X(), *oy = out.Y(), *oz = out.Z();
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    double tx = 2 * (qy * z[i] - qz * y[i]);
+    double ty = 2 * (qz * x[i] - qx * z[i]);
+    double tz = 2 * (qx * y[i] - qy * x[i]);
+    double rx = x[i] + w * tx + (qy * tz - qz * ty);
+    double ry = y[i] + w * ty + (qz * tx - qx * tz);
+    double rz = z[i] + w * tz + (qx * ty - qy * tx);
+    ox[i] = rx;
+    oy[i] = ry;
+    oz[i] = rz;
+  }
+}
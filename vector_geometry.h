@@ -0,0 +1,160 @@
+#ifndef ASSIGNMENTS_EV_VECTOR_GEOMETRY_H_
+#define ASSIGNMENTS_EV_VECTOR_GEOMETRY_H_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+
+// Geometry kernels for small vectors.
+//  The kernels work on raw magnitudes with the dimension as a template parameter, so loops unroll
+//  completely and nothing branches on the data or allocates. Outputs may alias inputs. Quaternions
+//  are stored (w, x, y, z) and must have unit length for the rotations to be rotations.
+//
+//  Projecting onto or reflecting in a zero vector gives NaNs here; the EuclideanVector overloads
+//  check for it and throw instead.
+
+/* KERNELS */
+template <int N>
+inline double FixedDot(const double* a, const double* b) noexcept {
+  double sum = 0;
+  for (int i = 0; i < N; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+// z component of the cross product of two 2D vectors (the signed area of their parallelogram)
+inline double Cross2(const double* a, const double* b) noexcept {
+  return a[0] * b[1] - a[1] * b[0];
+}
+
+inline void Cross3(const double* a, const double* b, double* out) noexcept {
+  double x = a[1] * b[2] - a[2] * b[1];
+  double y = a[2] * b[0] - a[0] * b[2];
+  double z = a[0] * b[1] - a[1] * b[0];
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+}
+
+// out = (v . onto / onto . onto) onto
+template <int N>
+inline void Project(const double* v, const double* onto, double* out) noexcept {
+  double scale = FixedDot<N>(v, onto) / FixedDot<N>(onto, onto);
+  for (int i = 0; i < N; ++i) {
+    out[i] = scale * onto[i];
+  }
+}
+
+// Mirror image of v in the hyperplane with the given normal: v - 2 (v . n / n . n) n
+template <int N>
+inline void Reflect(const double* v, const double* normal, double* out) noexcept {
+  double scale = 2 * FixedDot<N>(v, normal) / FixedDot<N>(normal, normal);
+  for (int i = 0; i < N; ++i) {
+    out[i] = v[i] - scale * normal[i];
+  }
+}
+
+// Hamilton product p q, i.e. the rotation q followed by p
+inline void QuaternionMultiply(const double* p, const double* q, double* out) noexcept {
+  double w = p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3];
+  double x = p[0] * q[1] + p[1] * q[0] + p[2] * q[3] - p[3] * q[2];
+  double y = p[0] * q[2] - p[1] * q[3] + p[2] * q[0] + p[3] * q[1];
+  double z = p[0] * q[3] + p[1] * q[2] - p[2] * q[1] + p[3] * q[0];
+  out[0] = w;
+  out[1] = x;
+  out[2] = y;
+  out[3] = z;
+}
+
+// Rotates the 3D vector v by q, using v' = v + w t + u x t with u = (x, y, z) and t = 2 u x v,
+//  which is cheaper than forming q v q* or the rotation matrix
+inline void QuaternionRotate(const double* q, const double* v, double* out) noexcept {
+  double tx = 2 * (q[2] * v[2] - q[3] * v[1]);
+  double ty = 2 * (q[3] * v[0] - q[1] * v[2]);
+  double tz = 2 * (q[1] * v[1] - q[2] * v[0]);
+  double x = v[0] + q[0] * tx + (q[2] * tz - q[3] * ty);
+  double y = v[1] + q[0] * ty + (q[3] * tx - q[1] * tz);
+  double z = v[2] + q[0] * tz + (q[1] * ty - q[2] * tx);
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+}
+
+/* FIXED-SIZE TYPES */
+template <std::size_t N>
+std::array<double, N> Project(const std::array<double, N>& v,
+                              const std::array<double, N>& onto) noexcept {
+  std::array<double, N> out;
+  Project<static_cast<int>(N)>(v.data(), onto.data(), out.data());
+  return out;
+}
+
+template <std::size_t N>
+std::array<double, N> Reflect(const std::array<double, N>& v,
+                              const std::array<double, N>& normal) noexcept {
+  std::array<double, N> out;
+  Reflect<static_cast<int>(N)>(v.data(), normal.data(), out.data());
+  return out;
+}
+
+inline std::array<double, 3> Cross(const std::array<double, 3>& a,
+                                   const std::array<double, 3>& b) noexcept {
+  std::array<double, 3> out;
+  Cross3(a.data(), b.data(), out.data());
+  return out;
+}
+
+inline std::array<double, 3> Rotate(const std::array<double, 3>& v,
+                                    const std::array<double, 4>& q) noexcept {
+  std::array<double, 3> out;
+  QuaternionRotate(q.data(), v.data(), out.data());
+  return out;
+}
+
+/* EUCLIDEAN VECTORS */
+// Each of these throws if the dimensions do not fit. 2, 3 and 4 dimensional vectors use the
+//  kernels above; Project and Reflect fall back to a loop for other dimensions.
+EuclideanVector Cross(const EuclideanVector& a, const EuclideanVector& b);  // 3D only
+EuclideanVector Project(const EuclideanVector& v, const EuclideanVector& onto);
+EuclideanVector Reflect(const EuclideanVector& v, const EuclideanVector& normal);
+// Rotates a 3D vector, or the first three dimensions of a 4D (homogeneous) vector, by the 4D
+//  quaternion q
+EuclideanVector Rotate(const EuclideanVector& v, const EuclideanVector& q);
+
+/* BATCHES */
+// Many 3D vectors in structure-of-arrays layout, so that the batched kernels below process
+//  consecutive vectors with straight-line loops over each component
+class Vector3Batch {
+ public:
+  /* METHODS */
+  std::size_t size() const noexcept { return this->x_.size(); }
+  void Resize(std::size_t size);
+  void Add(double x, double y, double z);
+
+  double* X() noexcept { return this->x_.data(); }
+  double* Y() noexcept { return this->y_.data(); }
+  double* Z() noexcept { return this->z_.data(); }
+  const double* X() const noexcept { return this->x_.data(); }
+  const double* Y() const noexcept { return this->y_.data(); }
+  const double* Z() const noexcept { return this->z_.data(); }
+
+  std::array<double, 3> Get(std::size_t i) const noexcept {
+    return {this->x_[i], this->y_[i], this->z_[i]};
+  }
+
+ private:
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<double> z_;
+};
+
+// Each writes one result per vector of in to out (resized to match; out may be in)
+void Cross(const Vector3Batch& in, const std::array<double, 3>& b, Vector3Batch& out);
+void Project(const Vector3Batch& in, const std::array<double, 3>& onto, Vector3Batch& out);
+void Reflect(const Vector3Batch& in, const std::array<double, 3>& normal, Vector3Batch& out);
+void Rotate(const Vector3Batch& in, const std::array<double, 4>& q, Vector3Batch& out);
+
+#endif  // ASSIGNMENTS_EV_VECTOR_GEOMETRY_H_
@@ -0,0 +1,167 @@
+/*
+
+  == Explanation and rational of testing ==
+  Each operation is checked against cases whose answers are known exactly (axis vectors, right
+  angle rotations) and against its defining property on general input: a cross product is
+  perpendicular to both inputs, a projection leaves a residual perpendicular to the direction, a
+  reflection keeps the length and applied twice is the identity, and a rotation keeps the length
+  and composes like quaternion multiplication. The batched versions must agree with the single
+  vector kernels, including when the output batch is the input batch.
+
+*/
+
+#include "assignments/ev/vector_geometry.h"
+
+#include <cmath>
+
+#include "catch.h"
+
+namespace {
+
+EuclideanVector Make(std::vector<double> magnitudes) {
+  return EuclideanVector(magnitudes.cbegin(), magnitudes.cend());
+}
+
+}  // namespace
+
+SCENARIO("Cross products") {
+  WHEN("You cross the x and y axes") {
+    THEN("You get the z axis, and the 2D cross product is the signed area") {
+      REQUIRE(Cross(Make({1, 0, 0}), Make({0, 1, 0})) == Make({0, 0, 1}));
+      REQUIRE(Cross(std::array<double, 3>{0, 1, 0}, {1, 0, 0}) == std::array<double, 3>{0, 0, -1});
+      double a[] = {2, 0};
+      double b[] = {1, 3};
+      REQUIRE(Cross2(a, b) == 6);
+      REQUIRE(Cross2(b, a) == -6);
+    }
+  }
+  WHEN("You cross two general vectors") {
+    EuclideanVector a = Make({1.5, -2, 0.25});
+    EuclideanVector b = Make({-3, 0.5, 4});
+    EuclideanVector c = Cross(a, b);
+    THEN("The result is perpendicular to both") {
+      REQUIRE(c * a == Approx(0).margin(1e-12));
+      REQUIRE(c * b == Approx(0).margin(1e-12));
+      REQUIRE(Cross(b, a) == -1 * c);
+    }
+  }
+}
+
+SCENARIO("Projection and reflection") {
+  WHEN("You project and reflect in 2, 3, 4 and 6 dimensions") {
+    THEN("The residual is perpendicular, and a reflection keeps the length and undoes itself") {
+      for (std::size_t n : {2, 3, 4, 6}) {
+        EuclideanVector v{n};
+        EuclideanVector d{n};
+        for (std::size_t i = 0; i < n; ++i) {
+          v[i] = 1.5 * i - 2;
+          d[i] = 0.5 + i * i;
+        }
+        EuclideanVector p = Project(v, d);
+        EuclideanVector r = Reflect(v, d);
+        INFO(n);
+        REQUIRE((v - p) * d == Approx(0).margin(1e-12));
+        REQUIRE(ApproxEqual(p, ((v * d) / (d * d)) * d, 1e-12));
+        REQUIRE(r.GetEuclideanNorm() == Approx(v.GetEuclideanNorm()));
+        REQUIRE(ApproxEqual(Reflect(r, d), v, 1e-12));
+        REQUIRE(ApproxEqual(r, v - 2 * p, 1e-12));
+      }
+    }
+  }
+  WHEN("You use fixed-size arrays") {
+    std::array<double, 3> v{3, 4, 5};
+    std::array<double, 3> x_axis{2, 0, 0};
+    THEN("The results match the EuclideanVector versions") {
+      REQUIRE(Project(v, x_axis) == std::array<double, 3>{3, 0, 0});
+      REQUIRE(Reflect(v, x_axis) == std::array<double, 3>{-3, 4, 5});
+    }
+  }
+}
+
+SCENARIO("Rotation by quaternion") {
+  const double h = std::sqrt(0.5);
+  WHEN("You rotate the x axis a quarter turn about z") {
+    std::array<double, 4> q{h, 0, 0, h};
+    std::array<double, 3> r = Rotate(std::array<double, 3>{1, 0, 0}, q);
+    THEN("It becomes the y axis") {
+      REQUIRE(r[0] == Approx(0).margin(1e-15));
+      REQUIRE(r[1] == Approx(1));
+      REQUIRE(r[2] == Approx(0).margin(1e-15));
+    }
+  }
+  WHEN("You rotate by two quaternions in turn") {
+    double p[] = {0.5, 0.5, -0.5, 0.5};
+    double q[] = {std::cos(0.3), std::sin(0.3) * 0.6, 0, std::sin(0.3) * 0.8};
+    double pq[4];
+    QuaternionMultiply(p, q, pq);
+    double v[] = {0.3, -1.2, 2.5};
+    double step[3];
+    double both[3];
+    QuaternionRotate(q, v, step);
+    QuaternionRotate(p, step, step);
+    QuaternionRotate(pq, v, both);
+    THEN("That equals rotating by their product, and the length is kept") {
+      for (int i = 0; i < 3; ++i) {
+        REQUIRE(step[i] == Approx(both[i]));
+      }
+      REQUIRE(FixedDot<3>(both, both) == Approx(FixedDot<3>(v, v)));
+    }
+  }
+  WHEN("You rotate a homogeneous 4D EuclideanVector") {
+    EuclideanVector r = Rotate(Make({0, 2, 0, 1}), Make({h, h, 0, 0}));
+    THEN("The first three dimensions rotate and the fourth is kept") {
+      REQUIRE(ApproxEqual(r, Make({0, 0, 2, 1}), 1e-15));
+    }
+  }
+}
+
+SCENARIO("Batched structure-of-arrays kernels") {
+  WHEN("You transform a batch of 3D vectors") {
+    Vector3Batch batch;
+    for (int i = 0; i < 37; ++i) {
+      batch.Add(std::sin(i), std::cos(2.0 * i), 0.1 * i - 1);
+    }
+    const std::array<double, 3> d{0.3, -1.1, 2};
+    const std::array<double, 4> q{0.5, 0.5, -0.5, 0.5};
+    Vector3Batch cross, project, reflect, rotate = batch;
+    Cross(batch, d, cross);
+    Project(batch, d, project);
+    Reflect(batch, d, reflect);
+    Rotate(rotate, q, rotate);
+
+    THEN("Every vector matches the single vector kernels") {
+      REQUIRE(rotate.size() == 37);
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        auto v = batch.Get(i);
+        auto expected = {Cross(v, d), Project(v, d), Reflect(v, d), Rotate(v, q)};
+        auto actual = {cross.Get(i), project.Get(i), reflect.Get(i), rotate.Get(i)};
+        auto e = expected.begin();
+        for (auto a = actual.begin(); a != actual.end(); ++a, ++e) {
+          for (std::size_t j = 0; j < 3; ++j) {
+            REQUIRE((*a)[j] == Approx((*e)[j]).margin(1e-14));
+          }
+        }
+      }
+    }
+  }
+}
+
+// EXCEPTION - Dimensions must fit the operation and directions must be non-zero
+SCENARIO("Invalid geometry operations") {
+  WHEN("You pass vectors of the wrong dimensions or a zero direction") {
+    THEN("An exception is thrown") {
+      REQUIRE_THROWS_WITH(Cross(Make({1, 2}), Make({3, 4})),
+                          "Cross product is only defined for 3 dimensional EuclideanVectors");
+      REQUIRE_THROWS_WITH(Cross(Make({1, 2, 3}), Make({3, 4})),
+                          "Dimensions of LHS(3) and RHS(2) do not match");
+      REQUIRE_THROWS_WITH(Project(Make({1, 2}), Make({0, 0})),
+                          "Cannot project onto a EuclideanVector with euclidean normal of 0");
+      REQUIRE_THROWS_WITH(Reflect(Make({1, 2}), Make({0, 0})),
+                          "Cannot reflect in a EuclideanVector with euclidean normal of 0");
+      REQUIRE_THROWS_WITH(Rotate(Make({1, 2, 3}), Make({1, 0, 0})),
+                          "Quaternion must have 4 dimensions, not 3");
+      REQUIRE_THROWS_WITH(Rotate(Make({1, 2}), Make({1, 0, 0, 0})),
+                          "Only 3 and 4 dimensional EuclideanVectors can be rotated");
+    }
+  }
+}
@@ -0,0 +1,202 @@
+#include "assignments/ev/vector_kernels.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "assignments/ev/kernel_dispatch.h"
+
+namespace {
+
+// Magnitudes compared per block before checking for a mismatch
+constexpr std::size_t kCompareBlock = 8;
+
+// splitmix64 finaliser: spreads every input bit over the whole output
+std::uint64_t Mix(std::uint64_t x) noexcept {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// Bit pattern of x, with -0.0 folded onto 0.0 since the two compare equal
+std::uint64_t Bits(double x) noexcept {
+  std::uint64_t bits;
+  x = x == 0 ? 0.0 : x;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+}  // namespace
+
+// Dot, SquaredDistance and the element-wise kernels go through the dispatch table, which picks
+//  the implementation for the host's instruction set (see kernel_dispatch.h)
+
+double Dot(const double* a, const double* b, std::size_t n) noexcept {
+  return ActiveKernels().dot(a, b, n);
+}
+
+double SquaredNorm(const double* a, std::size_t n) noexcept {
+  return ActiveKernels().dot(a, a, n);
+}
+
+double SquaredDistance(const double* a, const double* b, std::size_t n) noexcept {
+  return ActiveKernels().squared_distance(a, b, n);
+}
+
+void AddMagnitudes(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  ActiveKernels().add(a, b, out, n);
+}
+
+void SubtractMagnitudes(const double* a, const double* b, double* out, std::size_t n) noexcept {
+  ActiveKernels().subtract(a, b, out, n);
+}
+
+void ScaleMagnitudes(const double* a, double s, double* out, std::size_t n) noexcept {
+  ActiveKernels().scale(a, s, out, n);
+}
+
+void AdcScan(const std::uint8_t* codes,
+             std::size_t m,
+             const float* table,
+             float* distances,
+             std::size_t n) noexcept {
+  ActiveKernels().adc_scan(codes, m, table, distances, n);
+}
+
+double ScaledNorm(const double* a, std::size_t n) noexcept {
+  double scale = 0;
+  double ssq = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (a[i] == 0) {
+      continue;
+    }
+    double x = std::fabs(a[i]);
+    // Checked before scaling, where a second infinity would give inf / inf = NaN
+    if (std::isinf(x)) {
+      return x;
+    }
+    if (scale < x) {
+      double r = scale / x;
+      ssq = 1 + ssq * r * r;
+      scale = x;
+    } else {
+      double r = x / scale;
+      ssq += r * r;
+    }
+  }
+  return scale * std::sqrt(ssq);
+}
+
+// Each square is split into its rounded value p and exact rounding error e (via fma); p is added
+//  with Neumaier's correction and every error term is collected separately
+double CompensatedSquaredNorm(const double* a, std::size_t n) noexcept {
+  double sum = 0;
+  double compensation = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    double p = a[i] * a[i];
+    double e = std::fma(a[i], a[i], -p);
+    double t = sum + p;
+    compensation += std::fabs(sum) >= std::fabs(p) ? (sum - t) + p : (p - t) + sum;
+    compensation += e;
+    sum = t;
+  }
+  return sum + compensation;
+}
+
+double L1Norm(const double* a, std::size_t n) noexcept {
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += std::fabs(a[i]);
+    s1 += std::fabs(a[i + 1]);
+    s2 += std::fabs(a[i + 2]);
+    s3 += std::fabs(a[i + 3]);
+  }
+  for (; i < n; ++i) {
+    s0 += std::fabs(a[i]);
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+double InfinityNorm(const double* a, std::size_t n) noexcept {
+  double m = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    double x = std::fabs(a[i]);
+    m = x > m || std::isnan(x) ? x : m;
+  }
+  return m;
+}
+
+double LpNorm(const double* a, std::size_t n, double p) noexcept {
+  if (p == 1) {
+    return L1Norm(a, n);
+  }
+  if (p == 2) {
+    return ScaledNorm(a, n);
+  }
+  if (std::isinf(p)) {
+    return InfinityNorm(a, n);
+  }
+  double scale = 0;
+  double sum = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (a[i] == 0) {
+      continue;
+    }
+    double x = std::fabs(a[i]);
+    if (std::isinf(x)) {
+      return x;
+    }
+    if (scale < x) {
+      sum = 1 + sum * std::pow(scale / x, p);
+      scale = x;
+    } else {
+      sum += std::pow(x / scale, p);
+    }
+  }
+  return scale * std::pow(sum, 1 / p);
+}
+
+// Each block is compared without branching (so it vectorises) and the loop only stops between
+//  blocks, keeping the early exit for vectors that differ near the start
+bool EqualMagnitudes(const double* a, const double* b, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + kCompareBlock <= n; i += kCompareBlock) {
+    bool differ = false;
+    for (std::size_t j = 0; j < kCompareBlock; ++j) {
+      differ |= a[i + j] != b[i + j];
+    }
+    if (differ) {
+      return false;
+    }
+  }
+  for (; i < n; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Four independent lanes are mixed in parallel and folded together at the end
+std::uint64_t HashMagnitudes(const double* a, std::size_t n) noexcept {
+  const std::uint64_t k = 0x9E3779B97F4A7C15ULL;
+  std::uint64_t h0 = static_cast<std::uint64_t>(n) * k, h1 = h0 + 1, h2 = h0 + 2, h3 = h0 + 3;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    h0 = (h0 ^ Bits(a[i])) * k;
+    h1 = (h1 ^ Bits(a[i + 1])) * k;
+    h2 = (h2 ^ Bits(a[i + 2])) * k;
+    h3 = (h3 ^ Bits(a[i + 3])) * k;
+    h0 ^= h0 >> 29;
+    h1 ^= h1 >> 29;
+    h2 ^= h2 >> 29;
+    h3 ^= h3 >> 29;
+  }
+  for (; i < n; ++i) {
+    h0 = (h0 ^ Bits(a[i])) * k;
+    h0 ^= h0 >> 29;
+  }
+  return Mix(Mix(h0) ^ (Mix(h1) + 1) ^ (Mix(h2) + 2) ^ (Mix(h3) + 3));
+}
@@ -0,0 +1,57 @@
+#ifndef ASSIGNMENTS_EV_VECTOR_KERNELS_H_
+#define ASSIGNMENTS_EV_VECTOR_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Raw kernels over contiguous magnitudes. These take plain pointers so that they can be shared
+// between EuclideanVector and the batch/index types, which keep many vectors in one buffer.
+
+// Returns the dot product of a and b over n dimensions
+double Dot(const double* a, const double* b, std::size_t n) noexcept;
+
+// Returns the sum of squares of a over n dimensions (squared euclidean norm)
+double SquaredNorm(const double* a, std::size_t n) noexcept;
+
+// Returns the euclidean norm of a using LAPACK dnrm2 style scaling: a running maximum keeps the
+//  summed terms near 1, so the result only overflows/underflows if the norm itself does. Any
+//  infinite magnitude gives +inf, even alongside a NaN, like std::hypot
+double ScaledNorm(const double* a, std::size_t n) noexcept;
+
+// Returns the sum of squares of a with compensated (Neumaier) summation of exact products, which
+//  is accurate to roughly twice double precision
+double CompensatedSquaredNorm(const double* a, std::size_t n) noexcept;
+
+// Returns sum |a[i]|
+double L1Norm(const double* a, std::size_t n) noexcept;
+
+// Returns max |a[i]|
+double InfinityNorm(const double* a, std::size_t n) noexcept;
+
+// Returns (sum |a[i]|^p)^(1/p) for p >= 1, scaled like ScaledNorm
+double LpNorm(const double* a, std::size_t n, double p) noexcept;
+
+// Returns the squared euclidean distance between a and b over n dimensions
+double SquaredDistance(const double* a, const double* b, std::size_t n) noexcept;
+
+// out[i] = a[i] + b[i], a[i] - b[i] and a[i] * s respectively; out may be a or b
+void AddMagnitudes(const double* a, const double* b, double* out, std::size_t n) noexcept;
+void SubtractMagnitudes(const double* a, const double* b, double* out, std::size_t n) noexcept;
+void ScaleMagnitudes(const double* a, double s, double* out, std::size_t n) noexcept;
+
+// Asymmetric distance computation for product quantisation: distances[i] is the sum over s < m
+//  of table[s * kAdcTableStride + codes[i * m + s]], added in order of s, for n codes of m bytes
+constexpr std::size_t kAdcTableStride = 256;
+void AdcScan(const std::uint8_t* codes,
+             std::size_t m,
+             const float* table,
+             float* distances,
+             std::size_t n) noexcept;
+
+// Returns true if a[i] == b[i] for every i < n (exact floating point comparison)
+bool EqualMagnitudes(const double* a, const double* b, std::size_t n) noexcept;
+
+// Returns a 64-bit hash of n magnitudes; magnitudes that compare equal hash equally
+std::uint64_t HashMagnitudes(const double* a, std::size_t n) noexcept;
+
+#endif  // ASSIGNMENTS_EV_VECTOR_KERNELS_H_
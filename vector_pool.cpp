@@ -0,0 +1,314 @@
+#include "assignments/ev/vector_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr int kGlobalBins = 8;                  // batches each bucket can park globally
+constexpr std::size_t kBatchBytes = 64 * 1024;  // target size of a batch moved between caches
+
+// Precedes every buffer; next links free buffers into a list
+struct alignas(alignof(std::max_align_t)) BufferHeader {
+  std::uint64_t capacity : 62;
+  std::uint64_t pooled : 1;  // counts towards the pool's footprint
+  std::uint64_t huge : 1;    // aligned to kHugePageBytes
+  BufferHeader* next;
+};
+
+double* Data(BufferHeader* header) noexcept {
+  return reinterpret_cast<double*>(header + 1);
+}
+
+BufferHeader* Header(double* magnitudes) noexcept {
+  return reinterpret_cast<BufferHeader*>(magnitudes) - 1;
+}
+
+std::size_t Bytes(std::size_t capacity) noexcept {
+  return sizeof(BufferHeader) + sizeof(double) * capacity;
+}
+
+// Buffers per batch: about kBatchBytes worth, but at least 2 and at most 64
+std::uint32_t BatchSize(std::size_t capacity) noexcept {
+  return static_cast<std::uint32_t>(std::clamp<std::size_t>(kBatchBytes / Bytes(capacity), 2, 64));
+}
+
+// Each bin is empty or holds one batch. Batches are only taken out with exchange and put into
+//  empty bins with compare-exchange, so a bin can never be observed half-updated (no ABA).
+std::atomic<BufferHeader*> g_bins[kMaxPooledDimensions + 1][kGlobalBins];
+
+std::atomic<bool> g_enabled{false};
+std::atomic<std::uint64_t> g_footprint{0};
+std::atomic<std::uint64_t> g_high_water{0};
+
+// Counters written only by their owning thread and read by GetVectorPoolStats
+struct Counters {
+  std::atomic<std::uint64_t> acquires{0};
+  std::atomic<std::uint64_t> hits{0};
+  std::atomic<std::uint64_t> releases{0};
+};
+
+void Increment(std::atomic<std::uint64_t>& counter) noexcept {
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void AddFootprint(std::uint64_t bytes) noexcept {
+  std::uint64_t footprint = g_footprint.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  std::uint64_t high_water = g_high_water.load(std::memory_order_relaxed);
+  while (footprint > high_water &&
+         !g_high_water.compare_exchange_weak(high_water, footprint, std::memory_order_relaxed)) {
+  }
+}
+
+// Advice only: if the kernel refuses, or has transparent huge pages off, normal pages are used
+void AdviseHugePages(void* memory, std::size_t bytes) noexcept {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  madvise(memory, bytes, MADV_HUGEPAGE);
+#else
+  (void)memory;
+  (void)bytes;
+#endif
+}
+
+BufferHeader* Allocate(std::size_t capacity, bool pooled) {
+  std::size_t bytes = Bytes(capacity);
+  const bool huge = bytes >= kHugePageBytes;
+  BufferHeader* header;
+  if (huge) {
+    // Whole huge pages, so that the tail of the buffer is eligible too
+    bytes = (bytes + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+    header = static_cast<BufferHeader*>(::operator new(bytes, std::align_val_t{kHugePageBytes}));
+    AdviseHugePages(header, bytes);
+  } else {
+    header = static_cast<BufferHeader*>(::operator new(bytes));
+  }
+  header->capacity = capacity;
+  header->pooled = pooled ? 1 : 0;
+  header->huge = huge ? 1 : 0;
+  header->next = nullptr;
+  if (pooled) {
+    AddFootprint(Bytes(capacity));
+  }
+  return header;
+}
+
+void Free(BufferHeader* header) noexcept {
+  if (header->pooled) {
+    g_footprint.fetch_sub(Bytes(header->capacity), std::memory_order_relaxed);
+  }
+  if (header->huge) {
+    ::operator delete(header, std::align_val_t{kHugePageBytes});
+  } else {
+    ::operator delete(header);
+  }
+}
+
+void FreeList(BufferHeader* head) noexcept {
+  while (head != nullptr) {
+    BufferHeader* next = head->next;
+    Free(head);
+    head = next;
+  }
+}
+
+// Parks a batch in an empty bin of its bucket, or frees it if every bin is taken
+void PushBatch(std::size_t capacity, BufferHeader* batch) noexcept {
+  for (auto& bin : g_bins[capacity]) {
+    BufferHeader* expected = nullptr;
+    if (bin.load(std::memory_order_relaxed) == nullptr &&
+        bin.compare_exchange_strong(expected, batch, std::memory_order_release)) {
+      return;
+    }
+  }
+  FreeList(batch);
+}
+
+BufferHeader* PopBatch(std::size_t capacity) noexcept {
+  for (auto& bin : g_bins[capacity]) {
+    if (bin.load(std::memory_order_relaxed) != nullptr) {
+      if (BufferHeader* batch = bin.exchange(nullptr, std::memory_order_acquire)) {
+        return batch;
+      }
+    }
+  }
+  return nullptr;
+}
+
+struct Bucket {
+  BufferHeader* head;
+  std::uint32_t count;
+};
+
+struct ThreadCache;
+
+// Every live thread cache, plus the counters of the threads that have exited
+std::mutex g_registry_mutex;
+std::vector<ThreadCache*> g_registry;
+std::uint64_t g_retired[3];
+std::uint64_t g_baseline[3];
+
+thread_local bool t_cache_destroyed = false;
+
+struct ThreadCache {
+  std::array<Bucket, kMaxPooledDimensions + 1> buckets{};
+  Counters counters;
+  bool registered = false;
+
+  // Constructed inside the noexcept deleter, so a registry that cannot grow leaves the thread
+  //  unregistered, and without a cache, instead of throwing
+  ThreadCache() noexcept {
+    try {
+      std::lock_guard lock{g_registry_mutex};
+      g_registry.push_back(this);
+      this->registered = true;
+    } catch (...) {
+      // buffers are freed and allocated directly, like on a thread that is exiting
+    }
+  }
+
+  // Hands the cached buffers to the global bins so that other threads can still use them
+  ~ThreadCache() {
+    t_cache_destroyed = true;
+    if (!this->registered) {
+      return;
+    }
+    for (std::size_t capacity = 1; capacity <= kMaxPooledDimensions; ++capacity) {
+      if (this->buckets[capacity].head != nullptr) {
+        PushBatch(capacity, this->buckets[capacity].head);
+      }
+    }
+    std::lock_guard lock{g_registry_mutex};
+    g_retired[0] += this->counters.acquires.load(std::memory_order_relaxed);
+    g_retired[1] += this->counters.hits.load(std::memory_order_relaxed);
+    g_retired[2] += this->counters.releases.load(std::memory_order_relaxed);
+    g_registry.erase(std::find(g_registry.begin(), g_registry.end(), this));
+  }
+};
+
+// The calling thread's cache, or nullptr while the thread is exiting or if it could not be
+//  registered
+ThreadCache* LocalCache() noexcept {
+  if (t_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local ThreadCache cache;
+  return cache.registered ? &cache : nullptr;
+}
+
+// Totals of the three counters across every thread, past and present
+void SumCounters(std::uint64_t (&sums)[3]) {
+  std::copy(std::begin(g_retired), std::end(g_retired), sums);
+  for (const ThreadCache* cache : g_registry) {
+    sums[0] += cache->counters.acquires.load(std::memory_order_relaxed);
+    sums[1] += cache->counters.hits.load(std::memory_order_relaxed);
+    sums[2] += cache->counters.releases.load(std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+// Keeps the buffer in this thread's cache; once the bucket holds two batches' worth, the older
+//  batch moves to the global bins
+void MagnitudesDeleter::operator()(double* magnitudes) const noexcept {
+  BufferHeader* header = Header(magnitudes);
+  ThreadCache* cache = nullptr;
+  if (header->pooled && g_enabled.load(std::memory_order_relaxed)) {
+    cache = LocalCache();
+  }
+  if (cache == nullptr) {
+    Free(header);
+    return;
+  }
+
+  Increment(cache->counters.releases);
+  Bucket& bucket = cache->buckets[header->capacity];
+  header->next = bucket.head;
+  bucket.head = header;
+  const std::uint32_t batch_size = BatchSize(header->capacity);
+  if (++bucket.count < 2 * batch_size) {
+    return;
+  }
+  BufferHeader* last = bucket.head;
+  for (std::uint32_t i = 1; i < batch_size; ++i) {
+    last = last->next;
+  }
+  BufferHeader* older = last->next;
+  last->next = nullptr;
+  bucket.count = batch_size;
+  PushBatch(header->capacity, older);
+}
+
+// Takes from this thread's cache, refilling it with a whole batch from the global bins when empty
+Magnitudes AcquireMagnitudes(std::size_t capacity) {
+  if (capacity == 0 || capacity > kMaxPooledDimensions ||
+      !g_enabled.load(std::memory_order_relaxed)) {
+    return Magnitudes{Data(Allocate(capacity, false))};
+  }
+  ThreadCache* cache = LocalCache();
+  if (cache == nullptr) {
+    return Magnitudes{Data(Allocate(capacity, true))};
+  }
+
+  Increment(cache->counters.acquires);
+  Bucket& bucket = cache->buckets[capacity];
+  if (bucket.head == nullptr) {
+    bucket.head = PopBatch(capacity);
+    for (BufferHeader* header = bucket.head; header != nullptr; header = header->next) {
+      ++bucket.count;
+    }
+  }
+  if (bucket.head == nullptr) {
+    return Magnitudes{Data(Allocate(capacity, true))};
+  }
+  Increment(cache->counters.hits);
+  BufferHeader* header = bucket.head;
+  bucket.head = header->next;
+  --bucket.count;
+  return Magnitudes{Data(header)};
+}
+
+void SetVectorPoolEnabled(bool enabled) noexcept {
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsVectorPoolEnabled() noexcept {
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+void TrimVectorPool() noexcept {
+  for (std::size_t capacity = 1; capacity <= kMaxPooledDimensions; ++capacity) {
+    for (auto& bin : g_bins[capacity]) {
+      FreeList(bin.exchange(nullptr, std::memory_order_acquire));
+    }
+  }
+  if (ThreadCache* cache = LocalCache()) {
+    for (auto& bucket : cache->buckets) {
+      FreeList(bucket.head);
+      bucket = Bucket{nullptr, 0};
+    }
+  }
+}
+
+VectorPoolStats GetVectorPoolStats() noexcept {
+  std::uint64_t sums[3];
+  std::lock_guard lock{g_registry_mutex};
+  SumCounters(sums);
+  return VectorPoolStats{sums[0] - g_baseline[0], sums[1] - g_baseline[1],
+                         sums[2] - g_baseline[2], g_footprint.load(std::memory_order_relaxed),
+                         g_high_water.load(std::memory_order_relaxed)};
+}
+
+void ResetVectorPoolStats() noexcept {
+  std::lock_guard lock{g_registry_mutex};
+  SumCounters(g_baseline);
+  g_high_water.store(g_footprint.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
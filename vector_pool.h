@@ -0,0 +1,65 @@
+#ifndef ASSIGNMENTS_EV_VECTOR_POOL_H_
+#define ASSIGNMENTS_EV_VECTOR_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Recycling of EuclideanVector magnitude buffers.
+//  While the pool is enabled, released buffers of up to kMaxPooledDimensions doubles are kept in a
+//  cache owned by the releasing thread, bucketed by their exact capacity, and handed out again by
+//  AcquireMagnitudes without going to the allocator. When a thread's bucket overflows, half of it
+//  moves as one batch to a small set of global bins that other threads refill from; bins are
+//  claimed and filled with single atomic exchanges and compare-exchanges, so no lock is taken on
+//  either path. Buffers that fit nowhere are freed.
+//
+//  The pool is off by default, in which case every buffer comes from and goes back to operator
+//  new/delete.
+//
+//  Buffers of kHugePageBytes or more are never pooled. They are aligned to a huge page and, on
+//  Linux, advised (madvise MADV_HUGEPAGE) to be backed by transparent huge pages, which cuts TLB
+//  misses when scanning very large vectors.
+
+constexpr std::size_t kMaxPooledDimensions = 1024;
+constexpr std::size_t kHugePageBytes = std::size_t{2} << 20;
+
+// A point-in-time view of the pool
+//  acquires         - buffers handed out by AcquireMagnitudes
+//  hits             - ... of which were recycled instead of allocated
+//  releases         - buffers handed back
+//  footprint_bytes  - bytes of pooled buffers currently allocated, in use or cached
+//  high_water_bytes - most footprint_bytes at any one time
+struct VectorPoolStats {
+  std::uint64_t acquires;
+  std::uint64_t hits;
+  std::uint64_t releases;
+  std::uint64_t footprint_bytes;
+  std::uint64_t high_water_bytes;
+
+  double HitRate() const noexcept {
+    return acquires == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(acquires);
+  }
+};
+
+// Returns a magnitude buffer to the pool (or to the allocator)
+struct MagnitudesDeleter {
+  void operator()(double* magnitudes) const noexcept;
+};
+
+using Magnitudes = std::unique_ptr<double[], MagnitudesDeleter>;
+
+// Uninitialised buffer of exactly capacity doubles
+Magnitudes AcquireMagnitudes(std::size_t capacity);
+
+void SetVectorPoolEnabled(bool enabled) noexcept;
+bool IsVectorPoolEnabled() noexcept;
+
+// Frees the buffers cached in the global bins and in the calling thread's cache
+void TrimVectorPool() noexcept;
+
+// Snapshot of the counters (safe to call while other threads use the pool)
+VectorPoolStats GetVectorPoolStats() noexcept;
+// Zeroes the counters and lowers the high-water mark to the current footprint
+void ResetVectorPoolStats() noexcept;
+
+#endif  // ASSIGNMENTS_EV_VECTOR_POOL_H_
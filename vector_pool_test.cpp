@@ -0,0 +1,160 @@
+/*
+
+  == Explanation and rational of testing ==
+  The pool must be invisible to EuclideanVector's behaviour, so the tests check values as well as
+  counters. Recycling within one thread should make almost every acquire a hit. Vectors created
+  on one thread and destroyed on another exercise the path through the global bins, which is
+  where a lock-free bug would show up (as a wrong value, a crash under the sanitizers or a
+  mismatch between acquires and releases). Every scenario switches the pool back off and trims it
+  so that the footprint returns to zero and later tests see the default allocator behaviour.
+  Vectors over a huge page never enter the pool; they are checked for their alignment and for
+  being filled in full by the parallel first-touch fill.
+
+*/
+
+#include "assignments/ev/vector_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "catch.h"
+
+SCENARIO("The pool is off by default") {
+  WHEN("You create and destroy vectors without enabling it") {
+    ResetVectorPoolStats();
+    for (int i = 0; i < 10; ++i) {
+      EuclideanVector ev{16, 1.0};
+    }
+
+    THEN("Nothing goes through the pool") {
+      REQUIRE_FALSE(IsVectorPoolEnabled());
+      REQUIRE(GetVectorPoolStats().acquires == 0);
+      REQUIRE(GetVectorPoolStats().footprint_bytes == 0);
+    }
+  }
+}
+
+SCENARIO("Recycling buffers within one thread") {
+  WHEN("You repeatedly create, copy and destroy 64 dimensional vectors") {
+    SetVectorPoolEnabled(true);
+    ResetVectorPoolStats();
+    double total = 0;
+    for (int i = 0; i < 1000; ++i) {
+      EuclideanVector a{64, static_cast<double>(i)};
+      EuclideanVector b = a;
+      total += (a + b)[63];
+    }
+    VectorPoolStats stats = GetVectorPoolStats();
+    SetVectorPoolEnabled(false);
+    TrimVectorPool();
+
+    THEN("Values are unaffected and nearly every buffer is recycled") {
+      REQUIRE(total == 999.0 * 1000);
+      REQUIRE(stats.acquires == 3000);
+      REQUIRE(stats.releases == 3000);
+      REQUIRE(stats.HitRate() > 0.99);
+      REQUIRE(stats.high_water_bytes >= 3 * 64 * sizeof(double));
+      REQUIRE(stats.high_water_bytes < 64 * 1024);
+      REQUIRE(GetVectorPoolStats().footprint_bytes == 0);
+    }
+  }
+  WHEN("You create vectors too large to pool") {
+    SetVectorPoolEnabled(true);
+    ResetVectorPoolStats();
+    {
+      EuclideanVector ev{kMaxPooledDimensions + 1, 2.0};
+      REQUIRE(ev[kMaxPooledDimensions] == 2.0);
+    }
+    SetVectorPoolEnabled(false);
+
+    THEN("They bypass the pool") {
+      REQUIRE(GetVectorPoolStats().acquires == 0);
+      REQUIRE(GetVectorPoolStats().footprint_bytes == 0);
+    }
+  }
+}
+
+SCENARIO("Buffers passed between threads") {
+  WHEN("Producer threads create vectors that consumer threads destroy") {
+    SetVectorPoolEnabled(true);
+    ResetVectorPoolStats();
+    constexpr int kThreads = 4;
+    constexpr int kVectors = 5000;
+    std::vector<std::vector<EuclideanVector>> handoff(kThreads);
+    std::vector<int> errors(kThreads, 0);
+    for (int round = 0; round < 3; ++round) {
+      std::vector<std::thread> producers;
+      for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&, t] {
+          for (int i = 0; i < kVectors; ++i) {
+            handoff[static_cast<std::size_t>(t)].emplace_back(8, static_cast<double>(t + i));
+          }
+        });
+      }
+      for (auto& thread : producers) {
+        thread.join();
+      }
+      std::vector<std::thread> consumers;
+      for (int t = 0; t < kThreads; ++t) {
+        consumers.emplace_back([&, t] {
+          // Each consumer destroys another producer's vectors
+          auto& evs = handoff[static_cast<std::size_t>((t + 1) % kThreads)];
+          for (int i = 0; i < kVectors; ++i) {
+            const auto& ev = evs[static_cast<std::size_t>(i)];
+            if (ev[0] != ev[7] || ev[0] != static_cast<double>((t + 1) % kThreads + i)) {
+              ++errors[static_cast<std::size_t>(t)];
+            }
+          }
+          evs.clear();
+          evs.shrink_to_fit();
+        });
+      }
+      for (auto& thread : consumers) {
+        thread.join();
+      }
+    }
+    VectorPoolStats stats = GetVectorPoolStats();
+    SetVectorPoolEnabled(false);
+    TrimVectorPool();
+
+    THEN("Every vector keeps its values and every buffer comes back") {
+      REQUIRE(errors == std::vector<int>(kThreads, 0));
+      REQUIRE(stats.acquires == static_cast<std::uint64_t>(3 * kThreads * kVectors));
+      REQUIRE(stats.releases == stats.acquires);
+      REQUIRE(stats.hits > 0);
+      REQUIRE(stats.high_water_bytes >= stats.footprint_bytes);
+      REQUIRE(GetVectorPoolStats().footprint_bytes == 0);
+    }
+  }
+}
+
+SCENARIO("Vectors larger than a huge page") {
+  WHEN("You create vectors of a few huge pages with the pool enabled") {
+    SetVectorPoolEnabled(true);
+    ResetVectorPoolStats();
+    const std::size_t dims = 3 * kHugePageBytes / sizeof(double) + 5;
+    EuclideanVector a{dims, 1.5};
+    EuclideanVector b = a;
+    b.Reserve(dims + 1);
+    auto offset = [](const EuclideanVector& ev) {
+      return reinterpret_cast<std::uintptr_t>(ev.data()) % kHugePageBytes;
+    };
+    bool filled = std::all_of(a.data(), a.data() + dims, [](double x) { return x == 1.5; });
+    bool kept = std::equal(a.data(), a.data() + dims, b.data());
+    VectorPoolStats stats = GetVectorPoolStats();
+    SetVectorPoolEnabled(false);
+
+    THEN("They bypass the pool, start on a huge page and are filled in full") {
+      REQUIRE(stats.acquires == 0);
+      REQUIRE(offset(a) < 64);
+      REQUIRE(offset(b) < 64);
+      REQUIRE(filled);
+      REQUIRE(kept);
+      REQUIRE(b.GetNumDimensions() == dims);
+      REQUIRE(b.GetCapacity() == dims + 1);
+    }
+  }
+}
@@ -0,0 +1,233 @@
+#include "assignments/ev/vector_random.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "assignments/ev/parallel_for.h"
+#include "assignments/ev/vector_kernels.h"
+
+namespace {
+
+constexpr std::uint32_t kMultiplier0 = 0xD2511F53;
+constexpr std::uint32_t kMultiplier1 = 0xCD9E8D57;
+constexpr std::uint32_t kWeyl0 = 0x9E3779B9;  // golden ratio
+constexpr std::uint32_t kWeyl1 = 0xBB67AE85;  // sqrt(3) - 1
+constexpr int kRounds = 10;
+
+// Blocks generated together; each round is then a loop over kLanes independent counters, which
+//  the compiler turns into SIMD multiplies and xors
+constexpr std::size_t kLanes = 8;
+
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr double kUnit = 1.0 / 9007199254740992.0;  // 2^-53
+
+// Blocks first to first + kLanes - 1 of stream, as the two 64-bit halves of each block
+void Blocks(const Philox4x32::Key& key,
+            std::uint64_t stream,
+            std::uint64_t first,
+            std::uint64_t (&x)[kLanes],
+            std::uint64_t (&y)[kLanes]) noexcept {
+  std::uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+  for (std::size_t lane = 0; lane < kLanes; ++lane) {
+    c0[lane] = static_cast<std::uint32_t>(first + lane);
+    c1[lane] = static_cast<std::uint32_t>((first + lane) >> 32);
+    c2[lane] = static_cast<std::uint32_t>(stream);
+    c3[lane] = static_cast<std::uint32_t>(stream >> 32);
+  }
+  std::uint32_t k0 = key[0];
+  std::uint32_t k1 = key[1];
+  for (int round = 0; round < kRounds; ++round) {
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+      std::uint64_t p0 = std::uint64_t{kMultiplier0} * c0[lane];
+      std::uint64_t p1 = std::uint64_t{kMultiplier1} * c2[lane];
+      c0[lane] = static_cast<std::uint32_t>(p1 >> 32) ^ c1[lane] ^ k0;
+      c1[lane] = static_cast<std::uint32_t>(p1);
+      c2[lane] = static_cast<std::uint32_t>(p0 >> 32) ^ c3[lane] ^ k1;
+      c3[lane] = static_cast<std::uint32_t>(p0);
+    }
+    k0 += kWeyl0;
+    k1 += kWeyl1;
+  }
+  for (std::size_t lane = 0; lane < kLanes; ++lane) {
+    x[lane] = c0[lane] | std::uint64_t{c1[lane]} << 32;
+    y[lane] = c2[lane] | std::uint64_t{c3[lane]} << 32;
+  }
+}
+
+// Writes magnitudes begin to begin + n - 1 of the sequence to out; transform turns the two halves
+//  of block b into magnitudes 2b and 2b + 1
+template <typename Transform>
+void FillBlocks(const Philox4x32& philox,
+                std::uint64_t stream,
+                double* out,
+                std::uint64_t begin,
+                std::size_t n,
+                Transform transform) noexcept {
+  const std::uint64_t end = begin + n;
+  std::uint64_t x[kLanes];
+  std::uint64_t y[kLanes];
+  for (std::uint64_t block = begin / 2; 2 * block < end; block += kLanes) {
+    Blocks(philox.GetKey(), stream, block, x, y);
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+      double pair[2];
+      transform(x[lane], y[lane], pair[0], pair[1]);
+      for (std::uint64_t k = 0; k < 2; ++k) {
+        std::uint64_t i = 2 * (block + lane) + k;
+        if (i >= begin && i < end) {
+          out[i - begin] = pair[k];
+        }
+      }
+    }
+  }
+}
+
+// Splits the fill across threads; magnitude i is the same whichever thread writes it
+template <typename Transform>
+void Fill(double* out,
+          std::size_t n,
+          const RandomParams& params,
+          std::uint64_t begin,
+          Transform transform) {
+  Philox4x32 philox{params.seed};
+  int threads = NumThreads(params.num_threads, n, kMinRandomPerThread);
+  ParallelFor(n, threads, [&](std::size_t, std::size_t chunk_begin, std::size_t chunk_end) {
+    FillBlocks(philox, params.stream, out + chunk_begin, begin + chunk_begin,
+               chunk_end - chunk_begin, transform);
+  });
+}
+
+// Scales each of the num_vectors rows of dimensions magnitudes at data to unit length
+void NormalizeRows(double* data, std::size_t num_vectors, std::size_t dimensions, int threads) {
+  std::size_t rows_per_thread = kMinRandomPerThread / std::max<std::size_t>(dimensions, 1);
+  ParallelFor(num_vectors, NumThreads(threads, num_vectors, rows_per_thread),
+              [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                  double* row = data + i * dimensions;
+                  double norm = std::sqrt(SquaredNorm(row, dimensions));
+                  if (norm > 0) {
+                    ScaleMagnitudes(row, 1 / norm, row, dimensions);
+                  }
+                }
+              });
+}
+
+}  // namespace
+
+/* METHODS */
+// Random123's philox4x32_R(10, ...): the key is bumped by the Weyl constants between rounds
+Philox4x32::Counter Philox4x32::operator()(Counter counter) const noexcept {
+  Key key = this->key_;
+  for (int round = 0; round < kRounds; ++round) {
+    std::uint64_t p0 = std::uint64_t{kMultiplier0} * counter[0];
+    std::uint64_t p1 = std::uint64_t{kMultiplier1} * counter[2];
+    counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+               static_cast<std::uint32_t>(p1),
+               static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+               static_cast<std::uint32_t>(p0)};
+    key[0] += kWeyl0;
+    key[1] += kWeyl1;
+  }
+  return counter;
+}
+
+Philox4x32::Counter Philox4x32::Block(std::uint64_t stream, std::uint64_t index) const noexcept {
+  return (*this)({static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32),
+                  static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)});
+}
+
+/* FUNCTIONS */
+// The top 53 bits of each half, scaled into [0, 1)
+void FillUniform(double* out,
+                 std::size_t n,
+                 double low,
+                 double high,
+                 const RandomParams& params,
+                 std::uint64_t begin) {
+  const double width = high - low;
+  auto transform = [low, width](std::uint64_t x, std::uint64_t y, double& a, double& b) {
+    a = low + width * (static_cast<double>(x >> 11) * kUnit);
+    b = low + width * (static_cast<double>(y >> 11) * kUnit);
+  };
+  Fill(out, n, params, begin, transform);
+}
+
+// u1 is taken from (0, 1] so that its logarithm is finite
+void FillGaussian(double* out,
+                  std::size_t n,
+                  double mean,
+                  double stddev,
+                  const RandomParams& params,
+                  std::uint64_t begin) {
+  auto transform = [mean, stddev](std::uint64_t x, std::uint64_t y, double& a, double& b) {
+    double u1 = static_cast<double>((x >> 11) + 1) * kUnit;
+    double u2 = static_cast<double>(y >> 11) * kUnit;
+    double radius = stddev * std::sqrt(-2 * std::log(u1));
+    double angle = kTwoPi * u2;
+    a = mean + radius * std::cos(angle);
+    b = mean + radius * std::sin(angle);
+  };
+  Fill(out, n, params, begin, transform);
+}
+
+EuclideanVector RandomUniformVector(std::size_t dimensions,
+                                    double low,
+                                    double high,
+                                    const RandomParams& params) {
+  EuclideanVector ev(dimensions);
+  FillUniform(ev.data(), dimensions, low, high, params);
+  return ev;
+}
+
+EuclideanVector RandomGaussianVector(std::size_t dimensions,
+                                     double mean,
+                                     double stddev,
+                                     const RandomParams& params) {
+  EuclideanVector ev(dimensions);
+  FillGaussian(ev.data(), dimensions, mean, stddev, params);
+  return ev;
+}
+
+EuclideanVector RandomUnitVector(std::size_t dimensions, const RandomParams& params) {
+  EuclideanVector ev = RandomGaussianVector(dimensions, 0, 1, params);
+  NormalizeRows(ev.data(), 1, dimensions, 1);
+  return ev;
+}
+
+EuclideanVectorBatch RandomUniformBatch(std::size_t num_vectors,
+                                        int dimensions,
+                                        double low,
+                                        double high,
+                                        const RandomParams& params) {
+  EuclideanVectorBatch batch(dimensions);
+  batch.Resize(num_vectors);
+  if (num_vectors > 0 && dimensions > 0) {
+    FillUniform(batch.Row(0), num_vectors * static_cast<std::size_t>(dimensions), low, high,
+                params);
+  }
+  return batch;
+}
+
+EuclideanVectorBatch RandomGaussianBatch(std::size_t num_vectors,
+                                         int dimensions,
+                                         double mean,
+                                         double stddev,
+                                         const RandomParams& params) {
+  EuclideanVectorBatch batch(dimensions);
+  batch.Resize(num_vectors);
+  if (num_vectors > 0 && dimensions > 0) {
+    FillGaussian(batch.Row(0), num_vectors * static_cast<std::size_t>(dimensions), mean, stddev,
+                 params);
+  }
+  return batch;
+}
+
+EuclideanVectorBatch RandomUnitBatch(std::size_t num_vectors,
+                                     int dimensions,
+                                     const RandomParams& params) {
+  EuclideanVectorBatch batch = RandomGaussianBatch(num_vectors, dimensions, 0, 1, params);
+  if (num_vectors > 0 && dimensions > 0) {
+    NormalizeRows(batch.Row(0), num_vectors, static_cast<std::size_t>(dimensions),
+                  params.num_threads);
+  }
+  return batch;
+}
@@ -0,0 +1,97 @@
+#ifndef ASSIGNMENTS_EV_VECTOR_RANDOM_H_
+#define ASSIGNMENTS_EV_VECTOR_RANDOM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// Random EuclideanVectors and batches.
+//  Magnitudes come from Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+//  3"), a counter-based generator: each 128-bit block is a pure function of the seed and its
+//  counter, so any stretch of a sequence can be generated without generating what comes before
+//  it. Magnitude i of a (seed, stream) sequence always comes from block i / 2, which lets large
+//  fills be split across threads, gives the same values whatever the number of threads, and lets
+//  the blocks be computed several at a time in SIMD registers. A batch of n vectors of d
+//  dimensions holds magnitudes 0 to n * d - 1 of its sequence, row after row.
+
+// Philox4x32 with 10 rounds
+class Philox4x32 {
+ public:
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+
+  /* CONSTRUCTORS */
+  explicit Philox4x32(Key key) noexcept : key_(key) {}
+  explicit Philox4x32(std::uint64_t seed) noexcept
+    : key_{{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}} {}
+
+  /* METHODS */
+  // The block for counter
+  Counter operator()(Counter counter) const noexcept;
+  // The index-th block of stream: counter {index low, index high, stream low, stream high}
+  Counter Block(std::uint64_t stream, std::uint64_t index) const noexcept;
+  const Key& GetKey() const noexcept { return this->key_; }
+
+ private:
+  Key key_;
+};
+
+// Settings for the random factories
+//  seed        - the same seed and stream give the same magnitudes on any number of threads
+//  stream      - selects one of 2^64 independent sequences under the same seed, e.g. one per
+//                vector or per worker
+//  num_threads - threads to fill with (<= 0 means one per hardware thread); fills of fewer than
+//                kMinRandomPerThread magnitudes per thread use fewer threads
+struct RandomParams {
+  std::uint64_t seed = 1;
+  std::uint64_t stream = 0;
+  int num_threads = 0;
+};
+
+constexpr std::size_t kMinRandomPerThread = std::size_t{1} << 16;
+
+// Fills out[0, n) with magnitudes begin to begin + n - 1 of the sequence: uniform in [low, high),
+//  or normal with the given mean and standard deviation (Box-Muller on pairs of uniforms)
+void FillUniform(double* out,
+                 std::size_t n,
+                 double low,
+                 double high,
+                 const RandomParams& params,
+                 std::uint64_t begin = 0);
+void FillGaussian(double* out,
+                  std::size_t n,
+                  double mean,
+                  double stddev,
+                  const RandomParams& params,
+                  std::uint64_t begin = 0);
+
+EuclideanVector RandomUniformVector(std::size_t dimensions,
+                                    double low = 0,
+                                    double high = 1,
+                                    const RandomParams& params = RandomParams{});
+EuclideanVector RandomGaussianVector(std::size_t dimensions,
+                                     double mean = 0,
+                                     double stddev = 1,
+                                     const RandomParams& params = RandomParams{});
+// Uniform on the unit sphere: a standard normal vector divided by its norm
+EuclideanVector RandomUnitVector(std::size_t dimensions,
+                                 const RandomParams& params = RandomParams{});
+
+EuclideanVectorBatch RandomUniformBatch(std::size_t num_vectors,
+                                        int dimensions,
+                                        double low = 0,
+                                        double high = 1,
+                                        const RandomParams& params = RandomParams{});
+EuclideanVectorBatch RandomGaussianBatch(std::size_t num_vectors,
+                                         int dimensions,
+                                         double mean = 0,
+                                         double stddev = 1,
+                                         const RandomParams& params = RandomParams{});
+EuclideanVectorBatch RandomUnitBatch(std::size_t num_vectors,
+                                     int dimensions,
+                                     const RandomParams& params = RandomParams{});
+
+#endif  // ASSIGNMENTS_EV_VECTOR_RANDOM_H_
@@ -0,0 +1,131 @@
+/*
+
+  == Explanation and rational of testing ==
+  The generator is checked against the published Random123 known-answer vectors for
+  philox4x32_10, so its output matches other Philox implementations. Reproducibility is checked
+  the ways callers rely on it: the same seed gives the same magnitudes, any thread count gives
+  the same magnitudes, and generating from an offset or as a batch row gives the same stretch of
+  the sequence. The distributions are only checked statistically, on sample sizes where the
+  tolerances are several standard errors wide, so the tests are not flaky for a fixed seed.
+
+*/
+
+#include "assignments/ev/vector_random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "assignments/ev/vector_kernels.h"
+#include "catch.h"
+
+namespace {
+
+double Mean(const std::vector<double>& values) {
+  double sum = 0;
+  for (double value : values) {
+    sum += value;
+  }
+  return sum / static_cast<double>(values.size());
+}
+
+double Variance(const std::vector<double>& values) {
+  double mean = Mean(values);
+  double sum = 0;
+  for (double value : values) {
+    sum += (value - mean) * (value - mean);
+  }
+  return sum / static_cast<double>(values.size());
+}
+
+}  // namespace
+
+SCENARIO("Philox known answers") {
+  WHEN("You generate the Random123 known-answer blocks") {
+    THEN("They match the published values") {
+      REQUIRE(Philox4x32({0, 0})({0, 0, 0, 0}) ==
+              Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+      REQUIRE(Philox4x32({0xffffffff, 0xffffffff})({0xffffffff, 0xffffffff, 0xffffffff,
+                                                     0xffffffff}) ==
+              Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+      REQUIRE(Philox4x32({0xa4093822, 0x299f31d0})({0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                                     0x03707344}) ==
+              Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+      REQUIRE(Philox4x32(std::uint64_t{0x299f31d0a4093822}).Block(0x0370734413198a2e,
+                                                                  0x85a308d3243f6a88) ==
+              Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+    }
+  }
+}
+
+SCENARIO("Reproducible random magnitudes") {
+  WHEN("You fill the same sequence on one thread, on four threads and from offsets") {
+    RandomParams one_thread{42, 7, 1};
+    RandomParams four_threads{42, 7, 4};
+    const std::size_t n = 4 * kMinRandomPerThread + 3;
+    std::vector<double> serial(n), parallel(n), offset(11);
+    FillGaussian(serial.data(), n, 0, 1, one_thread);
+    FillGaussian(parallel.data(), n, 0, 1, four_threads);
+    FillGaussian(offset.data(), offset.size(), 0, 1, one_thread, 1001);
+    EuclideanVector again = RandomGaussianVector(n, 0, 1, one_thread);
+    EuclideanVector other_stream = RandomGaussianVector(n, 0, 1, RandomParams{42, 8, 1});
+    EuclideanVector other_seed = RandomGaussianVector(n, 0, 1, RandomParams{43, 7, 1});
+    THEN("The magnitudes depend only on the seed, the stream and their position") {
+      REQUIRE(parallel == serial);
+      REQUIRE(std::equal(offset.cbegin(), offset.cend(), serial.cbegin() + 1001));
+      REQUIRE(static_cast<std::vector<double>>(again) == serial);
+      REQUIRE(static_cast<std::vector<double>>(other_stream) != serial);
+      REQUIRE(static_cast<std::vector<double>>(other_seed) != serial);
+    }
+  }
+  WHEN("You generate a batch") {
+    RandomParams params{5, 0, 2};
+    EuclideanVectorBatch batch = RandomUniformBatch(10, 7, -2, 3, params);
+    std::vector<double> row(7);
+    FillUniform(row.data(), row.size(), -2, 3, params, 3 * 7);
+    THEN("Each row is the next stretch of the sequence") {
+      REQUIRE(batch.size() == 10);
+      REQUIRE(batch.GetNumDimensions() == 7);
+      REQUIRE(std::equal(row.cbegin(), row.cend(), batch.Row(3)));
+      REQUIRE(RandomUniformBatch(0, 7).empty());
+      REQUIRE(RandomUnitBatch(3, 0).size() == 3);
+    }
+  }
+}
+
+SCENARIO("Random distributions") {
+  WHEN("You draw 200000 uniform and Gaussian magnitudes") {
+    auto uniform = static_cast<std::vector<double>>(RandomUniformVector(200000, -1, 3));
+    auto gaussian = static_cast<std::vector<double>>(RandomGaussianVector(200000, 5, 2));
+    THEN("Their range, mean and variance match the distributions") {
+      REQUIRE(*std::min_element(uniform.cbegin(), uniform.cend()) >= -1);
+      REQUIRE(*std::max_element(uniform.cbegin(), uniform.cend()) < 3);
+      REQUIRE(Mean(uniform) == Approx(1).margin(0.02));
+      REQUIRE(Variance(uniform) == Approx(16.0 / 12).epsilon(0.02));
+      REQUIRE(Mean(gaussian) == Approx(5).margin(0.02));
+      REQUIRE(Variance(gaussian) == Approx(4).epsilon(0.02));
+      auto within_one = std::count_if(gaussian.cbegin(), gaussian.cend(),
+                                      [](double value) { return std::fabs(value - 5) < 2; });
+      REQUIRE(static_cast<double>(within_one) / 200000 == Approx(0.6827).margin(0.005));
+    }
+  }
+  WHEN("You draw unit vectors and a batch of them") {
+    EuclideanVector unit = RandomUnitVector(50);
+    EuclideanVectorBatch batch = RandomUnitBatch(20000, 3, RandomParams{9, 0, 3});
+    std::vector<double> mean(3);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      for (std::size_t d = 0; d < 3; ++d) {
+        mean[d] += batch.Row(i)[d] / static_cast<double>(batch.size());
+      }
+    }
+    THEN("Every vector has norm 1 and they are spread evenly over the sphere") {
+      REQUIRE(unit.GetEuclideanNorm() == Approx(1));
+      for (std::size_t i = 0; i < batch.size(); ++i) {
+        REQUIRE(std::sqrt(SquaredNorm(batch.Row(i), 3)) == Approx(1));
+      }
+      for (double component : mean) {
+        REQUIRE(component == Approx(0).margin(0.02));
+      }
+    }
+  }
+}
@@ -0,0 +1,126 @@
+#include "assignments/ev/vector_statistics.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "assignments/ev/parallel_for.h"
+
+/* CONSTRUCTORS */
+VectorStatistics::VectorStatistics(int num_dimensions)
+  : num_dimensions_{num_dimensions}, count_{0},
+    mean_(static_cast<std::size_t>(num_dimensions)), m2_(static_cast<std::size_t>(num_dimensions)),
+    min_(static_cast<std::size_t>(num_dimensions)), max_(static_cast<std::size_t>(num_dimensions)) {
+  Reset();
+}
+
+/* METHODS */
+void VectorStatistics::Reset() noexcept {
+  this->count_ = 0;
+  std::fill(this->mean_.begin(), this->mean_.end(), 0.0);
+  std::fill(this->m2_.begin(), this->m2_.end(), 0.0);
+  std::fill(this->min_.begin(), this->min_.end(), std::numeric_limits<double>::infinity());
+  std::fill(this->max_.begin(), this->max_.end(), -std::numeric_limits<double>::infinity());
+}
+
+void VectorStatistics::Add(const EuclideanVector& ev) {
+  CheckDimensions(ev.GetNumDimensions());
+  Add(ev.data());
+}
+
+// Welford's update: the mean moves by delta / count and m2 grows by delta * (x - new mean)
+void VectorStatistics::Add(const double* magnitudes) noexcept {
+  ++this->count_;
+  const double inverse_count = 1.0 / static_cast<double>(this->count_);
+  for (std::size_t j = 0; j < this->mean_.size(); ++j) {
+    double x = magnitudes[j];
+    double delta = x - this->mean_[j];
+    this->mean_[j] += delta * inverse_count;
+    this->m2_[j] += delta * (x - this->mean_[j]);
+    this->min_[j] = std::min(this->min_[j], x);
+    this->max_[j] = std::max(this->max_[j], x);
+  }
+}
+
+void VectorStatistics::Add(const EuclideanVectorBatch& batch) {
+  CheckDimensions(batch.GetNumDimensions());
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    Add(batch.Row(i));
+  }
+}
+
+// Chan et al.'s pairwise combination of two (count, mean, m2) states
+void VectorStatistics::Merge(const VectorStatistics& other) {
+  CheckDimensions(other.num_dimensions_);
+  if (other.count_ == 0) {
+    return;
+  }
+  if (this->count_ == 0) {
+    *this = other;
+    return;
+  }
+
+  const double n_a = static_cast<double>(this->count_);
+  const double n_b = static_cast<double>(other.count_);
+  const double n = n_a + n_b;
+  for (std::size_t j = 0; j < this->mean_.size(); ++j) {
+    double delta = other.mean_[j] - this->mean_[j];
+    this->mean_[j] += delta * (n_b / n);
+    this->m2_[j] += other.m2_[j] + delta * delta * (n_a * n_b / n);
+    this->min_[j] = std::min(this->min_[j], other.min_[j]);
+    this->max_[j] = std::max(this->max_[j], other.max_[j]);
+  }
+  this->count_ += other.count_;
+}
+
+EuclideanVector VectorStatistics::GetMean() const {
+  return ToVector(this->mean_);
+}
+
+EuclideanVector VectorStatistics::GetVariance(bool sample) const {
+  if (sample && this->count_ < 2) {
+    throw EuclideanVectorError("Sample variance needs at least 2 samples");
+  }
+  EuclideanVector variance = ToVector(this->m2_);
+  variance /= static_cast<double>(sample ? this->count_ - 1 : this->count_);
+  return variance;
+}
+
+EuclideanVector VectorStatistics::GetMin() const {
+  return ToVector(this->min_);
+}
+
+EuclideanVector VectorStatistics::GetMax() const {
+  return ToVector(this->max_);
+}
+
+/* HELPERS */
+EuclideanVector VectorStatistics::ToVector(const std::vector<double>& values) const {
+  if (this->count_ == 0) {
+    throw EuclideanVectorError("VectorStatistics has no samples");
+  }
+  return EuclideanVector(values.cbegin(), values.cend());
+}
+
+void VectorStatistics::CheckDimensions(std::size_t num_dimensions) const {
+  if (num_dimensions != static_cast<std::size_t>(this->num_dimensions_)) {
+    throw EuclideanVectorError("Dimensions of statistics(" + std::to_string(this->num_dimensions_) +
+                               ") and vector(" + std::to_string(num_dimensions) + ") do not match");
+  }
+}
+
+/* FUNCTIONS */
+VectorStatistics ComputeStatistics(const EuclideanVectorBatch& batch, int num_threads) {
+  int threads = NumThreads(num_threads, batch.size(), 4096);
+  std::vector<VectorStatistics> partial(static_cast<std::size_t>(threads),
+                                        VectorStatistics{batch.GetNumDimensions()});
+  ParallelFor(batch.size(), threads, [&](std::size_t t, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      partial[t].Add(batch.Row(i));
+    }
+  });
+  for (std::size_t t = 1; t < partial.size(); ++t) {
+    partial.front().Merge(partial[t]);
+  }
+  return partial.front();
+}
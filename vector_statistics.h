@@ -0,0 +1,54 @@
+#ifndef ASSIGNMENTS_EV_VECTOR_STATISTICS_H_
+#define ASSIGNMENTS_EV_VECTOR_STATISTICS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "assignments/ev/euclidean_vector.h"
+#include "assignments/ev/euclidean_vector_batch.h"
+
+// Running per-dimension mean, variance, minimum and maximum over a stream of vectors.
+//  Samples are folded in with Welford's update, which stays accurate where summing values and
+//  squares would cancel, and two states can be merged (Chan et al.) so that partial results from
+//  threads or machines combine into the same statistics as one pass over all the samples, up to
+//  rounding (count, minimum and maximum match exactly).
+//  Adding a sample never allocates.
+class VectorStatistics {
+ public:
+  /* CONSTRUCTORS */
+  explicit VectorStatistics(int num_dimensions);
+
+  /* METHODS */
+  int GetNumDimensions() const noexcept { return this->num_dimensions_; }
+  std::size_t GetCount() const noexcept { return this->count_; }
+  void Reset() noexcept;
+
+  void Add(const EuclideanVector& ev);
+  void Add(const double* magnitudes) noexcept;
+  void Add(const EuclideanVectorBatch& batch);
+
+  // Folds other's samples into *this
+  void Merge(const VectorStatistics& other);
+
+  EuclideanVector GetMean() const;  // centroid of the samples
+  EuclideanVector GetVariance(bool sample = false) const;  // divides by count - 1 when sample
+  EuclideanVector GetMin() const;
+  EuclideanVector GetMax() const;
+
+ private:
+  EuclideanVector ToVector(const std::vector<double>& values) const;
+  void CheckDimensions(std::size_t num_dimensions) const;
+
+  int num_dimensions_;
+  std::size_t count_;
+  std::vector<double> mean_;
+  std::vector<double> m2_;  // sum of squared deviations from the mean
+  std::vector<double> min_;
+  std::vector<double> max_;
+};
+
+// Computes the statistics of batch with one pass split across num_threads threads (<= 0 means
+//  one per hardware thread), merging the per-thread states at the end
+VectorStatistics ComputeStatistics(const EuclideanVectorBatch& batch, int num_threads = 0);
+
+#endif  // ASSIGNMENTS_EV_VECTOR_STATISTICS_H_
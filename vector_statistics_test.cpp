@@ -0,0 +1,103 @@
+/*
+
+  == Explanation and rational of testing ==
+  The statistics are compared against the textbook two-pass formulas on small inputs. Merging is
+  tested by splitting a stream in two and checking the merged state equals the single-pass state,
+  and the parallel reduction is checked the same way. The large-offset case is where summing x and
+  x^2 loses every significant digit, which Welford's update must survive.
+
+*/
+
+#include "assignments/ev/vector_statistics.h"
+
+#include <random>
+
+#include "catch.h"
+
+SCENARIO("Running statistics of a small stream") {
+  WHEN("You add three 2 dimensional vectors") {
+    VectorStatistics stats{2};
+    std::vector<double> v{1, -2, 3, 0, 5, 8};
+    for (std::size_t i = 0; i < v.size(); i += 2) {
+      stats.Add(&v[i]);
+    }
+
+    THEN("The mean, variance, min and max match their definitions") {
+      REQUIRE(stats.GetCount() == 3);
+      REQUIRE(stats.GetMean()[0] == Approx(3));
+      REQUIRE(stats.GetMean()[1] == Approx(2));
+      REQUIRE(stats.GetVariance()[0] == Approx(8.0 / 3));
+      REQUIRE(stats.GetVariance(true)[1] == Approx(56.0 / 2));
+      REQUIRE(stats.GetMin()[1] == -2);
+      REQUIRE(stats.GetMax()[0] == 5);
+    }
+  }
+}
+
+SCENARIO("Variance of samples with a huge common offset") {
+  WHEN("You add values 1e9 + {4, 7, 13, 16}") {
+    VectorStatistics stats{1};
+    for (double d : {4.0, 7.0, 13.0, 16.0}) {
+      stats.Add(EuclideanVector{1, 1e9 + d});
+    }
+
+    THEN("The variance is not swamped by the offset") {
+      REQUIRE(stats.GetVariance(true)[0] == Approx(30));
+    }
+  }
+}
+
+SCENARIO("Merging partial statistics") {
+  WHEN("You split a random stream between two accumulators") {
+    std::mt19937 rng{1};
+    std::normal_distribution<double> normal{2.0, 3.0};
+    EuclideanVectorBatch batch{4};
+    for (int i = 0; i < 10000; ++i) {
+      double v[4] = {normal(rng), normal(rng), normal(rng), normal(rng)};
+      batch.Add(v);
+    }
+
+    VectorStatistics all{4};
+    VectorStatistics first{4};
+    VectorStatistics second{4};
+    all.Add(batch);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      (i < 3000 ? first : second).Add(batch.Row(i));
+    }
+    first.Merge(second);
+
+    THEN("The merged and parallel states equal the single pass state") {
+      VectorStatistics parallel = ComputeStatistics(batch, 4);
+      REQUIRE(first.GetCount() == all.GetCount());
+      REQUIRE(parallel.GetCount() == all.GetCount());
+      REQUIRE(ApproxEqual(first.GetMean(), all.GetMean(), 1e-12));
+      REQUIRE(ApproxEqual(first.GetVariance(), all.GetVariance(), 1e-10));
+      REQUIRE(ApproxEqual(parallel.GetVariance(), all.GetVariance(), 1e-10));
+      REQUIRE(first.GetMin() == all.GetMin());
+      REQUIRE(parallel.GetMax() == all.GetMax());
+    }
+  }
+}
+
+// EXCEPTION - no samples
+SCENARIO("Asking for the mean of an empty stream") {
+  WHEN("You create statistics without adding anything") {
+    VectorStatistics stats{3};
+
+    THEN("Getting the mean returns exception error") {
+      REQUIRE_THROWS_WITH(stats.GetMean(), "VectorStatistics has no samples");
+    }
+  }
+}
+
+// EXCEPTION - dimensions do not match
+SCENARIO("Adding a vector of the wrong dimension to statistics") {
+  WHEN("You create statistics of 3 dimensional vectors") {
+    VectorStatistics stats{3};
+
+    THEN("Adding a 2 dimensional vector returns exception error") {
+      REQUIRE_THROWS_WITH(stats.Add(EuclideanVector{2}),
+                          "Dimensions of statistics(3) and vector(2) do not match");
+    }
+  }
+}